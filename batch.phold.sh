@@ -3,17 +3,39 @@
 #SBATCH --nodes=1
 #SBATCH --ntasks-per-node=2
 #SBATCH --job-name=phold
-#SBATCH --partition=pdebug
-#SBATCH --account=dance
+
+# Submit with the site account and partition, for example
+#   sbatch --account=<account> --partition=<partition> batch.phold.sh
+#
+# Without a scaling sweep this runs one PHOLD configuration:
+#   PHOLD_ARGS   tests/phold.py arguments
+#   THREADS      threads per rank
+# With SCALING set this runs tests/scaling1.py with those arguments,
+# launching each run with srun, for example
+#   SCALING="--mode weak --ranks 1,2,4,8 --number 1024" sbatch ... batch.phold.sh
+
+: ${PHOLD_ARGS:="--number 512 --events 1024 --stop 1000 --buffer 1000 --thread 0.5"}
+: ${THREADS:=2}
+: ${NTASKS:=${SLURM_NTASKS:-2}}
+
+# sbatch runs a copy of this script, so find tests/ from the submit directory
+cd "${SLURM_SUBMIT_DIR:-$(dirname "$0")}"
 
 date
 echo "PWD:" `pwd`
 echo "SST:" `which sst`
 
-srun --nodes=1 --ntasks=2 \
-     sst --num_threads=2 \
-     tests/phold.py -- \
-     --number 512 --events 1024 --stop 1000 --buffer 1000 --thread 0.5
+if [ -n "${SCALING:-}" ] ; then
+    python3 tests/scaling1.py --always-launch \
+        --launcher "srun --ntasks={ranks} --nodes={nodes}" \
+        --ranks-per-node ${SLURM_NTASKS_PER_NODE:-1} \
+        --out phold-scaling-${SLURM_JOB_ID:-local} \
+        $SCALING
+else
+    srun --ntasks=$NTASKS \
+         sst --num_threads=$THREADS \
+         tests/phold.py -- $PHOLD_ARGS
+fi
 
 # --number 512 --events 1024 --stop 1000
 # --number 4 --events 1 --stop 100 --pverbose --buffer 1000
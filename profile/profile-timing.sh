@@ -18,6 +18,17 @@ function reset_traps
     trap - DEBUG EXIT
     set +e
 }
+
+# Site settings, override from the environment
+#   SST_ROOT     holds sst-core/ (the source) and build/ (the installs)
+#   PHOLD_DIR    this repository
+#   ACCOUNT, PARTITION, NODES, TIME   for the batch submission
+: ${SST_ROOT:=~/Code/SST}
+: ${PHOLD_DIR:=$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)}
+: ${ACCOUNT:=}
+: ${PARTITION:=pbatch}
+: ${NODES:=4}
+: ${TIME:=6:00:00}
     
 
 # pushd (change) directory and log it, optionally log to file
@@ -49,7 +60,7 @@ function set_sst # install-dir
     echo
     echo "Switching to SST version $1"
     echo "****************************************"
-    push_cwd ~/Code/SST/build
+    push_cwd $SST_ROOT/build
     rm -f sst
     ln -fsT $1 sst
     echo "which sst: " `which sst`
@@ -63,14 +74,14 @@ function build # install commit config-args
 {
     local install=$1 ; shift
     local commit=$1  ; shift
-    local logf=~/Code/SST/phold/profile/build.${install}.log
+    local logf=$PHOLD_DIR/profile/build.${install}.log
     echo "Logging build to $logf"
 
     echo | tee $logf
     echo "Building $install from $commit" | tee -a $logf
     echo "******************************" | tee -a $logf
     date  | tee -a $logf
-    push_cwd ~/Code/SST/sst-core $logf
+    push_cwd $SST_ROOT/sst-core $logf
 
     local oldPS4=$PS4
     PS4="--- build: "
@@ -108,7 +119,7 @@ function save_perf # label
     done
 }
 
-phold_args="--stop 2000 --number 2048 --events 128"
+: ${phold_args:="--stop 2000 --number 2048 --events 128"}
 #phold_args="--stop 100 --number 248 --events 128"
 
 function run_one # label sst-args
@@ -134,7 +145,7 @@ function run_srun # label sst-args
     echo "******************************"
     echo "   with args: $*"
     echo "   to $logf"
-    srun --nodes 4 --ntasks-per-node=1 \
+    srun --nodes $NODES --ntasks-per-node=1 \
 	 sst $* tests/phold.py -- $phold_args \
 	2>& 1 | tee $logf
     save_perf $label
@@ -190,24 +201,25 @@ set_traps
 # Use 'batch' arg on the command line to submit as a batch job
 if [ "${1:-}" == "batch" ] ; then
 
-    cd ~/Code/SST/phold >/dev/null
+    cd $PHOLD_DIR >/dev/null
     sbatch \
-	--account=autonomy \
-	--partition=pbatch \
+	${ACCOUNT:+--account=$ACCOUNT} \
+	--partition=$PARTITION \
 	--job-name=sst-profile \
 	--output=profile/profile-%j.log \
-	--nodes=4 \
-	--time=6:00:00 \
+	--nodes=$NODES \
+	--time=$TIME \
+	--export=ALL,SST_ROOT=$SST_ROOT,PHOLD_DIR=$PHOLD_DIR \
 	profile/profile-timing.sh
 
     cd -  >/dev/null
     reset_traps
 
     # wait for the job to start
-    while squeue -u barnes | grep -q "Priority\|Resources" ; do
+    while squeue -u $USER | grep -q "Priority\|Resources" ; do
 	sleep 2
     done
-    squeue -u barnes
+    squeue -u $USER
 
     exit 0
 fi
@@ -226,7 +238,7 @@ if [ "${1:-}" == "build" ] ; then
     echo "Building SST versions"
     echo "=================================================="
     date
-    push_cwd ~/Code/SST/phold
+    push_cwd $PHOLD_DIR
 
     echo Loading gcc/10
     reset_traps
@@ -267,7 +279,7 @@ date
 echo
 echo "Running variants"
 echo "=============================="
-push_cwd ~/Code/SST/phold
+push_cwd $PHOLD_DIR
 
 for (( i=0; i<10; i++ ))
 do
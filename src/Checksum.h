@@ -0,0 +1,46 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * \file
+ * Phold::EventHash() function, for the committed event checksum.
+ */
+
+namespace Phold {
+
+/**
+ * Hash one committed event, for the run checksum.
+ * Each field goes through the SplitMix64 finalizer, chained, so
+ * swapping fields, or times between events, changes the hash.
+ *
+ * The run checksum is the sum of these over every committed event,
+ * so it doesn't depend on the order events are handled, or where.
+ * @param src The sending LP.
+ * @param dst The receiving LP.
+ * @param send The send time.
+ * @param recv The receive time.
+ * @returns The hash.
+ */
+inline uint64_t
+EventHash(uint64_t src, uint64_t dst, uint64_t send, uint64_t recv)
+{
+  auto mix = [](uint64_t h, uint64_t v)
+    {
+      h = (h ^ v) + 0x9e3779b97f4a7c15ULL;
+      h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+      return h ^ (h >> 31);
+    };
+  return mix(mix(mix(mix(0, src), dst), send), recv);
+}
+
+}  // namespace Phold
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>    // log()
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file
+ * Phold::Philox4x32 and Phold::CounterRng class declarations.
+ */
+
+namespace Phold {
+
+/**
+ * Philox4x32-10 counter-based random function.
+ *
+ * Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3," SC'11.
+ * Maps a 128-bit counter and 64-bit key to 128 random bits, with no
+ * state beyond its arguments.  Distinct (key, counter) pairs give
+ * independent outputs, so any number of streams can be generated
+ * in any order.
+ */
+class Philox4x32
+{
+public:
+  /** 128-bit counter. */
+  typedef std::array<uint32_t, 4> Counter;
+  /** 64-bit key. */
+  typedef std::array<uint32_t, 2> Key;
+
+  /**
+   * Generate the random bits for a counter.
+   * @param ctr The counter.
+   * @param key The key.
+   * @returns 128 random bits.
+   */
+  static Counter Generate(Counter ctr, Key key)
+  {
+    for (int r = 0; r < ROUNDS; ++r)
+      {
+        if (r > 0)
+          {
+            key[0] += W0;
+            key[1] += W1;
+          }
+        const uint64_t p0 = uint64_t{M0} * ctr[0];
+        const uint64_t p1 = uint64_t{M1} * ctr[2];
+        ctr = {{ static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                 static_cast<uint32_t>(p1),
+                 static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                 static_cast<uint32_t>(p0) }};
+      }
+    return ctr;
+  }
+
+private:
+  static constexpr int      ROUNDS {10};          /**< Number of rounds. */
+  static constexpr uint32_t M0     {0xD2511F53};  /**< Round multiplier. */
+  static constexpr uint32_t M1     {0xCD9E8D57};  /**< Round multiplier. */
+  static constexpr uint32_t W0     {0x9E3779B9};  /**< Key schedule, golden ratio. */
+  static constexpr uint32_t W1     {0xBB67AE85};  /**< Key schedule, sqrt(3) - 1. */
+
+};  // class Philox4x32
+
+
+/**
+ * Per-LP uniform and exponential deviates from Philox4x32.
+ *
+ * The `n`th deviate of each kind is a pure function of
+ * `(seed, LP id, kind, n)`, independent of which rank or thread
+ * hosts the LP, and of how many other LPs share the rank.
+ * So a run reproduces exactly under any partitioning, as long as
+ * each LP executes its events in the same order.
+ *
+ * Deviates are generated @c BLOCK at a time into per-LP buffers.
+ * The fill loops have no dependence between iterations, so the
+ * compiler can vectorize them; the per-sample cost is then just
+ * the buffer read.
+ */
+class CounterRng
+{
+public:
+
+  /** Number of deviates generated per refill. */
+  static constexpr std::size_t BLOCK {32};
+
+  /**
+   * Constructor.
+   * @param seed Global seed, shared by all LPs.
+   * @param id   LP id.
+   * @param mean Mean of the exponential deviates.
+   */
+  CounterRng(uint32_t seed, uint64_t id, double mean)
+    : m_key{{ static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32) }},
+      m_seed(seed),
+      m_mean(mean),
+      m_uniformBlocks(0),
+      m_expBlocks(0),
+      m_u(BLOCK),
+      m_e(BLOCK)
+  {
+  }
+
+  /** @returns The next uniform deviate in `[0, 1)`. */
+  double nextUniform()
+  {
+    if (m_u == BLOCK)
+      {
+        Fill(m_uniform, UNIFORM, m_uniformBlocks++);
+        m_u = 0;
+      }
+    return m_uniform[m_u++];
+  }
+
+  /** @returns The next exponential deviate. */
+  double nextExponential()
+  {
+    if (m_e == BLOCK)
+      {
+        Fill(m_exp, EXPONENTIAL, m_expBlocks++);
+        // 1 - u is in (0, 1], so log is finite
+        for (std::size_t i = 0; i < BLOCK; ++i)
+          {
+            m_exp[i] = -m_mean * std::log(1.0 - m_exp[i]);
+          }
+        m_e = 0;
+      }
+    return m_exp[m_e++];
+  }
+
+private:
+
+  /** Deviate kinds, each an independent stream in the counter. */
+  enum Stream : uint32_t
+  {
+    UNIFORM     = 0,  /**< Uniform deviates. */
+    EXPONENTIAL = 1   /**< Exponential deviates. */
+  };
+
+  /** A buffer of deviates. */
+  typedef std::array<double, BLOCK> Buffer;
+
+  /**
+   * Convert 64 random bits to a double in `[0, 1)`.
+   * @param hi High 32 bits.
+   * @param lo Low 32 bits.
+   * @returns The uniform deviate.
+   */
+  static double ToDouble(uint32_t hi, uint32_t lo)
+  {
+    const uint64_t bits = (uint64_t{hi} << 32) | lo;
+    return (bits >> 11) * 0x1.0p-53;
+  }
+
+  /**
+   * Fill a buffer with uniform deviates.
+   * @param buffer The buffer to fill.
+   * @param stream The deviate kind.
+   * @param block  The block number within the stream.
+   */
+  void Fill(Buffer & buffer, Stream stream, uint64_t block) const
+  {
+    // Each Philox call gives two deviates
+    const uint64_t base = block * (BLOCK / 2);
+    for (std::size_t j = 0; j < BLOCK / 2; ++j)
+      {
+        const uint64_t n = base + j;
+        const Philox4x32::Counter ctr
+          {{ static_cast<uint32_t>(n), static_cast<uint32_t>(n >> 32), stream, m_seed }};
+        const auto r = Philox4x32::Generate(ctr, m_key);
+        buffer[2 * j]     = ToDouble(r[0], r[1]);
+        buffer[2 * j + 1] = ToDouble(r[2], r[3]);
+      }
+  }
+
+  Philox4x32::Key m_key;            /**< Key, from the LP id. */
+  uint32_t        m_seed;           /**< Global seed. */
+  double          m_mean;           /**< Exponential mean. */
+  uint64_t        m_uniformBlocks;  /**< Uniform blocks generated. */
+  uint64_t        m_expBlocks;      /**< Exponential blocks generated. */
+  std::size_t     m_u;              /**< Next unused uniform. */
+  std::size_t     m_e;              /**< Next unused exponential. */
+  Buffer          m_uniform;        /**< Uniform deviates. */
+  Buffer          m_exp;            /**< Exponential deviates. */
+
+};  // class CounterRng
+
+}  // namespace Phold
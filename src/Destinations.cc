@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Destinations.h"
+
+#include <cmath>      // pow()
+#include <sstream>
+
+/**
+ * \file
+ * Phold::Destinations class implementation.
+ */
+
+namespace Phold {
+
+Destinations::Destinations(const Config & config)
+  : m_config(config)
+{
+  if (m_config.kind == Kind::ZIPF && m_config.number > 1)
+    {
+      BuildAlias();
+    }
+}
+
+
+bool
+Destinations::Parse(const std::string & name, Kind & kind)
+{
+  if      (name == "uniform") kind = Kind::UNIFORM;
+  else if (name == "local")   kind = Kind::LOCAL;
+  else if (name == "zipf")    kind = Kind::ZIPF;
+  else return false;
+  return true;
+
+}  // Parse()
+
+
+std::string
+Destinations::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::UNIFORM: return "uniform";
+    case Kind::LOCAL:   return "local";
+    case Kind::ZIPF:    return "zipf";
+    }
+  return "unknown";
+
+}  // Name()
+
+
+bool
+Destinations::isValid(std::string & why) const
+{
+  if (m_config.number < 2)
+    {
+      why = "need at least 2 LPs";
+      return false;
+    }
+  if (m_config.kind == Kind::LOCAL)
+    {
+      if (m_config.localSize < 1)
+        {
+          why = "local distribution needs localsize >= 1";
+          return false;
+        }
+      if (m_config.locality < 0 || m_config.locality > 1)
+        {
+          why = "locality must be in [0, 1]";
+          return false;
+        }
+    }
+  if (m_config.kind == Kind::ZIPF && m_config.exponent < 0)
+    {
+      why = "zipf exponent can't be negative";
+      return false;
+    }
+  return true;
+
+}  // isValid()
+
+
+std::string
+Destinations::toString() const
+{
+  std::stringstream ss;
+  ss << Name(m_config.kind);
+  if (m_config.kind == Kind::LOCAL)
+    {
+      ss << " (" << m_config.locality << " within blocks of " << m_config.localSize << ")";
+    }
+  else if (m_config.kind == Kind::ZIPF)
+    {
+      ss << " (s = " << m_config.exponent << ")";
+    }
+  return ss.str();
+
+}  // toString()
+
+
+void
+Destinations::BuildAlias()
+{
+  // Vose's stable variant of Walker's alias method.
+  // Sample() skips self, so only the other n - 1 LPs need ranks
+  const auto n = m_config.number - 1;
+  std::vector<double> weight(n);
+  double total = 0;
+  for (uint64_t k = 0; k < n; ++k)
+    {
+      weight[k] = 1.0 / std::pow(double(k + 1), m_config.exponent);
+      total += weight[k];
+    }
+
+  m_prob.assign(n, 1.0);
+  m_alias.resize(n);
+  std::vector<uint64_t> small, large;
+  for (uint64_t k = 0; k < n; ++k)
+    {
+      weight[k] *= n / total;
+      m_alias[k] = k;
+      (weight[k] < 1.0 ? small : large).push_back(k);
+    }
+  while ( ! small.empty() && ! large.empty())
+    {
+      auto s = small.back();  small.pop_back();
+      auto l = large.back();
+      m_prob[s]  = weight[s];
+      m_alias[s] = l;
+      weight[l] -= 1.0 - weight[s];
+      if (weight[l] < 1.0)
+        {
+          large.pop_back();
+          small.push_back(l);
+        }
+    }
+  // Anything left is 1, up to rounding
+
+}  // BuildAlias()
+
+
+}  // namespace Phold
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <sst/core/sst_types.h>
+
+#include <algorithm>  // min()
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * Phold::Destinations class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Distribution of remote event destinations, for the full topology.
+ *
+ * Kind      | Destination of an event from LP `i`
+ * --------- | --------------------------------------------------------
+ * `uniform` | Any other LP, uniformly (default)
+ * `local`   | With probability `locality` another LP in the same local
+ *           | block of `localsize` LPs, otherwise any other LP
+ * `zipf`    | The `r`'th other LP, counting up from 0 and skipping `i`,
+ *           | with probability proportional to `1 / (r + 1)^s`, so the
+ *           | lowest ids are hot spots
+ *
+ * The local blocks are contiguous ranges of LP ids, which matches the
+ * SST linear partitioner when `localsize` is the number of LPs per thread.
+ *
+ * Every draw uses a single uniform deviate, mapping `[0, n - 1)` around
+ * self, so there is no rejection loop.  The `zipf` draw picks the rank
+ * with Walker's alias method, over a table of the `n - 1` ranks shared by
+ * all LPs.  Any exponent `s >= 0` works: for large `s` the weights past
+ * the first underflow to 0, and every event goes to LP 0 (or 1, from 0).
+ *
+ * One instance is shared by all LPs in a process.
+ */
+class Destinations
+{
+public:
+
+  /** Supported distributions. */
+  enum class Kind
+  {
+    UNIFORM,   /**< Uniform over all other LPs. */
+    LOCAL,     /**< Biased towards LPs in the same block. */
+    ZIPF       /**< Zipf distribution over LP ids. */
+  };
+
+  /** Distribution parameters, as read from the component Params. */
+  struct Config
+  {
+    /** Which distribution. */
+    Kind kind {Kind::UNIFORM};
+    /** Total number of LPs. */
+    uint64_t number {2};
+    /** Probability of choosing a local LP, for the local distribution. */
+    double locality {0.9};
+    /** Number of LPs in each local block. */
+    uint64_t localSize {1};
+    /** Zipf exponent. */
+    double exponent {1.0};
+  };
+
+  /**
+   * C'tor.
+   * @param config The configuration.
+   */
+  explicit Destinations(const Config & config);
+
+  /**
+   * Parse a distribution name.
+   * @param name The name, such as "zipf".
+   * @param [out] kind The distribution, if found.
+   * @returns \c true if \c name is a known distribution.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Get the name of a distribution kind.
+   * @param kind The distribution kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Check the configuration for consistency.
+   * @param [out] why The error description, if invalid.
+   * @returns \c true if the configuration is valid.
+   */
+  bool isValid(std::string & why) const;
+
+  /** @returns The configuration. */
+  const Config & getConfig() const
+  {
+    return m_config;
+  }
+
+  /** @returns A short description, such as "zipf (s = 1)". */
+  std::string toString() const;
+
+  /**
+   * Draw a destination.
+   * @param rng  The generator, providing `nextUniform()`.
+   * @param self Our LP id, which is never returned.
+   * @param [in,out] reps Incremented by the number of draws.
+   * @returns The destination LP id.
+   */
+  template <class Rng>
+  SST::ComponentId_t Sample(Rng & rng, SST::ComponentId_t self, unsigned & reps) const
+  {
+    ++reps;
+    switch (m_config.kind)
+      {
+      case Kind::LOCAL:
+        {
+          // Reuse the deviate for the choice within the block, rescaled to [0, 1)
+          auto u = rng.nextUniform();
+          const auto begin = self - self % m_config.localSize;
+          const auto end = std::min(begin + m_config.localSize, m_config.number);
+          // Need someone else in the block
+          if (end - begin > 1)
+            {
+              // With locality 1 always stay local: SST generators can
+              // return u = 1, which would divide by zero below
+              if (u < m_config.locality || m_config.locality >= 1)
+                {
+                  return Around(u / m_config.locality, begin, end, self);
+                }
+              u = (u - m_config.locality) / (1 - m_config.locality);
+            }
+          return Around(u, 0, m_config.number, self);
+        }
+      case Kind::ZIPF:
+        {
+          // The alias table holds the n - 1 ranks of the other LPs
+          const auto id = Alias(rng.nextUniform());
+          return id >= self ? id + 1 : id;
+        }
+      case Kind::UNIFORM:
+      default:
+        return Around(rng.nextUniform(), 0, m_config.number, self);
+      }
+  }
+
+private:
+
+  /**
+   * Map a uniform deviate to any id in `[begin, end)` except self.
+   * @param u     Uniform deviate in `[0, 1)`.
+   * @param begin First candidate id.
+   * @param end   One past the last candidate id.
+   * @param self  Our id, in `[begin, end)`.
+   * @returns The id.
+   */
+  static SST::ComponentId_t Around(double u, SST::ComponentId_t begin,
+                                   SST::ComponentId_t end, SST::ComponentId_t self)
+  {
+    auto id = begin + static_cast<SST::ComponentId_t>(u * (end - begin - 1));
+    // Guard against rounding up to the last candidate
+    id = std::min(id, end - 2);
+    return id >= self ? id + 1 : id;
+  }
+
+  /**
+   * Draw from the alias table.
+   * @param u Uniform deviate in `[0, 1)`.
+   * @returns The rank, in `[0, n - 1)`.
+   */
+  SST::ComponentId_t Alias(double u) const
+  {
+    const double x = u * m_prob.size();
+    const auto i = std::min(static_cast<std::size_t>(x), m_prob.size() - 1);
+    return (x - i) < m_prob[i] ? i : m_alias[i];
+  }
+
+  /** Build the Zipf alias table, over the `n - 1` other LP ranks. */
+  void BuildAlias();
+
+  /** The configuration. */
+  Config m_config;
+
+  /** Alias method acceptance probabilities, for zipf. */
+  std::vector<double>   m_prob;
+  /** Alias method alternatives, for zipf. */
+  std::vector<uint64_t> m_alias;
+
+};  // class Destinations
+
+}  // namespace Phold
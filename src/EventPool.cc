@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "EventPool.h"
+
+#include <mutex>
+#include <new>     // operator new
+
+/**
+ * \file
+ * Phold::EventPool class implementation.
+ */
+
+namespace Phold {
+
+std::atomic<EventPool::State> EventPool::m_state {EventPool::State::UNSET};
+
+namespace {
+
+/** Guard for the registry of per-thread pools. */
+std::mutex g_registryMutex;
+
+}  // anonymous namespace
+
+
+std::vector<const EventPool::Local *> &
+EventPool::Registry()
+{
+  static std::vector<const Local *> registry;
+  return registry;
+
+}  // Registry()
+
+
+EventPool::Local *
+EventPool::Register()
+{
+  auto local = new Local;
+  std::lock_guard<std::mutex> lock(g_registryMutex);
+  Registry().push_back(local);
+  return local;
+
+}  // Register()
+
+
+void *
+EventPool::Allocate(std::size_t bytes)
+{
+  auto & local = GetLocal();
+  local.live.Add(bytes);
+  const auto c = SizeClass(bytes);
+  if (c <= MAX_CLASS && IsEnabled())
+    {
+      Block * block = local.heads[c];
+      if (block)
+        {
+          local.heads[c] = block->next;
+          --local.lengths[c];
+          local.cached.Add(-(uint64_t{1} << c));
+          local.hits.Add(1);
+          return block;
+        }
+      local.misses.Add(1);
+      // Allocate the full class size so the block can be reused for any
+      // request in this class
+      return ::operator new(std::size_t{1} << c);
+    }
+  local.misses.Add(1);
+  return ::operator new(bytes);
+
+}  // Allocate()
+
+
+void
+EventPool::Free(void * p, std::size_t bytes)
+{
+  if ( ! p) return;
+  auto & local = GetLocal();
+  local.live.Add(-uint64_t(bytes));
+  const auto c = SizeClass(bytes);
+  if (c <= MAX_CLASS && IsEnabled())
+    {
+      // A full list hands the block back, so a thread which only
+      // receives doesn't hoard blocks its senders keep missing
+      if (local.lengths[c] >= (CACHE_BYTES >> c))
+        {
+          local.released.Add(1);
+          ::operator delete(p);
+          return;
+        }
+      auto block = static_cast<Block *>(p);
+      block->next = local.heads[c];
+      local.heads[c] = block;
+      ++local.lengths[c];
+      local.cached.Add(uint64_t{1} << c);
+      local.frees.Add(1);
+      return;
+    }
+  ::operator delete(p);
+
+}  // Free()
+
+
+EventPool::Counts
+EventPool::GetCounts()
+{
+  Counts total;
+  std::lock_guard<std::mutex> lock(g_registryMutex);
+  for (auto p : Registry())
+    {
+      total.hits   += p->hits.Get();
+      total.misses += p->misses.Get();
+      total.frees  += p->frees.Get();
+      total.released += p->released.Get();
+      total.cached += p->cached.Get();
+      total.live   += p->live.Get();
+      ++total.threads;
+    }
+  return total;
+
+}  // GetCounts()
+
+
+}  // namespace Phold
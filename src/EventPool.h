@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \file
+ * Phold::EventPool class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Per-thread recycling allocator for PHOLD events and their payloads.
+ *
+ * Every event sent by Phold::SendEventT() is deleted by the receiver
+ * in Phold::handleEventT(), so the same few block sizes are allocated
+ * and freed over and over.  This keeps a free list per size class
+ * per thread, so the steady state never touches the global allocator.
+ *
+ * Blocks freed on a different thread than the one which allocated them
+ * just migrate to the freeing thread's list.  Each list holds at most
+ * `CACHE_BYTES` per size class; blocks freed past that go back to the
+ * global allocator.  Otherwise a steady one-way flow of events, sent
+ * on one thread and received on another, would grow the receiver's
+ * lists without bound while the sender keeps missing.
+ *
+ * Size classes are powers of two, from `2^MIN_CLASS` to `2^MAX_CLASS`
+ * bytes.  Larger requests go straight to the global allocator.
+ */
+class EventPool
+{
+public:
+
+  /** Allocation counters. */
+  struct Counts
+  {
+    uint64_t hits    {0};  /**< Allocations served from a free list. */
+    uint64_t misses  {0};  /**< Allocations from the global allocator. */
+    uint64_t frees   {0};  /**< Blocks returned to a free list. */
+    /** Blocks returned to the global allocator, from full free lists. */
+    uint64_t released {0};
+    uint64_t cached  {0};  /**< Bytes currently held in free lists. */
+    /**
+     * Bytes requested and not yet freed.  Blocks freed on another thread
+     * make one thread's count wrap, but the sum over threads is exact.
+     */
+    uint64_t live    {0};
+    uint64_t threads {0};  /**< Number of threads contributing. */
+  };
+
+  /**
+   * Allocate a block.
+   * @param bytes The size of the block.
+   * @returns The block.
+   */
+  static void * Allocate(std::size_t bytes);
+
+  /**
+   * Return a block.
+   * @param p The block, from Allocate().
+   * @param bytes The size requested from Allocate().
+   */
+  static void Free(void * p, std::size_t bytes);
+
+  /**
+   * Sum the counts over all threads in this process.
+   * This is safe at any time, but the sum is only a consistent
+   * snapshot when the other threads are quiescent.
+   * @returns The total counts.
+   */
+  static Counts GetCounts();
+
+  /**
+   * Enable or disable pooling.  When disabled Allocate() and Free()
+   * just call the global allocator (and count misses).
+   *
+   * This can only be set once per process: the first call, or the first
+   * Allocate(), which enables it, decides.  Blocks allocated one way
+   * can't be freed the other, so later calls can't change it.
+   * It's safe to call from several threads.
+   * @param enabled Whether to recycle blocks.
+   * @returns \c false if pooling was already set the other way.
+   */
+  static bool Enable(bool enabled)
+  {
+    auto state = State::UNSET;
+    const auto want = enabled ? State::ON : State::OFF;
+    return m_state.compare_exchange_strong(state, want, std::memory_order_relaxed)
+      || state == want;
+  }
+
+  /** @returns \c true if pooling is enabled, enabling it if not yet set. */
+  static bool IsEnabled()
+  {
+    const auto state = m_state.load(std::memory_order_relaxed);
+    if (State::UNSET != state) return State::ON == state;
+    Enable(true);
+    return State::ON == m_state.load(std::memory_order_relaxed);
+  }
+
+private:
+
+  /** Smallest size class, 16 bytes. */
+  static constexpr std::size_t MIN_CLASS {4};
+  /** Largest size class, 64 kiB. */
+  static constexpr std::size_t MAX_CLASS {16};
+  /** Most bytes cached in each free list, 4 MiB. */
+  static constexpr std::size_t CACHE_BYTES {std::size_t{1} << 22};
+
+  /** A free block, reused as a list node. */
+  struct Block
+  {
+    Block * next;  /**< The next free block. */
+  };
+
+  /**
+   * A counter written only by its own thread, and read by GetCounts()
+   * from any thread.  Relaxed loads and stores are enough, so there's
+   * no read-modify-write on the allocation path.
+   */
+  class Counter
+  {
+  public:
+    /** @returns The current value. */
+    uint64_t Get() const
+    {
+      return m_value.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Add to the counter, from the owning thread only.
+     * @param n The amount to add, which can wrap.
+     */
+    void Add(uint64_t n)
+    {
+      m_value.store(Get() + n, std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> m_value {0};  /**< The count. */
+  };
+
+  /** Per-thread free lists and counts. */
+  struct Local
+  {
+    /** Head of the free list for each size class. */
+    std::array<Block *, MAX_CLASS + 1> heads {};
+    /** Number of blocks in each free list. */
+    std::array<std::size_t, MAX_CLASS + 1> lengths {};
+    /** Counters for this thread, as in Counts. */
+    /** @{ */
+    Counter hits;
+    Counter misses;
+    Counter frees;
+    Counter released;
+    Counter cached;
+    Counter live;
+    /** @} */
+  };
+
+  /**
+   * Get the size class for a block.
+   * @param bytes The block size.
+   * @returns The size class, or `MAX_CLASS + 1` if too large.
+   */
+  static std::size_t SizeClass(std::size_t bytes)
+  {
+    std::size_t c = MIN_CLASS;
+    while (c <= MAX_CLASS && (std::size_t{1} << c) < bytes) ++c;
+    return c;
+  }
+
+  /**
+   * Get the free lists for this thread, creating them on first use.
+   *
+   * The Local is heap allocated and never freed, so it stays valid for
+   * GetCounts() and for late frees during SST teardown.
+   * @returns The thread local free lists.
+   */
+  static Local & GetLocal()
+  {
+    thread_local Local * local = Register();
+    return *local;
+  }
+
+  /**
+   * Create and register a new Local for the calling thread.
+   * @returns The new Local.
+   */
+  static Local * Register();
+
+  /** @returns The registry of all per-thread Locals, for GetCounts(). */
+  static std::vector<const Local *> & Registry();
+
+  /** Pooling setting. */
+  enum class State : uint8_t
+  {
+    UNSET,  /**< Not set yet. */
+    ON,     /**< Pooling enabled. */
+    OFF     /**< Pooling disabled. */
+  };
+
+  /** Whether pooling is enabled, set once. */
+  static std::atomic<State> m_state;
+
+};  // class EventPool
+
+}  // namespace Phold
@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Latencies.h"
+
+#include <algorithm>  // min(), swap()
+#include <cmath>      // floor()
+#include <sstream>
+
+/**
+ * \file
+ * Phold::Latencies class implementation.
+ */
+
+namespace Phold {
+
+namespace {
+
+/**
+ * SplitMix64 generator, as in Topology.cc and `tests/latency.py`.
+ * @param [in,out] state The generator state.
+ * @returns The next value.
+ */
+uint64_t
+SplitMix64(uint64_t & state)
+{
+  state += 0x9e3779b97f4a7c15ULL;
+  uint64_t z = state;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+}  // anonymous namespace
+
+
+bool
+Latencies::Parse(const std::string & name, Kind & kind)
+{
+  if      (name == "global")  kind = Kind::GLOBAL;
+  else if (name == "tier")    kind = Kind::TIER;
+  else if (name == "uniform") kind = Kind::UNIFORM;
+  else return false;
+  return true;
+
+}  // Parse()
+
+
+bool
+Latencies::ParseTiers(const std::string & list, std::array<double, TIERS> & tiers)
+{
+  std::array<double, TIERS> values;
+  std::istringstream ss(list);
+  for (std::size_t t = 0; t < TIERS; ++t)
+    {
+      if ( ! (ss >> values[t])) return false;
+      if (t + 1 < TIERS && ss.get() != ',') return false;
+    }
+  std::string rest;
+  if (ss >> rest) return false;
+  tiers = values;
+  return true;
+
+}  // ParseTiers()
+
+
+std::string
+Latencies::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::GLOBAL:  return "global";
+    case Kind::TIER:    return "tier";
+    case Kind::UNIFORM: return "uniform";
+    }
+  return "unknown";
+
+}  // Name()
+
+
+bool
+Latencies::isValid(std::string & why) const
+{
+  switch (m_config.kind)
+    {
+    case Kind::TIER:
+      for (auto t : m_config.tiers)
+        {
+          if (t <= 0)
+            {
+              why = "tier latencies must be > 0";
+              return false;
+            }
+        }
+      if (m_config.ranksPerNode < 1)
+        {
+          why = "need at least one rank per node";
+          return false;
+        }
+      break;
+    case Kind::UNIFORM:
+      if (m_config.minimum <= 0 || m_config.max < m_config.minimum)
+        {
+          why = "uniform latencies need 0 < minimum <= max";
+          return false;
+        }
+      if (std::floor(m_config.max - m_config.minimum) != m_config.max - m_config.minimum)
+        {
+          why = "uniform latencies are whole units apart, "
+            "so max - minimum must be a whole number";
+          return false;
+        }
+      break;
+    case Kind::GLOBAL:
+    default:
+      if (m_config.minimum <= 0 || m_config.thread <= 0)
+        {
+          why = "minimum and thread latencies must be > 0";
+          return false;
+        }
+      break;
+    }
+  return true;
+
+}  // isValid()
+
+
+std::string
+Latencies::toString() const
+{
+  std::stringstream ss;
+  ss << Name(m_config.kind);
+  switch (m_config.kind)
+    {
+    case Kind::TIER:
+      ss << " (" << m_config.tiers[SAME_THREAD]
+         << ", " << m_config.tiers[SAME_RANK]
+         << ", " << m_config.tiers[SAME_NODE]
+         << ", " << m_config.tiers[REMOTE_NODE]
+         << ", " << m_config.ranksPerNode << " ranks per node)";
+      break;
+    case Kind::UNIFORM:
+      ss << " [" << m_config.minimum << ", " << m_config.max << "]";
+      break;
+    case Kind::GLOBAL:
+    default:
+      ss << " (" << m_config.thread << " within ranks, "
+         << m_config.minimum << " between)";
+      break;
+    }
+  return ss.str();
+
+}  // toString()
+
+
+Latencies::Tier
+Latencies::Classify(Place a, Place b, uint32_t ranksPerNode)
+{
+  if (a.rank == b.rank) return a.thread == b.thread ? SAME_THREAD : SAME_RANK;
+  return a.rank / ranksPerNode == b.rank / ranksPerNode ? SAME_NODE : REMOTE_NODE;
+
+}  // Classify()
+
+
+double
+Latencies::Latency(uint64_t i, uint64_t j, Place pi, Place pj) const
+{
+  switch (m_config.kind)
+    {
+    case Kind::TIER:
+      return m_config.tiers[Classify(pi, pj, m_config.ranksPerNode)];
+    case Kind::UNIFORM:
+      {
+        // Symmetric in i and j
+        if (i > j) std::swap(i, j);
+        uint64_t state = m_config.seed ^ (i * 0x9e3779b97f4a7c15ULL);
+        SplitMix64(state);
+        state ^= j;
+        const double u = (SplitMix64(state) >> 11) * 0x1.0p-53;
+        // Whole steps above minimum; isValid() checks max - minimum is whole
+        const double span = m_config.max - m_config.minimum + 1;
+        return std::min(m_config.max, m_config.minimum + std::floor(span * u));
+      }
+    case Kind::GLOBAL:
+    default:
+      return pi.rank == pj.rank ? m_config.thread : m_config.minimum;
+    }
+
+}  // Latency()
+
+
+double
+Latencies::Lookahead() const
+{
+  switch (m_config.kind)
+    {
+    case Kind::TIER:
+      return std::min(m_config.tiers[SAME_NODE], m_config.tiers[REMOTE_NODE]);
+    case Kind::UNIFORM:
+    case Kind::GLOBAL:
+    default:
+      return m_config.minimum;
+    }
+
+}  // Lookahead()
+
+
+}  // namespace Phold
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \file
+ * Phold::Latencies class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Minimum latency of each link between PHOLD LPs.
+ *
+ * The link latency is the lookahead SST uses to size its conservative
+ * synchronization windows: the window between ranks is the smallest
+ * latency of any link crossing ranks.
+ *
+ * Kind      | Latency of the link between LPs `i` and `j`
+ * --------- | ------------------------------------------------------------
+ * `global`  | `thread` within a rank, otherwise `minimum` (default)
+ * `tier`    | One of four `tiers`, by where `i` and `j` are placed:
+ *           | same thread, same rank, same node, or another node
+ * `uniform` | `minimum` plus a pseudo-random integer in `[0, max - minimum]`
+ *
+ * Nodes are consecutive blocks of `ranksPerNode` ranks.  The `uniform`
+ * draws depend only on `seed` and the pair of ids, so both ends agree.
+ * They are whole units apart, so `max - minimum` must be a whole number.
+ *
+ * The same algorithms are implemented in `tests/latency.py`; the two
+ * should agree, so phold-config and `tests/phold.py` build the same model.
+ * Phold itself just reads the latency of each link, so it works with
+ * any latencies the configuration sets.
+ */
+class Latencies
+{
+public:
+
+  /** Supported latency models. */
+  enum class Kind
+  {
+    GLOBAL,    /**< Thread latency within a rank, minimum between. */
+    TIER,      /**< By placement tier. */
+    UNIFORM    /**< Pseudo-random per link. */
+  };
+
+  /** Placement tiers, for the `tier` kind. */
+  enum Tier : std::size_t
+  {
+    SAME_THREAD,   /**< Both LPs on the same thread. */
+    SAME_RANK,     /**< Same rank, different threads. */
+    SAME_NODE,     /**< Same node, different ranks. */
+    REMOTE_NODE,   /**< Different nodes. */
+    TIERS          /**< Number of tiers. */
+  };
+
+  /** Where an LP is placed. */
+  struct Place
+  {
+    uint32_t rank   {0};  /**< The rank. */
+    uint32_t thread {0};  /**< The thread within the rank. */
+  };
+
+  /** Latency parameters. */
+  struct Config
+  {
+    /** Which model. */
+    Kind kind {Kind::GLOBAL};
+    /** Latency between ranks, and lower bound for `uniform`. */
+    double minimum {1};
+    /** Latency within a rank, for `global`. */
+    double thread {1};
+    /** Latency of each tier, for `tier`. */
+    std::array<double, TIERS> tiers {{1, 1, 1, 1}};
+    /** Upper bound for `uniform`. */
+    double max {10};
+    /** Number of ranks on each node, for `tier`. */
+    uint32_t ranksPerNode {1};
+    /** Seed for `uniform`. */
+    uint64_t seed {1};
+  };
+
+  /**
+   * C'tor.
+   * @param config The configuration.
+   */
+  explicit Latencies(const Config & config)
+    : m_config(config)
+  {
+  }
+
+  /**
+   * Parse a model name.
+   * @param name The name, such as "tier".
+   * @param [out] kind The model, if found.
+   * @returns \c true if \c name is a known model.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Parse the tier latencies, as "thread,rank,node,remote".
+   * @param list The list.
+   * @param [out] tiers The latencies, if valid.
+   * @returns \c true if \c list has four numbers.
+   */
+  static bool ParseTiers(const std::string & list, std::array<double, TIERS> & tiers);
+
+  /**
+   * Get the name of a model kind.
+   * @param kind The model kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Check the configuration for consistency.
+   * @param [out] why The error description, if invalid.
+   * @returns \c true if the configuration is valid.
+   */
+  bool isValid(std::string & why) const;
+
+  /** @returns The configuration. */
+  const Config & getConfig() const
+  {
+    return m_config;
+  }
+
+  /** @returns A short description, such as "tier (1, 1, 2, 10, 4 ranks per node)". */
+  std::string toString() const;
+
+  /**
+   * Classify a pair of placements.
+   * @param a One placement.
+   * @param b The other placement.
+   * @param ranksPerNode The number of ranks on each node.
+   * @returns The tier.
+   */
+  static Tier Classify(Place a, Place b, uint32_t ranksPerNode);
+
+  /**
+   * Get the latency of a link.
+   * @param i One LP id.
+   * @param j The other LP id.
+   * @param pi The placement of @c i.
+   * @param pj The placement of @c j.
+   * @returns The latency, in the units of the configuration.
+   */
+  double Latency(uint64_t i, uint64_t j, Place pi, Place pj) const;
+
+  /**
+   * The smallest latency any link between ranks could have, which bounds
+   * the SST synchronization window.
+   * @returns The lookahead.
+   */
+  double Lookahead() const;
+
+private:
+
+  /** The configuration. */
+  Config m_config;
+
+};  // class Latencies
+
+}  // namespace Phold
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Log.h"
+
+#include <sstream>
+
+/**
+ * \file
+ * Phold::Log class implementation.
+ */
+
+namespace Phold {
+
+Log::~Log()
+{
+  FlushAll();
+  if (m_out && m_out != stdout) std::fclose(m_out);
+
+}  // ~Log()
+
+
+bool
+Log::Parse(const std::string & name, Kind & kind)
+{
+  if      (name == "direct") kind = Kind::DIRECT;
+  else if (name == "buffer") kind = Kind::BUFFER;
+  else if (name == "file")   kind = Kind::FILE;
+  else return false;
+  return true;
+
+}  // Parse()
+
+
+std::string
+Log::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::DIRECT: return "direct";
+    case Kind::BUFFER: return "buffer";
+    case Kind::FILE:   return "file";
+    }
+  return "unknown";
+
+}  // Name()
+
+
+bool
+Log::isValid(const Config & config, std::string & why)
+{
+  if (config.kind != Kind::DIRECT && 0 == config.bytes)
+    {
+      why = "logbuffer must be > 0";
+      return false;
+    }
+  if (config.kind == Kind::FILE && config.file.empty())
+    {
+      why = "file logging needs a logfile name";
+      return false;
+    }
+  return true;
+
+}  // isValid()
+
+
+void
+Log::Configure(const Config & config, uint32_t rank, uint32_t threads)
+{
+  std::call_once(m_once, [this, &config, rank, threads]()
+    {
+      m_config = config;
+      if ( ! isBuffered()) return;
+      m_buffers.resize(threads);
+      for (auto & buffer : m_buffers) buffer.text.reserve(m_config.bytes);
+      if (m_config.kind == Kind::FILE)
+        {
+          auto name = m_config.file + "_" + std::to_string(rank) + ".log";
+          m_out = std::fopen(name.c_str(), "w");
+        }
+      // Fall back to stdout if the file can't be opened
+      if ( ! m_out) m_out = stdout;
+    });
+
+}  // Configure()
+
+
+std::string
+Log::toString() const
+{
+  std::stringstream ss;
+  ss << Name(m_config.kind);
+  if ( ! isBuffered()) return ss.str();
+  ss << " (";
+  if (m_config.kind == Kind::FILE) ss << m_config.file << "_<rank>.log, ";
+  ss << m_config.bytes << " bytes per thread)";
+  return ss.str();
+
+}  // toString()
+
+
+std::string
+Log::Expand(const std::string & pattern, const Where & where)
+{
+  std::string out;
+  out.reserve(pattern.size() + 32);
+  for (std::size_t i = 0; i < pattern.size(); ++i)
+    {
+      if (pattern[i] != '@' || i + 1 == pattern.size())
+        {
+          out += pattern[i];
+          continue;
+        }
+      switch (pattern[++i])
+        {
+        case 't': out += std::to_string(where.time);     break;
+        case 'r': out += std::to_string(where.rank);     break;
+        case 'R': out += std::to_string(where.ranks);    break;
+        case 'i': out += std::to_string(where.thread);   break;
+        case 'I': out += std::to_string(where.threads);  break;
+        case 'l': out += std::to_string(where.line);     break;
+        case 'f': out += where.file;                     break;
+        case 'p': out += where.function;                 break;
+        case 'x':
+        case 'X':
+          out += "[" + std::to_string(where.rank) + ":" + std::to_string(where.thread) + "]";
+          break;
+        case '@': out += '@';                            break;
+        default:
+          out += '@';
+          out += pattern[i];
+          break;
+        }
+    }
+  return out;
+
+}  // Expand()
+
+
+void
+Log::Write(const Where & where, const std::string & prefix,
+           const char * format, va_list args)
+{
+  auto & buffer = m_buffers[where.thread];
+  buffer.text += Expand(prefix, where);
+
+  // Format in place, at the end of the buffer
+  va_list copy;
+  va_copy(copy, args);
+  const auto start = buffer.text.size();
+  const int bytes = std::vsnprintf(nullptr, 0, format, copy);
+  va_end(copy);
+  if (bytes > 0)
+    {
+      buffer.text.resize(start + bytes + 1);
+      std::vsnprintf(&buffer.text[start], bytes + 1, format, args);
+      buffer.text.resize(start + bytes);
+    }
+  if (buffer.text.size() >= m_config.bytes) Drain(buffer);
+
+}  // Write()
+
+
+void
+Log::Flush(uint32_t thread)
+{
+  if (thread < m_buffers.size()) Drain(m_buffers[thread]);
+
+}  // Flush()
+
+
+void
+Log::FlushAll()
+{
+  for (auto & buffer : m_buffers) Drain(buffer);
+
+}  // FlushAll()
+
+
+void
+Log::Drain(Buffer & buffer)
+{
+  if (buffer.text.empty() || ! m_out) return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::fwrite(buffer.text.data(), 1, buffer.text.size(), m_out);
+  std::fflush(m_out);
+  buffer.text.clear();
+
+}  // Drain()
+
+
+}  // namespace Phold
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <cstdarg>    // va_list
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>     // FILE
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * Phold::Log class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Buffered log sink, for the Phold OUTPUT() and VERBOSE() messages.
+ *
+ * Kind     | Messages go to
+ * -------- | ------------------------------------------------------------
+ * `direct` | SST::Output, flushed after every message (default)
+ * `buffer` | A buffer per thread, written to stdout in large blocks
+ * `file`   | A buffer per thread, written in blocks to `<logfile>_<rank>.log`
+ *
+ * With SST::Output every message takes the stdout lock and flushes,
+ * so verbose runs with many LPs spend their time in I/O.  Here each
+ * thread formats into its own buffer, with no locking, and only takes
+ * the rank lock to write a full buffer, of `logbuffer` bytes, in one
+ * block.  The rest is written when each LP finishes, and at exit.
+ *
+ * Messages keep the SST::Output prefixes, expanded here the same way:
+ *
+ * Code | Expands to
+ * ---- | -------------------------------------------
+ * `@t` | Simulation time, in core cycles
+ * `@x` | `[rank:thread]`
+ * `@X` | `[rank:thread]`, the same as `@x`
+ * `@r` | Rank
+ * `@R` | Number of ranks
+ * `@i` | Thread
+ * `@I` | Number of threads
+ * `@f` | File
+ * `@l` | Line
+ * `@p` | Function
+ * `@@` | `@`
+ *
+ * Blocks from different threads interleave, but each block holds
+ * whole messages, and each thread's messages are in order.
+ */
+class Log
+{
+public:
+
+  /** Where messages go. */
+  enum class Kind
+  {
+    DIRECT,   /**< SST::Output, unbuffered. */
+    BUFFER,   /**< Per thread buffers, to stdout. */
+    FILE      /**< Per thread buffers, to a file per rank. */
+  };
+
+  /** Log parameters, as read from the component Params. */
+  struct Config
+  {
+    /** Where messages go. */
+    Kind kind {Kind::DIRECT};
+    /** File base name, for Kind::FILE. */
+    std::string file {"phold"};
+    /** Buffer size per thread, bytes. */
+    std::size_t bytes {1 << 20};
+  };
+
+  /** The source of a message, for the prefix. */
+  struct Where
+  {
+    uint64_t     time;      /**< Simulation time, core cycles. */
+    uint32_t     rank;      /**< Rank. */
+    uint32_t     ranks;     /**< Number of ranks. */
+    uint32_t     thread;    /**< Thread. */
+    uint32_t     threads;   /**< Number of threads. */
+    uint32_t     line;      /**< Source line. */
+    const char * file;      /**< Source file. */
+    const char * function;  /**< Function. */
+  };
+
+  /** Default c'tor, with direct output. */
+  Log() = default;
+
+  /** Write anything left, and close the file. */
+  ~Log();
+
+  Log(const Log &) = delete;
+  Log & operator = (const Log &) = delete;
+
+  /**
+   * Parse a kind name.
+   * @param name The name, such as "buffer".
+   * @param [out] kind The kind, if found.
+   * @returns \c true if \c name is a known kind.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Get the name of a kind.
+   * @param kind The kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Check a configuration for consistency.
+   * @param config The configuration.
+   * @param [out] why The error description, if invalid.
+   * @returns \c true if the configuration is valid.
+   */
+  static bool isValid(const Config & config, std::string & why);
+
+  /**
+   * Set up the buffers, and open the file.  Only the first call has
+   * any effect, so every LP can call this.
+   * @param config The configuration.
+   * @param rank This rank.
+   * @param threads The number of threads on this rank.
+   */
+  void Configure(const Config & config, uint32_t rank, uint32_t threads);
+
+  /** @returns \c true if messages should go through Write(). */
+  bool isBuffered() const
+  {
+    return m_config.kind != Kind::DIRECT;
+  }
+
+  /** @returns A short description, such as "file (phold_<rank>.log, 1048576 bytes)". */
+  std::string toString() const;
+
+  /**
+   * Expand the SST::Output prefix codes.
+   * @param pattern The prefix, such as "@t:@X:Phold-0 [@p()] -> ".
+   * @param where The message source.
+   * @returns The expanded prefix.
+   */
+  static std::string Expand(const std::string & pattern, const Where & where);
+
+  /**
+   * Add a message to the buffer of the thread in \c where.
+   * Only called from that thread.
+   * @param where The message source.
+   * @param prefix The unexpanded prefix.
+   * @param format The printf format.
+   * @param args The format arguments.
+   */
+  void Write(const Where & where, const std::string & prefix,
+             const char * format, va_list args);
+
+  /**
+   * Write the buffer of one thread.
+   * @param thread The thread.
+   */
+  void Flush(uint32_t thread);
+
+  /** Write every buffer. */
+  void FlushAll();
+
+private:
+
+  /** One thread's buffer, on its own cache lines. */
+  struct alignas(64) Buffer
+  {
+    std::string text;  /**< Formatted messages. */
+  };
+
+  /**
+   * Write and clear a buffer, under m_mutex.
+   * @param buffer The buffer.
+   */
+  void Drain(Buffer & buffer);
+
+  Config               m_config;          /**< The configuration. */
+  std::once_flag       m_once;            /**< Guard for Configure(). */
+  std::mutex           m_mutex;           /**< Guard for m_out. */
+  std::FILE *          m_out {nullptr};   /**< Where blocks are written. */
+  std::vector<Buffer>  m_buffers;         /**< Buffers, by thread. */
+
+};  // class Log
+
+}  // namespace Phold
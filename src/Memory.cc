@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Memory.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>  // getrusage()
+
+/**
+ * \file
+ * Phold::Memory class implementation.
+ */
+
+namespace Phold {
+
+std::array<std::once_flag, Memory::PHASES> Memory::m_once;
+std::array<Memory::Sample, Memory::PHASES> Memory::m_samples;
+
+
+Memory::Sample
+Memory::Now()
+{
+  Sample sample;
+#ifdef __linux__
+  // Lines like "VmRSS:     12345 kB"
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+    {
+      uint64_t * field = nullptr;
+      if      (line.compare(0, 6, "VmRSS:") == 0) field = &sample.resident;
+      else if (line.compare(0, 6, "VmHWM:") == 0) field = &sample.peak;
+      else continue;
+      std::istringstream value(line.substr(6));
+      uint64_t kb {0};
+      value >> kb;
+      *field = kb * 1024;
+    }
+#endif
+  if (0 == sample.peak)
+    {
+      struct rusage usage;
+      if (0 == getrusage(RUSAGE_SELF, &usage))
+        {
+#ifdef __APPLE__
+          // macOS reports bytes
+          sample.peak = static_cast<uint64_t>(usage.ru_maxrss);
+#else
+          sample.peak = static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+        }
+    }
+  return sample;
+
+}  // Now()
+
+
+void
+Memory::Record(Phase phase)
+{
+  std::call_once(m_once[phase], [phase]() { m_samples[phase] = Now(); });
+
+}  // Record()
+
+
+const char *
+Memory::Name(Phase phase)
+{
+  switch (phase)
+    {
+    case START:        return "start";
+    case CONSTRUCTION: return "construction";
+    case INIT:         return "init";
+    case RUN:          return "run";
+    case COMPLETE:     return "complete";
+    case PHASES:
+    default:           break;
+    }
+  return "unknown";
+
+}  // Name()
+
+
+}  // namespace Phold
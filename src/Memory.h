@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>    // once_flag
+
+/**
+ * \file
+ * Phold::Memory class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Process memory measurements, at the end of each simulation phase.
+ *
+ * Each phase is sampled once per process (SST rank), by the first LP
+ * on any thread to reach the end of that phase; later callers wait for
+ * the first to finish, so every LP sees the same sample.
+ *
+ * Phase          | Sampled at
+ * -------------- | ------------------------------------------
+ * `start`        | First LP c'tor
+ * `construction` | First init() call, after all c'tors
+ * `init`         | First setup() call, after all init() phases
+ * `run`          | First complete() call, after the run
+ * `complete`     | First finish() call, after all complete() phases
+ *
+ * The resident set and peak resident set (high water mark) are read
+ * from `/proc/self/status` on Linux; elsewhere the peak is from
+ * `getrusage()` and the resident set is not available.
+ */
+class Memory
+{
+public:
+
+  /** The phases. */
+  enum Phase : std::size_t
+  {
+    START,          /**< Before construction. */
+    CONSTRUCTION,   /**< After construction. */
+    INIT,           /**< After init(). */
+    RUN,            /**< After the run. */
+    COMPLETE,       /**< After complete(). */
+    PHASES          /**< Number of phases. */
+  };
+
+  /** A measurement. */
+  struct Sample
+  {
+    uint64_t resident {0};  /**< Resident set size, bytes. */
+    uint64_t peak     {0};  /**< Peak resident set size, bytes. */
+  };
+
+  /** Per LP memory, counted from the sizes of the objects allocated. */
+  struct Footprint
+  {
+    uint64_t links    {0};  /**< SST::Link objects and their Neighbor entries. */
+    uint64_t handlers {0};  /**< Event handlers. */
+    uint64_t rng      {0};  /**< The Rng policy. */
+    uint64_t stats    {0};  /**< Statistics objects. */
+
+    /** @returns The sum of all the parts. */
+    uint64_t Total() const
+    {
+      return links + handlers + rng + stats;
+    }
+
+    /**
+     * Add another footprint.
+     * @param other The other footprint.
+     * @returns This footprint.
+     */
+    Footprint & operator += (const Footprint & other)
+    {
+      links    += other.links;
+      handlers += other.handlers;
+      rng      += other.rng;
+      stats    += other.stats;
+      return *this;
+    }
+  };
+
+  /** @returns A measurement now. */
+  static Sample Now();
+
+  /**
+   * Sample a phase, if not already sampled in this process.
+   * @param phase The phase which just ended.
+   */
+  static void Record(Phase phase);
+
+  /**
+   * Get the phase sample.
+   * @param phase The phase.
+   * @returns The sample, or zeros if not recorded.
+   */
+  static Sample Get(Phase phase)
+  {
+    return m_samples[phase];
+  }
+
+  /**
+   * Get the name of a phase.
+   * @param phase The phase.
+   * @returns The name.
+   */
+  static const char * Name(Phase phase);
+
+private:
+
+  /** One flag per phase, for Record(). */
+  static std::array<std::once_flag, PHASES> m_once;
+
+  /** The samples. */
+  static std::array<Sample, PHASES> m_samples;
+
+};  // class Memory
+
+}  // namespace Phold
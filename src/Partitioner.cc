@@ -0,0 +1,445 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Partitioner.h"
+
+#include <algorithm>  // sort()
+#include <cmath>      // pow()
+#include <deque>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <utility>    // pair
+
+/**
+ * \file
+ * Phold::Partitioner class implementation.
+ */
+
+namespace Phold {
+
+Partitioner::Partitioner(const Config & config)
+  : m_config(config)
+{
+}
+
+
+bool
+Partitioner::Parse(const std::string & name, Kind & kind)
+{
+  if      (name == "linear") kind = Kind::LINEAR;
+  else if (name == "graph")  kind = Kind::GRAPH;
+  else return false;
+  return true;
+
+}  // Parse()
+
+
+std::string
+Partitioner::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::LINEAR: return "linear";
+    case Kind::GRAPH:  return "graph";
+    }
+  return "unknown";
+
+}  // Name()
+
+
+void
+Partitioner::Partition(const Topology & topology, const Latencies & latencies)
+{
+  const uint64_t n = topology.getConfig().number;
+  m_part.assign(n, 0);
+  Linear();
+  if (m_config.kind == Kind::LINEAR || topology.isFull()) return;
+
+  // Only uniform latencies are fixed per link; the others depend on
+  // the placement, so every link costs the same to cut
+  const auto & lc = latencies.getConfig();
+  const bool weighted = lc.kind == Latencies::Kind::UNIFORM;
+  Graph graph;
+  graph.offsets.reserve(n + 1);
+  graph.offsets.push_back(0);
+  for (uint64_t i = 0; i < n; ++i)
+    {
+      auto nbrs = topology.neighbors(i);
+      graph.adj.insert(graph.adj.end(), nbrs.begin(), nbrs.end());
+      for (auto j : nbrs)
+        {
+          graph.weight.push_back(weighted ? lc.minimum / latencies.Latency(i, j, {}, {}) : 1.0);
+        }
+      graph.offsets.push_back(graph.adj.size());
+    }
+
+  const uint32_t parts = m_config.ranks * m_config.threads;
+  std::vector<uint64_t> sizes(parts);
+  for (uint32_t p = 0; p < parts; ++p) sizes[p] = PartSize(n, p, parts);
+
+  // Lookahead, negated so smaller is better,
+  // then the weighted links cut between ranks, then threads
+  auto cost = [&graph, &latencies, this]()
+    {
+      const uint32_t t = m_config.threads;
+      std::tuple<double, double, double> c {-Lookahead(graph, latencies), 0, 0};
+      for (uint64_t i = 0; i + 1 < graph.offsets.size(); ++i)
+        {
+          for (auto k = graph.offsets[i]; k < graph.offsets[i + 1]; ++k)
+            {
+              const auto j = graph.adj[k];
+              if      (m_part[i] / t != m_part[j] / t) std::get<1>(c) += graph.weight[k];
+              else if (m_part[i] != m_part[j])         std::get<2>(c) += graph.weight[k];
+            }
+        }
+      return c;
+    };
+  const auto linearCost = cost();
+  auto linear = m_part;
+
+  std::vector<uint64_t> lps(n);
+  for (uint64_t i = 0; i < n; ++i) lps[i] = i;
+  m_side.assign(n, -1);
+  Bisect(graph, lps, 0, parts, sizes);
+  m_side.clear();
+  m_side.shrink_to_fit();
+
+  // Regular topologies are often already well cut by id blocks
+  if (linearCost <= cost()) m_part.swap(linear);
+
+}  // Partition()
+
+
+double
+Partitioner::Lookahead(const Graph & graph, const Latencies & latencies) const
+{
+  const uint32_t t = m_config.threads;
+  auto lookahead = std::numeric_limits<double>::infinity();
+  for (uint64_t i = 0; i + 1 < graph.offsets.size(); ++i)
+    {
+      const Latencies::Place pi {m_part[i] / t, m_part[i] % t};
+      for (auto k = graph.offsets[i]; k < graph.offsets[i + 1]; ++k)
+        {
+          const auto j = graph.adj[k];
+          if (j < i || m_part[j] / t == pi.rank) continue;
+          const Latencies::Place pj {m_part[j] / t, m_part[j] % t};
+          lookahead = std::min(lookahead, latencies.Latency(i, j, pi, pj));
+        }
+    }
+  return lookahead;
+
+}  // Lookahead()
+
+
+void
+Partitioner::Linear()
+{
+  const uint64_t n = m_part.size();
+  const uint64_t parts = uint64_t(m_config.ranks) * m_config.threads;
+  const uint64_t per = n / parts;
+  const uint64_t extra = n % parts;
+  // The first extra blocks have per + 1 LPs
+  const uint64_t big = extra * (per + 1);
+  for (uint64_t id = 0; id < n; ++id)
+    {
+      m_part[id] = static_cast<uint32_t>(id < big ? id / (per + 1) : extra + (id - big) / per);
+    }
+
+}  // Linear()
+
+
+void
+Partitioner::Bisect(const Graph & graph, std::vector<uint64_t> & lps,
+                    uint32_t p0, uint32_t p1, const std::vector<uint64_t> & sizes)
+{
+  if (p1 - p0 == 1)
+    {
+      for (auto lp : lps) m_part[lp] = p0;
+      return;
+    }
+
+  // Split between ranks first, then between the threads of one rank
+  const uint32_t t = m_config.threads;
+  uint32_t mid;
+  if (p0 / t != (p1 - 1) / t)
+    {
+      const uint32_t r0 = p0 / t;
+      const uint32_t r1 = p1 / t;
+      mid = (r0 + (r1 - r0) / 2) * t;
+    }
+  else
+    {
+      mid = p0 + (p1 - p0) / 2;
+    }
+  uint64_t target {0};
+  for (uint32_t p = p0; p < mid; ++p) target += sizes[p];
+
+  // Side 1 is everyone not yet grown; 2 marks visited in the peripheral search
+  for (auto lp : lps) m_side[lp] = 1;
+
+  // Find a peripheral LP: the last one reached from the first
+  std::deque<uint64_t> queue {lps.front()};
+  std::vector<uint64_t> seen {lps.front()};
+  m_side[lps.front()] = 2;
+  uint64_t start = lps.front();
+  while ( ! queue.empty())
+    {
+      start = queue.front();
+      queue.pop_front();
+      for (auto k = graph.offsets[start]; k < graph.offsets[start + 1]; ++k)
+        {
+          const auto j = graph.adj[k];
+          if (m_side[j] != 1) continue;
+          m_side[j] = 2;
+          seen.push_back(j);
+          queue.push_back(j);
+        }
+    }
+  for (auto lp : seen) m_side[lp] = 1;
+
+  // Grow side 0 breadth first from there, jumping to the next
+  // ungrown LP if this component runs out
+  uint64_t grown {0};
+  std::size_t next {0};
+  queue.assign(1, start);
+  m_side[start] = 0;
+  ++grown;
+  while (grown < target)
+    {
+      if (queue.empty())
+        {
+          while (m_side[lps[next]] != 1) ++next;
+          queue.push_back(lps[next]);
+          m_side[lps[next]] = 0;
+          ++grown;
+          continue;
+        }
+      const auto i = queue.front();
+      queue.pop_front();
+      for (auto k = graph.offsets[i]; k < graph.offsets[i + 1] && grown < target; ++k)
+        {
+          const auto j = graph.adj[k];
+          if (m_side[j] != 1) continue;
+          m_side[j] = 0;
+          ++grown;
+          queue.push_back(j);
+        }
+    }
+
+  Refine(graph, lps);
+
+  std::vector<uint64_t> lo, hi;
+  lo.reserve(target);
+  hi.reserve(lps.size() - target);
+  for (auto lp : lps)
+    {
+      (m_side[lp] == 0 ? lo : hi).push_back(lp);
+      m_side[lp] = -1;
+    }
+  // Release our copy before recursing
+  std::vector<uint64_t>().swap(lps);
+
+  Bisect(graph, lo, p0, mid, sizes);
+  Bisect(graph, hi, mid, p1, sizes);
+
+}  // Bisect()
+
+
+double
+Partitioner::Gain(const Graph & graph, uint64_t lp) const
+{
+  const auto side = m_side[lp];
+  double gain {0};
+  for (auto k = graph.offsets[lp]; k < graph.offsets[lp + 1]; ++k)
+    {
+      const auto s = m_side[graph.adj[k]];
+      if (s < 0) continue;   // Not in this bisection
+      gain += (s == side) ? -graph.weight[k] : graph.weight[k];
+    }
+  return gain;
+
+}  // Gain()
+
+
+void
+Partitioner::Refine(const Graph & graph, const std::vector<uint64_t> & lps)
+{
+  // Swap pairs of boundary LPs, best gains first, so the sizes don't change
+  using Candidate = std::pair<double, uint64_t>;
+  for (unsigned pass = 0; pass < m_config.passes; ++pass)
+    {
+      std::vector<Candidate> side[2];
+      for (auto lp : lps)
+        {
+          bool boundary = false;
+          for (auto k = graph.offsets[lp]; k < graph.offsets[lp + 1] && ! boundary; ++k)
+            {
+              const auto s = m_side[graph.adj[k]];
+              boundary = s >= 0 && s != m_side[lp];
+            }
+          if (boundary) side[m_side[lp]].emplace_back(Gain(graph, lp), lp);
+        }
+      for (auto & s : side)
+        {
+          std::sort(s.begin(), s.end(), std::greater<Candidate>());
+        }
+
+      double improved {0};
+      const auto swaps = std::min(side[0].size(), side[1].size());
+      for (std::size_t k = 0; k < swaps; ++k)
+        {
+          // Gains are stale after earlier swaps, so recompute them
+          const auto a = side[0][k].second;
+          const auto b = side[1][k].second;
+          double gain = Gain(graph, a) + Gain(graph, b);
+          for (auto e = graph.offsets[a]; e < graph.offsets[a + 1]; ++e)
+            {
+              if (graph.adj[e] == b) gain -= 2 * graph.weight[e];
+            }
+          if (gain <= 0) break;
+          m_side[a] = 1;
+          m_side[b] = 0;
+          improved += gain;
+        }
+      if (improved <= 0) break;
+    }
+
+}  // Refine()
+
+
+Partitioner::Metrics
+Partitioner::Measure(const Topology & topology, const Destinations & dests) const
+{
+  Metrics m;
+  const uint64_t n = m_part.size();
+  const uint32_t t = m_config.threads;
+  const uint32_t parts = m_config.ranks * t;
+
+  std::vector<uint64_t> partSize(parts, 0), rankSize(m_config.ranks, 0);
+  for (auto p : m_part)
+    {
+      ++partSize[p];
+      ++rankSize[p / t];
+    }
+  auto mm = std::minmax_element(partSize.begin(), partSize.end());
+  m.minSize = *mm.first;
+  m.maxSize = *mm.second;
+
+  if ( ! topology.isFull())
+    {
+      // Every link carries the same traffic, see the class description
+      uint64_t ends {0};
+      for (uint64_t i = 0; i < n; ++i)
+        {
+          for (auto j : topology.neighbors(i))
+            {
+              ++ends;
+              if      (m_part[i] / t != m_part[j] / t) ++m.rankCut;
+              else if (m_part[i] != m_part[j])         ++m.threadCut;
+            }
+        }
+      m.links = ends / 2;
+      m.rankCut /= 2;
+      m.threadCut /= 2;
+      if (ends > 0)
+        {
+          m.rankRemote   = m_config.remote * 2 * m.rankCut / ends;
+          m.threadRemote = m_config.remote * 2 * m.threadCut / ends;
+        }
+      return m;
+    }
+
+  // Full topology: every pair is linked
+  auto squares = [](const std::vector<uint64_t> & sizes)
+    {
+      uint64_t sum {0};
+      for (auto s : sizes) sum += s * s;
+      return sum;
+    };
+  const uint64_t rankSq = squares(rankSize);
+  m.links = n * (n - 1) / 2;
+  m.rankCut = (n * n - rankSq) / 2;
+  m.threadCut = (rankSq - squares(partSize)) / 2;
+
+  // Probability an event from each LP leaves its group,
+  // weighted by each LP's steady state send rate
+  const auto & dc = dests.getConfig();
+  // Zipf weight of each rank among the n - 1 other LPs, see Destinations
+  std::vector<double> weight;
+  double total {0};
+  if (dc.kind == Destinations::Kind::ZIPF && n > 1)
+    {
+      weight.resize(n - 1);
+      for (uint64_t r = 0; r + 1 < n; ++r)
+        {
+          weight[r] = 1.0 / std::pow(double(r + 1), dc.exponent);
+          total += weight[r];
+        }
+    }
+  auto leave = [&](const std::vector<uint64_t> & sizes, uint32_t div) -> double
+    {
+      // Zipf weight to each group, from the LPs below and above the sender:
+      // LP k is rank k from senders above it, rank k - 1 from those below
+      std::vector<double> below, above;
+      if (dc.kind == Destinations::Kind::ZIPF)
+        {
+          below.assign(sizes.size(), 0);
+          above.assign(sizes.size(), 0);
+          for (uint64_t k = 1; k < n; ++k) above[m_part[k] / div] += weight[k - 1];
+        }
+      double sum {0}, rates {0};
+      std::vector<uint64_t> inBlock(sizes.size(), 0);
+      for (uint64_t i = 0; i < n; ++i)
+        {
+          const auto g = m_part[i] / div;
+          double p = double(n - sizes[g]) / (n - 1);
+          double rate {1};
+          if (dc.kind == Destinations::Kind::ZIPF)
+            {
+              // Step past i, so above only has the LPs after it
+              if (i > 0) above[g] -= weight[i - 1];
+              p = 1 - (below[g] + above[g]) / total;
+              if (i + 1 < n) below[g] += weight[i];
+              // Recipients send what they receive, from uniform senders
+              rate = (i > 0 ? i * weight[i - 1] : 0)
+                + (i + 1 < n ? (n - 1 - i) * weight[i] : 0);
+            }
+          else if (dc.kind == Destinations::Kind::LOCAL && dc.localSize > 0)
+            {
+              const uint64_t begin = i - i % dc.localSize;
+              const uint64_t end = std::min(begin + dc.localSize, n);
+              if (end - begin > 1)
+                {
+                  if (i == begin)
+                    {
+                      // Count this block's LPs in each group
+                      for (uint64_t k = begin; k < end; ++k) ++inBlock[m_part[k] / div];
+                    }
+                  const double local = double(end - begin - inBlock[g]) / (end - begin - 1);
+                  p = dc.locality * local + (1 - dc.locality) * p;
+                  if (i + 1 == end)
+                    {
+                      for (uint64_t k = begin; k < end; ++k) inBlock[m_part[k] / div] = 0;
+                    }
+                }
+            }
+          sum += rate * p;
+          rates += rate;
+        }
+      return rates > 0 ? m_config.remote * sum / rates : 0;
+    };
+  m.rankRemote = leave(rankSize, t);
+  m.threadRemote = leave(partSize, 1) - m.rankRemote;
+  return m;
+
+}  // Measure()
+
+
+}  // namespace Phold
@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include "Destinations.h"
+#include "Latencies.h"
+#include "Topology.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * Phold::Partitioner class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Assign PHOLD LPs to ranks and threads, and measure the result.
+ *
+ * Kind     | Placement
+ * -------- | ------------------------------------------------------------
+ * `linear` | Contiguous blocks of LP ids, as the SST linear partitioner
+ * `graph`  | Recursive bisection of the topology, minimizing the edge cut
+ *
+ * Each LP sends to its neighbors uniformly, and the neighbor relation
+ * is symmetric, so in steady state every LP sends in proportion to its
+ * degree, and every link carries the same traffic.  Minimizing the
+ * number of cut links therefore minimizes the cross rank traffic.
+ * The graph partitioner also maximizes the lookahead, the smallest
+ * latency of any link between ranks, see below.
+ * The graph partitioner bisects into ranks first, then each rank
+ * into threads, so the rank cut is minimized before the thread cut.
+ * Each bisection grows one side by breadth first search from a
+ * peripheral LP, then improves it with balanced boundary swaps.
+ * The part sizes are the same as the linear partitioner, and if the
+ * linear placement is better (as for rings and hierarchical groups
+ * aligned to threads) it is kept instead.
+ *
+ * For the full topology the traffic is set by the Destinations
+ * distribution instead.  Uniform destinations make every balanced
+ * placement equivalent, while the local and zipf distributions favor
+ * contiguous id blocks, so `graph` uses the linear placement there,
+ * and only Measure() uses the Destinations.
+ *
+ * The lookahead depends on the Latencies:
+ *
+ * Latencies | Lookahead
+ * --------- | ------------------------------------------------------------
+ * `global`  | `minimum` for any placement which cuts a link
+ * `uniform` | Fixed per link, so the bisection weights each link by
+ *           | `minimum / latency`, and cuts the slow links first
+ * `tier`    | Set by the placement: the node tier if any link joins
+ *           | two ranks on the same node, otherwise the remote tier
+ *
+ * In all cases the graph and linear placements are compared by
+ * lookahead first, then by the (weighted) links cut between ranks,
+ * then between threads.  phold-config reports the lookahead achieved
+ * alongside these Metrics.
+ */
+class Partitioner
+{
+public:
+
+  /** Supported placements. */
+  enum class Kind
+  {
+    LINEAR,   /**< Contiguous blocks of ids. */
+    GRAPH     /**< Topology graph bisection. */
+  };
+
+  /** Partition parameters. */
+  struct Config
+  {
+    /** Which placement. */
+    Kind kind {Kind::LINEAR};
+    /** Number of ranks. */
+    uint32_t ranks {1};
+    /** Number of threads per rank. */
+    uint32_t threads {1};
+    /** Fraction of events sent to other LPs. */
+    double remote {0.9};
+    /** Number of refinement passes per bisection. */
+    unsigned passes {8};
+  };
+
+  /** Partition quality metrics. */
+  struct Metrics
+  {
+    /** Number of topology links. */
+    uint64_t links {0};
+    /** Links between ranks. */
+    uint64_t rankCut {0};
+    /** Links between threads on the same rank. */
+    uint64_t threadCut {0};
+    /** Fewest LPs on one thread. */
+    uint64_t minSize {0};
+    /** Most LPs on one thread. */
+    uint64_t maxSize {0};
+    /** Expected fraction of all events sent to another rank. */
+    double rankRemote {0};
+    /** Expected fraction of all events sent to another thread on the same rank. */
+    double threadRemote {0};
+  };
+
+  /**
+   * C'tor.
+   * @param config The configuration.
+   */
+  explicit Partitioner(const Config & config);
+
+  /**
+   * Parse a partitioner name.
+   * @param name The name, such as "graph".
+   * @param [out] kind The partitioner, if found.
+   * @returns \c true if \c name is a known partitioner.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Get the name of a partitioner kind.
+   * @param kind The partitioner kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Place every LP.
+   * Only sparse topologies are bisected; the full topology always gets
+   * the linear placement, see the class description.  The Destinations
+   * only matter for measuring it, in Measure().
+   * @param topology The LP connectivity.
+   * @param latencies The link latencies, for the lookahead.
+   */
+  void Partition(const Topology & topology, const Latencies & latencies);
+
+  /**
+   * Get the partition of an LP.
+   * @param id The LP id.
+   * @returns The partition, `rank * threads + thread`.
+   */
+  uint32_t getPart(uint64_t id) const
+  {
+    return m_part[id];
+  }
+
+  /** @returns The configuration. */
+  const Config & getConfig() const
+  {
+    return m_config;
+  }
+
+  /**
+   * Measure the current placement.
+   * @param topology The LP connectivity.
+   * @param dests The destinations for the full topology.
+   * @returns The metrics.
+   */
+  Metrics Measure(const Topology & topology, const Destinations & dests) const;
+
+  /**
+   * Number of LPs on each part, with the linear partitioner layout:
+   * the first `number % parts` parts get one extra LP.
+   * @param number The number of LPs.
+   * @param part The part.
+   * @param parts The number of parts.
+   * @returns The number of LPs on @c part.
+   */
+  static uint64_t PartSize(uint64_t number, uint64_t part, uint64_t parts)
+  {
+    return number / parts + (part < number % parts ? 1 : 0);
+  }
+
+private:
+
+  /** Adjacency of the topology, in compressed sparse row form. */
+  struct Graph
+  {
+    std::vector<uint64_t> offsets;  /**< Start of each LP's neighbors. */
+    std::vector<uint64_t> adj;      /**< The neighbors. */
+    /** Cost of cutting each link, in (0, 1], parallel to adj. */
+    std::vector<double>   weight;
+  };
+
+  /** Place contiguous blocks. */
+  void Linear();
+
+  /**
+   * The lookahead of the current placement.
+   * @param graph The topology.
+   * @param latencies The link latencies.
+   * @returns The smallest latency of any link between ranks,
+   *   or infinity if no link crosses ranks.
+   */
+  double Lookahead(const Graph & graph, const Latencies & latencies) const;
+
+  /**
+   * Recursive bisection of @c lps into parts `[p0, p1)`.
+   * @param graph The topology.
+   * @param lps The LPs to place.
+   * @param p0 The first part.
+   * @param p1 One past the last part.
+   * @param sizes The target size of each part.
+   */
+  void Bisect(const Graph & graph, std::vector<uint64_t> & lps,
+              uint32_t p0, uint32_t p1, const std::vector<uint64_t> & sizes);
+
+  /**
+   * Improve a bisection by swapping boundary LPs.
+   * @param graph The topology.
+   * @param lps The LPs in this bisection.
+   */
+  void Refine(const Graph & graph, const std::vector<uint64_t> & lps);
+
+  /**
+   * The gain in weighted cut links from moving an LP to the other side.
+   * @param graph The topology.
+   * @param lp The LP.
+   * @returns The gain.
+   */
+  double Gain(const Graph & graph, uint64_t lp) const;
+
+  /** The configuration. */
+  Config m_config;
+
+  /** Partition of each LP. */
+  std::vector<uint32_t> m_part;
+
+  /**
+   * Side of each LP in the current bisection: 0 or 1,
+   * or -1 if not part of it.
+   */
+  std::vector<int8_t> m_side;
+
+};  // class Partitioner
+
+}  // namespace Phold
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Payloads.h"
+
+#include <sstream>
+
+/**
+ * \file
+ * Phold::Payloads class implementation.
+ */
+
+namespace Phold {
+
+Payloads::Payloads(const Config & config)
+  : m_config(config)
+{
+  switch (m_config.kind)
+    {
+    case Kind::FIXED:
+      m_max = m_config.size;
+      break;
+    case Kind::LOGNORMAL:
+      m_max = m_config.max ? m_config.max : 16 * m_config.size;
+      if (m_config.size > 0)
+        {
+          // E[x] = exp(mu + sigma^2 / 2)
+          m_mu = std::log(double(m_config.size)) - m_config.sigma * m_config.sigma / 2;
+        }
+      break;
+    case Kind::UNIFORM:
+    case Kind::BIMODAL:
+      m_max = m_config.max;
+      break;
+    }
+}
+
+
+bool
+Payloads::Parse(const std::string & name, Kind & kind)
+{
+  if      (name == "fixed")     kind = Kind::FIXED;
+  else if (name == "uniform")   kind = Kind::UNIFORM;
+  else if (name == "lognormal") kind = Kind::LOGNORMAL;
+  else if (name == "bimodal")   kind = Kind::BIMODAL;
+  else return false;
+  return true;
+
+}  // Parse()
+
+
+std::string
+Payloads::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::FIXED:     return "fixed";
+    case Kind::UNIFORM:   return "uniform";
+    case Kind::LOGNORMAL: return "lognormal";
+    case Kind::BIMODAL:   return "bimodal";
+    }
+  return "unknown";
+
+}  // Name()
+
+
+bool
+Payloads::isValid(std::string & why) const
+{
+  switch (m_config.kind)
+    {
+    case Kind::UNIFORM:
+    case Kind::BIMODAL:
+      if (m_config.min > m_config.max)
+        {
+          why = "buffermin can't be larger than buffermax";
+          return false;
+        }
+      if (m_config.kind == Kind::BIMODAL && (m_config.large < 0 || m_config.large > 1))
+        {
+          why = "bufferlarge must be in [0, 1]";
+          return false;
+        }
+      break;
+    case Kind::LOGNORMAL:
+      if (0 == m_config.size)
+        {
+          why = "lognormal payloads need a mean buffer size > 0";
+          return false;
+        }
+      if (m_config.sigma < 0)
+        {
+          why = "buffersigma can't be negative";
+          return false;
+        }
+      break;
+    case Kind::FIXED:
+    default:
+      break;
+    }
+  return true;
+
+}  // isValid()
+
+
+double
+Payloads::Mean() const
+{
+  switch (m_config.kind)
+    {
+    case Kind::UNIFORM:
+      return (m_config.min + m_config.max) / 2.0;
+    case Kind::BIMODAL:
+      return m_config.large * m_config.max + (1 - m_config.large) * m_config.min;
+    case Kind::LOGNORMAL:
+    case Kind::FIXED:
+    default:
+      return double(m_config.size);
+    }
+
+}  // Mean()
+
+
+std::string
+Payloads::toString() const
+{
+  std::stringstream ss;
+  switch (m_config.kind)
+    {
+    case Kind::FIXED:
+      ss << m_config.size;
+      break;
+    case Kind::UNIFORM:
+      ss << "uniform [" << m_config.min << ", " << m_config.max << "]";
+      break;
+    case Kind::LOGNORMAL:
+      ss << "lognormal (mean " << m_config.size << ", sigma " << m_config.sigma
+         << ", max " << m_max << ")";
+      break;
+    case Kind::BIMODAL:
+      ss << "bimodal (" << m_config.min << ", or " << m_config.max
+         << " with p = " << m_config.large << ")";
+      break;
+    }
+  return ss.str();
+
+}  // toString()
+
+
+}  // namespace Phold
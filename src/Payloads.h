@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <algorithm>  // min()
+#include <cmath>      // cos(), exp(), log(), sqrt()
+#include <cstddef>
+#include <string>
+
+/**
+ * \file
+ * Phold::Payloads class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Distribution of event payload sizes.
+ *
+ * Kind        | Payload size, in bytes
+ * ----------- | ------------------------------------------------------
+ * `fixed`     | Always `buffer` (default)
+ * `uniform`   | Uniform in `[buffermin, buffermax]`
+ * `lognormal` | Log-normal with mean `buffer` and log deviation
+ *             | `buffersigma`, truncated at `buffermax`
+ * `bimodal`   | `buffermax` with probability `bufferlarge`,
+ *             | otherwise `buffermin`, like small control and large data packets
+ *
+ * For the log-normal `buffermax` of 0 truncates at `16 * buffer`.
+ * The sizes are drawn from the LP's generator, except `fixed`,
+ * so other distributions change the event sequence.
+ */
+class Payloads
+{
+public:
+
+  /** Supported distributions. */
+  enum class Kind
+  {
+    FIXED,      /**< Constant size. */
+    UNIFORM,    /**< Uniform between min and max. */
+    LOGNORMAL,  /**< Truncated log-normal. */
+    BIMODAL     /**< Either min or max. */
+  };
+
+  /** Distribution parameters, as read from the component Params. */
+  struct Config
+  {
+    /** Which distribution. */
+    Kind kind {Kind::FIXED};
+    /** Fixed size, or the log-normal mean. */
+    std::size_t size {0};
+    /** Smallest size, for uniform and bimodal. */
+    std::size_t min {0};
+    /** Largest size. */
+    std::size_t max {0};
+    /** Standard deviation of the log of the size, for log-normal. */
+    double sigma {1.0};
+    /** Probability of the large size, for bimodal. */
+    double large {0.1};
+  };
+
+  /** Default c'tor, with no payload. */
+  Payloads() = default;
+
+  /**
+   * C'tor.
+   * @param config The configuration.
+   */
+  explicit Payloads(const Config & config);
+
+  /**
+   * Parse a distribution name.
+   * @param name The name, such as "lognormal".
+   * @param [out] kind The distribution, if found.
+   * @returns \c true if \c name is a known distribution.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Get the name of a distribution kind.
+   * @param kind The distribution kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Check the configuration for consistency.
+   * @param [out] why The error description, if invalid.
+   * @returns \c true if the configuration is valid.
+   */
+  bool isValid(std::string & why) const;
+
+  /** @returns The configuration. */
+  const Config & getConfig() const
+  {
+    return m_config;
+  }
+
+  /** @returns A short description, such as "uniform [64, 1024]". */
+  std::string toString() const;
+
+  /** @returns The largest possible size. */
+  std::size_t Max() const
+  {
+    return m_max;
+  }
+
+  /** @returns The expected size, ignoring truncation. */
+  double Mean() const;
+
+  /**
+   * Draw a payload size.
+   * @param rng The generator, providing `nextUniform()`.
+   * @returns The size, in bytes.
+   */
+  template <class Rng>
+  std::size_t Sample(Rng & rng) const
+  {
+    switch (m_config.kind)
+      {
+      case Kind::UNIFORM:
+        {
+          const auto span = m_config.max - m_config.min + 1;
+          const auto k = static_cast<std::size_t>(rng.nextUniform() * span);
+          return m_config.min + std::min(k, span - 1);
+        }
+      case Kind::LOGNORMAL:
+        {
+          // Box-Muller, using one of the pair
+          const double u1 = 1.0 - rng.nextUniform();
+          const double u2 = rng.nextUniform();
+          const double z = std::sqrt(-2 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+          const double x = std::exp(m_mu + m_config.sigma * z);
+          return x >= m_max ? m_max : static_cast<std::size_t>(x);
+        }
+      case Kind::BIMODAL:
+        return rng.nextUniform() < m_config.large ? m_config.max : m_config.min;
+      case Kind::FIXED:
+      default:
+        return m_config.size;
+      }
+  }
+
+private:
+
+  /** The configuration. */
+  Config m_config;
+  /** The largest size. */
+  std::size_t m_max {0};
+  /** Mean of the log of the size, for log-normal. */
+  double m_mu {0};
+
+};  // class Payloads
+
+}  // namespace Phold
@@ -0,0 +1,528 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <algorithm>  // pop_heap(), push_heap(), partial_sort(), upper_bound()
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>      // tie()
+#include <vector>
+
+/**
+ * \file
+ * Phold::PendingEvents pending event sets, for phold-engine.
+ *
+ * Every set has the same interface:
+ *
+ * Function  | Meaning
+ * --------- | ------------------------------------------------
+ * `Push(e)` | Add an event
+ * `Top()`   | The earliest event; the set must not be empty
+ * `Pop()`   | Remove and return the earliest event
+ * `Empty()` | \c true if there are no events
+ * `Size()`  | The number of events
+ * `Name()`  | The set name, static
+ *
+ * `Top()` isn't \c const: the calendar and ladder queues do their
+ * searching there, and cache the result for the `Pop()`.
+ *
+ * Events are totally ordered, so every set pops the same sequence,
+ * and runs are deterministic for any set and any number of threads.
+ *
+ * The calendar and ladder queues assume, as in any discrete event
+ * simulation, that pushed events are no earlier than the last one popped.
+ */
+
+namespace Phold {
+namespace PendingEvents {
+
+/** A pending event. */
+struct Event
+{
+  uint64_t time;  /**< Receive time. */
+  uint64_t dst;   /**< Receiving LP. */
+  uint64_t src;   /**< Sending LP. */
+  uint64_t seq;   /**< Sequence number at the sender, to break ties. */
+  uint64_t send;  /**< Send time. */
+};
+
+/**
+ * Event order: by time, then dst, src, and seq.
+ * @param a The first event.
+ * @param b The second event.
+ * @returns \c true if \c a is before \c b.
+ */
+inline bool
+operator < (const Event & a, const Event & b)
+{
+  return std::tie(a.time, a.dst, a.src, a.seq) < std::tie(b.time, b.dst, b.src, b.seq);
+}
+
+/** Reverse event order, for min heaps and for sorted buckets with the minimum at the back. */
+struct Later
+{
+  bool operator()(const Event & a, const Event & b) const
+  {
+    return b < a;
+  }
+};
+
+
+/** Binary heap, using the standard library heap algorithms. */
+class BinaryHeap
+{
+public:
+  /** @returns The set name. */
+  static const char * Name() { return "heap"; }
+
+  void Push(const Event & e)
+  {
+    m_heap.push_back(e);
+    std::push_heap(m_heap.begin(), m_heap.end(), Later());
+  }
+
+  const Event & Top()
+  {
+    return m_heap.front();
+  }
+
+  Event Pop()
+  {
+    std::pop_heap(m_heap.begin(), m_heap.end(), Later());
+    auto e = m_heap.back();
+    m_heap.pop_back();
+    return e;
+  }
+
+  bool Empty() const { return m_heap.empty(); }
+  std::size_t Size() const { return m_heap.size(); }
+
+private:
+  std::vector<Event> m_heap;  /**< The heap, earliest at the front. */
+
+};  // class BinaryHeap
+
+
+/**
+ * Pairing heap, with nodes in a pool indexed by \c uint32_t,
+ * and the two pass merge on Pop().
+ */
+class PairingHeap
+{
+public:
+  /** @returns The set name. */
+  static const char * Name() { return "pairing"; }
+
+  void Push(const Event & e)
+  {
+    uint32_t node;
+    if (m_free.empty())
+      {
+        node = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.push_back({e, NIL, NIL});
+      }
+    else
+      {
+        node = m_free.back();
+        m_free.pop_back();
+        m_nodes[node] = {e, NIL, NIL};
+      }
+    m_root = Meld(m_root, node);
+    ++m_size;
+  }
+
+  const Event & Top()
+  {
+    return m_nodes[m_root].event;
+  }
+
+  Event Pop()
+  {
+    auto root = m_root;
+    auto e = m_nodes[root].event;
+    m_free.push_back(root);
+    m_root = MergePairs(m_nodes[root].child);
+    --m_size;
+    return e;
+  }
+
+  bool Empty() const { return 0 == m_size; }
+  std::size_t Size() const { return m_size; }
+
+private:
+
+  /** Null node index. */
+  static constexpr uint32_t NIL {std::numeric_limits<uint32_t>::max()};
+
+  /** A heap node. */
+  struct Node
+  {
+    Event    event;    /**< The event. */
+    uint32_t child;    /**< First child. */
+    uint32_t sibling;  /**< Next sibling. */
+  };
+
+  /**
+   * Meld two heaps, each without siblings.
+   * @param a The first root.
+   * @param b The second root.
+   * @returns The new root.
+   */
+  uint32_t Meld(uint32_t a, uint32_t b)
+  {
+    if (NIL == a) return b;
+    if (NIL == b) return a;
+    if (m_nodes[b].event < m_nodes[a].event) std::swap(a, b);
+    m_nodes[b].sibling = m_nodes[a].child;
+    m_nodes[a].child = b;
+    return a;
+  }
+
+  /**
+   * Merge a list of siblings: meld pairs left to right,
+   * then meld the results right to left.
+   * @param first The first sibling.
+   * @returns The new root.
+   */
+  uint32_t MergePairs(uint32_t first)
+  {
+    m_pairs.clear();
+    while (NIL != first)
+      {
+        auto a = first;
+        auto b = m_nodes[a].sibling;
+        m_nodes[a].sibling = NIL;
+        if (NIL == b)
+          {
+            m_pairs.push_back(a);
+            break;
+          }
+        first = m_nodes[b].sibling;
+        m_nodes[b].sibling = NIL;
+        m_pairs.push_back(Meld(a, b));
+      }
+    uint32_t root = NIL;
+    for (auto p = m_pairs.rbegin(); p != m_pairs.rend(); ++p) root = Meld(*p, root);
+    return root;
+  }
+
+  std::vector<Node>     m_nodes;         /**< Node pool. */
+  std::vector<uint32_t> m_free;          /**< Free nodes in m_nodes. */
+  std::vector<uint32_t> m_pairs;         /**< Scratch for MergePairs(). */
+  uint32_t              m_root {NIL};    /**< The earliest event. */
+  std::size_t           m_size {0};      /**< Number of events. */
+
+};  // class PairingHeap
+
+
+/**
+ * Calendar queue, after Brown, CACM 31(10), 1988.
+ *
+ * Events go in buckets by `(time / width) % buckets`, each bucket sorted
+ * with its earliest event at the back.  Pop() scans forward from the
+ * last bucket popped, one "day" at a time, falling back to a direct
+ * search after a whole "year" with nothing due.  The number of buckets
+ * doubles or halves as the size passes twice or half of it, and the
+ * width is then set to three times the mean separation of the
+ * earliest events.
+ */
+class CalendarQueue
+{
+public:
+  /** @returns The set name. */
+  static const char * Name() { return "calendar"; }
+
+  CalendarQueue()
+    : m_buckets(MIN_BUCKETS)
+  {
+  }
+
+  void Push(const Event & e)
+  {
+    if (e.time < m_dayStart)
+      {
+        // Earlier than expected, restart the scan there
+        m_day = Bucket(e.time);
+        m_dayStart = e.time - e.time % m_width;
+      }
+    Insert(e);
+    ++m_size;
+    m_found = false;
+    if (m_size > 2 * m_buckets.size()) Resize(2 * m_buckets.size());
+  }
+
+  const Event & Top()
+  {
+    Find();
+    return m_buckets[m_day].back();
+  }
+
+  Event Pop()
+  {
+    Find();
+    auto & bucket = m_buckets[m_day];
+    auto e = bucket.back();
+    bucket.pop_back();
+    --m_size;
+    m_found = false;
+    if (m_buckets.size() > MIN_BUCKETS && m_size < m_buckets.size() / 2)
+      {
+        Resize(m_buckets.size() / 2);
+      }
+    return e;
+  }
+
+  bool Empty() const { return 0 == m_size; }
+  std::size_t Size() const { return m_size; }
+
+private:
+
+  /** Smallest number of buckets. */
+  static constexpr std::size_t MIN_BUCKETS {2};
+  /** Number of events sampled to set the bucket width. */
+  static constexpr std::size_t SAMPLE {25};
+
+  /** @returns The bucket for \c time. */
+  std::size_t Bucket(uint64_t time) const
+  {
+    return (time / m_width) % m_buckets.size();
+  }
+
+  /** Add an event to its bucket, keeping the bucket sorted. */
+  void Insert(const Event & e)
+  {
+    auto & bucket = m_buckets[Bucket(e.time)];
+    bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), e, Later()), e);
+  }
+
+  /** Point m_day at the bucket with the earliest event; the queue must not be empty. */
+  void Find()
+  {
+    if (m_found) return;
+    const auto n = m_buckets.size();
+    for (std::size_t i = 0; i < n; ++i)
+      {
+        const auto & bucket = m_buckets[m_day];
+        if ( ! bucket.empty() && bucket.back().time < m_dayStart + m_width)
+          {
+            m_found = true;
+            return;
+          }
+        m_day = (m_day + 1) % n;
+        m_dayStart += m_width;
+      }
+    // Nothing this year, search directly
+    const Event * earliest {nullptr};
+    for (const auto & bucket : m_buckets)
+      {
+        if ( ! bucket.empty() && ( ! earliest || bucket.back() < *earliest))
+          {
+            earliest = &bucket.back();
+          }
+      }
+    m_day = Bucket(earliest->time);
+    m_dayStart = earliest->time - earliest->time % m_width;
+    m_found = true;
+  }
+
+  /**
+   * Rebuild with a new number of buckets, and a new width.
+   * @param buckets The new number of buckets.
+   */
+  void Resize(std::size_t buckets)
+  {
+    m_scratch.clear();
+    for (auto & bucket : m_buckets)
+      {
+        m_scratch.insert(m_scratch.end(), bucket.begin(), bucket.end());
+      }
+    const auto sample = std::min(SAMPLE, m_scratch.size());
+    if (sample > 1)
+      {
+        std::partial_sort(m_scratch.begin(), m_scratch.begin() + sample, m_scratch.end());
+        const double mean = double(m_scratch[sample - 1].time - m_scratch[0].time) / (sample - 1);
+        // Mean again, ignoring the large separations
+        uint64_t total {0};
+        std::size_t count {0};
+        for (std::size_t i = 1; i < sample; ++i)
+          {
+            const auto gap = m_scratch[i].time - m_scratch[i - 1].time;
+            if (gap <= 2 * mean)
+              {
+                total += gap;
+                ++count;
+              }
+          }
+        const double width = count ? 3.0 * total / count : 3.0 * mean;
+        m_width = std::max<uint64_t>(1, static_cast<uint64_t>(width));
+      }
+    m_buckets.assign(buckets, {});
+    for (const auto & e : m_scratch) Insert(e);
+    const auto start = sample ? std::min_element(m_scratch.begin(), m_scratch.end())->time : 0;
+    m_day = Bucket(start);
+    m_dayStart = start - start % m_width;
+    m_found = false;
+  }
+
+  std::vector<std::vector<Event> > m_buckets;  /**< Buckets, earliest event at the back. */
+  std::vector<Event>  m_scratch;               /**< Scratch for Resize(). */
+  uint64_t            m_width {1};             /**< Bucket width, time units. */
+  std::size_t         m_day {0};               /**< Bucket being scanned. */
+  uint64_t            m_dayStart {0};          /**< Start time of m_day in this year. */
+  std::size_t         m_size {0};              /**< Number of events. */
+  bool                m_found {false};         /**< m_day has the earliest event. */
+
+};  // class CalendarQueue
+
+
+/**
+ * Ladder queue, after Tang, Goh and Thng, ACM TOMACS 15(3), 2005.
+ *
+ * Far future events go unsorted into Top.  When everything nearer
+ * is used up Top becomes the first rung, with a bucket per event.
+ * Buckets are taken in order; one with more than THRESHOLD events
+ * becomes a finer rung below, otherwise it is sorted into Bottom,
+ * which is popped from the back.  So events are sorted only when
+ * they're about to be popped, in small batches.
+ */
+class LadderQueue
+{
+public:
+  /** @returns The set name. */
+  static const char * Name() { return "ladder"; }
+
+  void Push(const Event & e)
+  {
+    ++m_size;
+    if (e.time >= m_topStart)
+      {
+        m_top.push_back(e);
+        m_topMin = std::min(m_topMin, e.time);
+        m_topMax = std::max(m_topMax, e.time);
+        return;
+      }
+    for (auto & rung : m_rungs)
+      {
+        if (e.time >= rung.Current())
+          {
+            rung.buckets[(e.time - rung.start) / rung.width].push_back(e);
+            ++rung.size;
+            return;
+          }
+      }
+    m_bottom.insert(std::upper_bound(m_bottom.begin(), m_bottom.end(), e, Later()), e);
+  }
+
+  const Event & Top()
+  {
+    Refill();
+    return m_bottom.back();
+  }
+
+  Event Pop()
+  {
+    Refill();
+    auto e = m_bottom.back();
+    m_bottom.pop_back();
+    --m_size;
+    return e;
+  }
+
+  bool Empty() const { return 0 == m_size; }
+  std::size_t Size() const { return m_size; }
+
+private:
+
+  /** Bucket size above which a bucket becomes a new rung. */
+  static constexpr std::size_t THRESHOLD {50};
+  /** Most rungs. */
+  static constexpr std::size_t MAX_RUNGS {8};
+
+  /** A rung, covering `[Current(), start + buckets.size() * width)`. */
+  struct Rung
+  {
+    uint64_t start;                           /**< Start time of bucket 0. */
+    uint64_t width;                           /**< Bucket width, time units. */
+    std::size_t current;                      /**< First bucket not yet taken. */
+    std::size_t size;                         /**< Events in the rung. */
+    std::vector<std::vector<Event> > buckets; /**< The buckets, unsorted. */
+
+    /** @returns The start time of the current bucket. */
+    uint64_t Current() const { return start + current * width; }
+  };
+
+  /**
+   * Spread events over a new rung.
+   * @param events The events.
+   * @param start The earliest time.
+   * @param span The time covered, at least the latest time minus the earliest.
+   */
+  void AddRung(std::vector<Event> & events, uint64_t start, uint64_t span)
+  {
+    const auto n = std::max<std::size_t>(1, events.size());
+    Rung rung {start, span / n + 1, 0, events.size(), {}};
+    rung.buckets.resize(n);
+    for (const auto & e : events)
+      {
+        rung.buckets[(e.time - start) / rung.width].push_back(e);
+      }
+    events.clear();
+    m_rungs.push_back(std::move(rung));
+  }
+
+  /** Make sure Bottom has the earliest event; the queue must not be empty. */
+  void Refill()
+  {
+    while (m_bottom.empty())
+      {
+        while ( ! m_rungs.empty() && 0 == m_rungs.back().size) m_rungs.pop_back();
+        if (m_rungs.empty())
+          {
+            // Top becomes the first rung
+            AddRung(m_top, m_topMin, m_topMax - m_topMin);
+            const auto & rung = m_rungs.back();
+            m_topStart = rung.start + rung.buckets.size() * rung.width;
+            m_topMin = std::numeric_limits<uint64_t>::max();
+            m_topMax = 0;
+          }
+        auto & rung = m_rungs.back();
+        while (rung.buckets[rung.current].empty()) ++rung.current;
+        auto & bucket = rung.buckets[rung.current];
+        const auto start = rung.Current();
+        const auto width = rung.width;
+        rung.size -= bucket.size();
+        ++rung.current;
+        if (bucket.size() > THRESHOLD && m_rungs.size() < MAX_RUNGS && width > 1)
+          {
+            // Invalidates rung and bucket
+            std::vector<Event> events;
+            events.swap(bucket);
+            AddRung(events, start, width - 1);
+          }
+        else
+          {
+            m_bottom.swap(bucket);
+            std::sort(m_bottom.begin(), m_bottom.end(), Later());
+          }
+      }
+  }
+
+  std::vector<Event> m_top;                  /**< Far future events, unsorted. */
+  uint64_t    m_topStart {0};                /**< Events at or after this go in m_top. */
+  uint64_t    m_topMin {std::numeric_limits<uint64_t>::max()};  /**< Earliest in m_top. */
+  uint64_t    m_topMax {0};                  /**< Latest in m_top. */
+  std::vector<Rung>  m_rungs;                /**< Rungs, coarsest first. */
+  std::vector<Event> m_bottom;               /**< Next events, earliest at the back. */
+  std::size_t m_size {0};                    /**< Number of events. */
+
+};  // class LadderQueue
+
+}  // namespace PendingEvents
+}  // namespace Phold
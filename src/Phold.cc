@@ -8,17 +8,30 @@
 
 
 #include "Phold.h"
-#include "binary-tree.h"
+#include "Checksum.h"
+#include "kary-tree.h"
 
 #include <sst/core/timeConverter.h>
 #include <sst/core/sst_types.h>
 
+#include <algorithm>  // binary_search(), lower_bound()
+#include <atomic>
+#include <chrono>
 #include <cinttypes>  // PRIxxx
+#include <cmath>      // fabs(), sqrt()
+#include <cstdarg>    // va_list
 #include <cstdint>    // UINT32_MAX
+#include <iomanip>    // setw()
 #include <iostream>
+#include <limits>
+#include <mutex>      // call_once()
 #include <string>     // to_string()
 #include <utility>    // swap()
 
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>  // __rdtsc()
+#endif
+
 /**
  * \file
  * Phold::Phold class implementation.
@@ -49,6 +62,13 @@
 
 #  define VERBOSE(l, f, ...)                                  \
    do {                                                         \
+    if (m_log.isBuffered())                                     \
+      {                                                         \
+        if (l <= m_verbose)                                     \
+          LogWrite(CALL_INFO, VERBOSE_PREFIX,                   \
+                   "[%u] " f, l, ## __VA_ARGS__);               \
+        break;                                                  \
+      }                                                         \
     m_output.verbosePrefix(VERBOSE_PREFIX.c_str(),              \
                            CALL_INFO, l, 0,                     \
                            "[%u] " f, l, ## __VA_ARGS__);       \
@@ -57,10 +77,17 @@
 
 #endif
 
-#define OUTPUT(...)                             \
-  do {                                          \
-    m_output.output(CALL_INFO, __VA_ARGS__);    \
-    m_output.flush();                           \
+// With buffered logging OUTPUT() and VERBOSE() go to m_log.
+// OUTPUT0() is the LP 0 report, so it always goes to SST::Output.
+#define OUTPUT(...)                                     \
+  do {                                                  \
+    if (m_log.isBuffered())                             \
+      {                                                 \
+        LogWrite(CALL_INFO, m_outputPrefix, __VA_ARGS__); \
+        break;                                          \
+      }                                                 \
+    m_output.output(CALL_INFO, __VA_ARGS__);            \
+    m_output.flush();                                   \
   } while (0)
 
 #define OUTPUT0(...)                            \
@@ -76,17 +103,15 @@ constexpr char Phold::PORT_NAME[];  // constexpr initialized in Phold.h
 //  Conversion factor from phold.py script to Phold::TIMEBASE
 /* const */ double Phold::PHOLD_PY_TIMEFACTOR{1e3};
 
-double               Phold::m_remote;
-SST::SimTime_t       Phold::m_minimum;
-SST::UnitAlgebra     Phold::m_average;
-uint64_t             Phold::m_number;
-uint64_t             Phold::m_events;
-std::size_t          Phold::m_bufferSize;
-bool                 Phold::m_statsOut;
-bool                 Phold::m_delaysOut;
+Phold::Config        Phold::m_config;
+Phold::RankShare     Phold::m_rankShare;
+Log                  Phold::m_log;
+std::atomic<uint64_t> Phold::m_ctorNanos {0};
+std::atomic<uint64_t> Phold::m_ctorCount {0};
+std::atomic<int64_t>  Phold::m_ctorFirst {0};
 uint32_t             Phold::m_verbose;
-SST::SimTime_t       Phold::m_stop;
 SST::TimeConverter * Phold::m_timeConverter;
+const Destinations * Phold::m_destinations {nullptr};
 bool                 Phold::m_initLive {false};
 
 std::string
@@ -97,142 +122,463 @@ Phold::toBestSI(SST::SimTime_t sim) const
 }
 
 
-Phold::Phold( SST::ComponentId_t id, SST::Params& params )
+void
+Phold::LogWrite(uint32_t line, const char * file, const char * function,
+                const std::string & prefix, const char * format, ...) const
+{
+  const auto rank = getRank();
+  const auto ranks = getNumRanks();
+  const Log::Where where {getCurrentSimCycle(), rank.rank, ranks.rank,
+                          rank.thread, ranks.thread, line, file, function};
+  va_list args;
+  va_start(args, format);
+  m_log.Write(where, prefix, format, args);
+  va_end(args);
+
+}  // LogWrite()
+
+
+namespace {
+
+/** @returns The current steady_clock time, in ns. */
+int64_t
+SteadyNanos()
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/** @returns The cycle counter, or steady_clock ns if there isn't one. */
+inline uint64_t
+Cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return static_cast<uint64_t>(SteadyNanos());
+#endif
+}
+
+/** @returns The log2 bin for a cycle count. */
+inline std::size_t
+CycleBin(uint64_t cycles)
+{
+  std::size_t bin = 0;
+  while (cycles >>= 1) ++bin;
+  return bin;
+}
+
+}  // anonymous namespace
+
+
+Phold::Phold( SST::ComponentId_t id, SST::Params& params, const Variant & variant )
   : SST::Component(id)
 {
+  const auto ctorStart = SteadyNanos();
+  int64_t none {0};
+  m_ctorFirst.compare_exchange_strong(none, ctorStart);
+  Memory::Record(Memory::START);
+
   m_verbose = params.find<long>("pverbose", 0);
 #ifndef PHOLD_DEBUG
   // Prefix with virtual time
-  m_output.init("@t:Phold: ",
-                m_verbose, 0, SST::Output::STDOUT);
+  m_outputPrefix = "@t:Phold: ";
 #else
   // Prefix with "<time>:[<rank>:<thread>]Phold-<id> [<function>] -> "
-  m_output.init("@t:@X:Phold-" + getName() + " [@p()] -> ",
-                m_verbose, 0, SST::Output::STDOUT);
+  m_outputPrefix = "@t:@X:Phold-" + getName() + " [@p()] -> ";
+#endif
+  m_output.init(m_outputPrefix, m_verbose, 0, SST::Output::STDOUT);
+
+  Log::Config logConfig;
+  auto logName = params.find<std::string>("log", "direct");
+  if ( ! Log::Parse(logName, logConfig.kind))
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown log '%s'\n", logName.c_str());
+    }
+  logConfig.file  = params.find<std::string>("logfile", "phold");
+  logConfig.bytes = params.find<std::size_t>("logbuffer", 1 << 20);
+  std::string why;
+  if ( ! Log::isValid(logConfig, why))
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid log: %s\n", why.c_str());
+    }
+  m_log.Configure(logConfig, getRank().rank, getNumRanks().thread);
+
+#ifdef PHOLD_DEBUG
   // Prefix with "<time>:[<rank>:<thread>]Phold-<id> [<function> (<file>:<lineL)] -> "
   VERBOSE_PREFIX = "@t:@X:Phold-" + getName() + " [@p() (@f:@l)] -> ";
   VERBOSE(1, "Full c'tor() @%p, id: %" PRIu64 ", name: %s\n",
           (void*)this, getId(), getName().c_str());
 #endif
 
-  m_remote     = params.find<double>     ("remote", 0.9);
-  m_minimum    = params.find<double>     ("minimum", 1.0) *PHOLD_PY_TIMEFACTOR;
-  m_average    = TIMEBASE;
-  m_average   *= params.find<double>     ("average", 9.0) *PHOLD_PY_TIMEFACTOR;
-  m_stop       = params.find<double>     ("stop", 10)     *PHOLD_PY_TIMEFACTOR;
-  m_number     = params.find<uint64_t>   ("number", 2);
-  m_events     = params.find<uint64_t>   ("events", 1);
-  m_bufferSize = params.find<std::size_t>("buffer", 0);
-  m_statsOut   = params.find<bool>       ("stats", false);
-  m_delaysOut  = params.find<bool>       ("delays", false);
+  // Parse into a local Config, published to m_config below
+  Config config;
+  config.remote     = params.find<double>     ("remote", 0.9);
+  config.minimum    = params.find<double>     ("minimum", 1.0) *PHOLD_PY_TIMEFACTOR;
+  config.average    = TIMEBASE;
+  config.average   *= params.find<double>     ("average", 9.0) *PHOLD_PY_TIMEFACTOR;
+  config.stop       = params.find<double>     ("stop", 10)     *PHOLD_PY_TIMEFACTOR;
+  config.number     = params.find<uint64_t>   ("number", 2);
+  config.events     = params.find<uint64_t>   ("events", 1);
+  config.bufferSize = params.find<std::size_t>("buffer", 0);
+  config.statsOut   = params.find<bool>       ("stats", false);
+  config.delaysOut  = params.find<bool>       ("delays", false);
+  config.pool       = params.find<bool>       ("pool", true);
+  config.shared     = params.find<bool>       ("shared", false);
+  config.selfQueue  = params.find<bool>       ("selfqueue", false);
+  config.counters   = params.find<bool>       ("counters", false);
+  config.fanout     = params.find<std::size_t>("fanout", 2);
+  config.audit      = params.find<bool>       ("audit", false);
+  config.rankReduce = params.find<bool>       ("rankreduce", false);
+  config.timingSample = params.find<uint64_t> ("timingsample", 0);
+  m_sampleCountdown = config.timingSample;
+  config.heartbeat  = params.find<double>     ("heartbeat", 0)  *PHOLD_PY_TIMEFACTOR;
+  config.warmup     = params.find<double>     ("warmup", 0)     *PHOLD_PY_TIMEFACTOR;
+  if (config.warmup >= config.stop)
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid warmup %s, must be before stop %s\n",
+                     toBestSI(config.warmup).c_str(), toBestSI(config.stop).c_str());
+    }
+  config.halfway    = config.warmup + (config.stop - config.warmup) / 2;
+  m_warm       = (0 == config.warmup);
+  config.traceBase  = params.find<std::string>("trace", "");
+  config.clocks     = params.find<uint32_t>   ("clocks", 0);
+  config.clockPeriod = params.find<double>    ("clockperiod", 1) *PHOLD_PY_TIMEFACTOR;
+  config.clockSpread = params.find<bool>      ("clockspread", false);
+  auto clockScope = params.find<std::string>("clockscope", "lp");
+  if (clockScope != "lp" && clockScope != "rank")
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown clockscope '%s'\n", clockScope.c_str());
+    }
+  config.clockRank  = clockScope == "rank";
+  if (config.clocks && 0 == config.clockPeriod)
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid clockperiod, must be > 0\n");
+    }
+  if (config.fanout < 2)
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid fanout %zu, must be >= 2\n", config.fanout);
+    }
+  config.delayBins  = params.find<std::size_t>("delaybins", 0);
+  config.delayBinWidth = params.find<double>  ("delaybinwidth", 1);
+  if (config.counters && config.delayBins && config.delayBinWidth <= 0)
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid delaybinwidth %f, must be > 0\n",
+                     config.delayBinWidth);
+    }
+  config.rngSeed    = params.find<uint32_t>   ("rngseed", 1);
 
-  m_initLive = false;
+  Topology::Config topoConfig;
+  auto topoName = params.find<std::string>("topology", "full");
+  if ( ! Topology::Parse(topoName, topoConfig.kind))
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown topology '%s'\n", topoName.c_str());
+    }
+  topoConfig.number    = config.number;
+  topoConfig.dims      = params.find<std::string>("dims", "");
+  topoConfig.neighbors = params.find<uint64_t>   ("neighbors", 4);
+  topoConfig.seed      = params.find<uint64_t>   ("seed", 1);
+  topoConfig.group     = params.find<uint64_t>   ("group", 0);
+  topoConfig.remotes   = params.find<uint64_t>   ("remotes", 1);
+  const Topology topology(topoConfig);
+  if ( ! topology.isValid(why))
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid topology: %s\n", why.c_str());
+    }
+  config.topology = topoConfig.kind;
 
-#ifdef PHOLD_DEBUG
-  // Register a clock for demonstration
-  auto clock = new SST::Clock::Handler<Phold>(this, &Phold::clockTick);
-  ASSERT(clock, "Failed to create clock handler\n");
-  auto clockRate = m_average;
-  clockRate += TIMEBASE * (m_minimum + getId());
-  VERBOSE(2, "  clock period %s\n", clockRate.toStringBestSI().c_str());
-  clockRate.invert();
-  m_clockTimeConverter = registerClock(clockRate, clock);
-  ASSERT(m_clockTimeConverter, "Failed to register clock\n");
-  auto cycles = clockRate;
-  cycles *= (TIMEBASE * m_stop);
-
-  m_clockPrintInterval = std::max(1.0, cycles.getDoubleValue() / 10);
-  VERBOSE(2, "Configured clock on Phold %" PRIu64 " with rate %s\n",
-          getId(), clockRate.toStringBestSI().c_str());
-  VERBOSE(2,"  expect %s cycles, print interval %" PRIu64 "\n",
-          cycles.toStringBestSI().c_str(), m_clockPrintInterval);
-<<<<<<< HEAD
-
-  // Register with the free clock
-  auto freeTimePeriod = m_clockTimeConverter->getPeriod();
-  freeTimePeriod *= 2;
-  freeTimePeriod.invert();
-  FreeClock::Register(freeTimePeriod, this, &Phold::freeClockTick);
+  Destinations::Config destConfig;
+  auto destName = params.find<std::string>("distribution", "uniform");
+  if ( ! Destinations::Parse(destName, destConfig.kind))
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown distribution '%s'\n", destName.c_str());
+    }
+  destConfig.number    = config.number;
+  destConfig.locality  = params.find<double>  ("locality", 0.9);
+  destConfig.localSize = params.find<uint64_t>("localsize", 0);
+  destConfig.exponent  = params.find<double>  ("zipf", 1.0);
+  if (0 == destConfig.localSize)
+    {
+      // LPs per thread, as assigned by the linear partitioner
+      auto ranks = getNumRanks();
+      auto threads = std::max<uint64_t>(1, uint64_t(ranks.rank) * ranks.thread);
+      destConfig.localSize = std::max<uint64_t>(1, (config.number + threads - 1) / threads);
+    }
+  if (destConfig.kind != Destinations::Kind::UNIFORM && ! topology.isFull())
+    {
+      m_output.fatal(CALL_INFO, 1, "The %s distribution requires the full topology\n",
+                     destName.c_str());
+    }
+  // All LPs share one instance; the zipf alias table is O(number)
+  static std::once_flag destOnce;
+  std::call_once(destOnce, [&destConfig]() { m_destinations = new Destinations(destConfig); });
+  if ( ! m_destinations->isValid(why))
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid distribution: %s\n", why.c_str());
+    }
 
-#endif
+  Payloads::Config payConfig;
+  auto payName = params.find<std::string>("bufferdist", "fixed");
+  if ( ! Payloads::Parse(payName, payConfig.kind))
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown bufferdist '%s'\n", payName.c_str());
+    }
+  payConfig.size  = config.bufferSize;
+  payConfig.min   = params.find<std::size_t>("buffermin", 0);
+  payConfig.max   = params.find<std::size_t>("buffermax", 0);
+  payConfig.sigma = params.find<double>     ("buffersigma", 1.0);
+  payConfig.large = params.find<double>     ("bufferlarge", 0.1);
+  config.payloads = Payloads(payConfig);
+  if ( ! config.payloads.isValid(why))
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid payloads: %s\n", why.c_str());
+    }
+  config.sharedBuffer = params.find<bool>("sharedbuffer", false);
 
-=======
-#endif
+  Work::Config workConfig;
+  auto workName = params.find<std::string>("work", "none");
+  if ( ! Work::Parse(workName, workConfig.kind))
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown work '%s'\n", workName.c_str());
+    }
+  workConfig.mean       = params.find<double>     ("workmean", 1000);
+  auto workDist         = params.find<std::string>("workdist", "fixed");
+  if (workDist != "fixed" && workDist != "exponential")
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown workdist '%s'\n", workDist.c_str());
+    }
+  workConfig.exponential = (workDist == "exponential");
+  workConfig.workingSet = params.find<std::size_t>("workset", 1 << 20);
+  workConfig.payload    = config.payloads.Max();
+  config.work = Work(workConfig);
+  if ( ! config.work.isValid(why))
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid work: %s\n", why.c_str());
+    }
+  m_workSet = config.work.MakeWorkingSet();
+
+  if (config.sharedBuffer && config.payloads.Max() > PholdEvent::INLINE_BYTES)
+    {
+      // Filled once, for the hash work; never written again
+      m_sharedPayload = SharedPayload::Make(config.payloads.Max());
+      Work::Fill(m_sharedPayload->data(), m_sharedPayload->size(), getId());
+    }
+
+  m_initLive = false;
 
->>>>>>> pdbj/master
   // Default time unit for Component and links
   m_timeConverter = registerTimeBase(TIMEBASE.toString(), true);
   TIMEFACTOR = m_timeConverter->getPeriod().getDoubleValue();
+  // The RNG itself is constructed by PholdT, with this mean
+  config.delayMean = config.average.getDoubleValue() / TIMEFACTOR;
+
+  // Every LP checks its own params, but only the first writes m_config:
+  // it's read only once any LP is constructed, so LPs on other threads
+  // never see it change, and the line is never invalidated in their caches
+  static std::once_flag configOnce;
+  std::call_once(configOnce, [this, &config]()
+    {
+      m_config = config;
+      if ( ! EventPool::Enable(m_config.pool))
+        {
+          m_output.fatal(CALL_INFO, 1, "Event pool was already %s before configuration\n",
+                         EventPool::IsEnabled() ? "enabled" : "disabled");
+        }
+    });
+  // Pooling is set once per process, so every LP has to agree
+  if (config.pool != m_config.pool)
+    {
+      m_output.fatal(CALL_INFO, 1, "pool must be the same for every LP\n");
+    }
+
+  OpenTrace();
+
+  ConfigureClocks();
+
+  if (m_config.heartbeat > 0)
+    {
+      const auto threads = getNumRanks().thread;
+      std::call_once(m_rankShare.beatOnce, [threads]()
+        {
+          m_rankShare.beatCounts.reset(new RankShare::BeatCount[threads]);
+          m_rankShare.beatThreads = threads;
+        });
+      m_beatCount = &m_rankShare.beatCounts[getRank().thread].recvs;
+      // Sparse clock, on the first LP constructed on each rank
+      if ( ! m_rankShare.beatTaken.exchange(true))
+        {
+          auto beat = new SST::Clock::Handler<Phold>(this, &Phold::heartbeatTick);
+          ASSERT(beat, "Failed to create heartbeat handler\n");
+          auto beatRate = TIMEBASE * m_config.heartbeat;
+          beatRate.invert();
+          registerClock(beatRate, beat);
+          VERBOSE(2, "Configured heartbeat every %s\n", toBestSI(m_config.heartbeat).c_str());
+        }
+    }
 
   if (0 == getId())
     {
-      // Not used here, so just read it and pass to ShowConfig
-      auto thread_latency = params.find<double> ("thread", 1.0) * PHOLD_PY_TIMEFACTOR;
-      ShowConfiguration(thread_latency);
+      // Not used here, since Phold reads the latency of each link,
+      // so just read it and pass to ShowConfig
+      Latencies::Config latConfig;
+      auto latName = params.find<std::string>("linklatency", "global");
+      if ( ! Latencies::Parse(latName, latConfig.kind))
+        {
+          m_output.fatal(CALL_INFO, 1, "Unknown linklatency '%s'\n", latName.c_str());
+        }
+      latConfig.minimum = params.find<double>("minimum", 1.0);
+      latConfig.thread  = params.find<double>("thread", 1.0);
+      auto tiers = params.find<std::string>("tiers", "1,1,1,1");
+      if ( ! Latencies::ParseTiers(tiers, latConfig.tiers))
+        {
+          m_output.fatal(CALL_INFO, 1, "Invalid tiers '%s'\n", tiers.c_str());
+        }
+      latConfig.max          = params.find<double>  ("latencymax", 10);
+      latConfig.ranksPerNode = params.find<uint32_t>("rankspernode", 1);
+      latConfig.seed         = params.find<uint64_t>("seed", 1);
+      const Latencies latencies(latConfig);
+      if ( ! latencies.isValid(why))
+        {
+          m_output.fatal(CALL_INFO, 1, "Invalid link latencies: %s\n", why.c_str());
+        }
+      ShowConfiguration(latencies, topology, variant);
       ShowSizes();
     }
 
-  VERBOSE(3, "%s", "Initializing RNGs\n");
-  m_rng  = new Phold::RNG_t;
-  // seed() doesn't check validity of arg, can't be 0
-  m_rng->seed(1 + getId());
-  VERBOSE(4, "  m_rng      @%p\n", (void*)m_rng);
-  m_remRng  = m_rng;
-  VERBOSE(4, "  m_remRng   @%p\n", (void*)m_remRng);
-  m_nodeRng = new SST::RNG::SSTUniformDistribution(m_number, m_rng);
-  VERBOSE(4, "  m_nodeRng  @%p\n", (void*)m_nodeRng);
-  auto avgRngRate = m_average;
-  avgRngRate /= TIMEFACTOR;
-  avgRngRate.invert();
-  m_delayRng = new SST::RNG::SSTExponentialDistribution(avgRngRate.getDoubleValue(), m_rng);
-  VERBOSE(4, "  m_delayRng @%p, rate: %s (%f)\n",
-          (void*)m_delayRng, avgRngRate.toString().c_str(), m_delayRng->getLambda());
+  VERBOSE(3, "Sampling policies: rng %s, destination %s, delay %s, mean %f\n",
+          variant.rng, variant.destination, variant.delay, m_config.delayMean);
 
   // Configure ports/links
-  VERBOSE(3, "%s", "Configuring links:\n");
-  m_links.resize(m_number);
+  VERBOSE(3, "Configuring links, topology %s:\n", topology.toString().c_str());
+  auto targets = topology.neighbors(getId());
+
+  // Tree links needed by init() and complete(), if not already neighbors
+  const KaryTree kt(m_config.fanout);
+  std::vector<SST::ComponentId_t> tree;
+  if (0 != getId()) tree.push_back(kt.parent(getId()));
+  auto children = kt.children(getId());
+  for (auto c = children.first; c < children.second && c < m_config.number; ++c)
+    {
+      tree.push_back(c);
+    }
+  if (m_config.rankReduce)
+    {
+      // The reduction needs the linear partition, with no empty ranks
+      const auto nRanks = getNumRanks();
+      const auto placed = LinearPlacement(getId());
+      if (m_config.number < uint64_t(nRanks.rank) * nRanks.thread
+          || placed.rank != getRank().rank || placed.thread != getRank().thread)
+        {
+          m_output.fatal(CALL_INFO, 1,
+                         "rankreduce requires the linear partitioner, with at least "
+                         "one LP per thread: LP %" PRIu64 " expected on %" PRIu32 ":%" PRIu32
+                         ", but is on %" PRIu32 ":%" PRIu32 "\n",
+                         getId(), placed.rank, placed.thread,
+                         getRank().rank, getRank().thread);
+        }
+      // Rank leaders also need links to the leaders of the parent and child ranks
+      const auto rank = getRank().rank;
+      if (getId() == RankLeader(rank))
+        {
+          if (0 != rank) tree.push_back(RankLeader(static_cast<uint32_t>(kt.parent(rank))));
+          auto ranks = kt.children(rank);
+          for (auto r = ranks.first; r < ranks.second && r < nRanks.rank; ++r)
+            {
+              tree.push_back(RankLeader(static_cast<uint32_t>(r)));
+            }
+        }
+    }
+  std::sort(tree.begin(), tree.end());
+  tree.erase(std::unique(tree.begin(), tree.end()), tree.end());
+  tree.erase(std::remove_if(tree.begin(), tree.end(),
+                            [&targets](SST::ComponentId_t i)
+                            {
+                              return std::binary_search(targets.begin(), targets.end(), i);
+                            }),
+             tree.end());
+
+  m_nTargets = targets.size();
+  m_links.reserve(targets.size() + tree.size());
 
   // Set up the port labels
   auto pre = std::string(PORT_NAME);
   const auto prefix(pre.erase(pre.find('%')));
-  std::string port;
-  for (uint32_t i = 0; i < m_number; ++i) {
-    ASSERT(m_links[i] == nullptr,
-           "Initialized link %u (%p) is not null!\n", i, (void*)m_links[i]);
-    // Each link needs it's own handler.  SST manages the destruction in ~Link
-    auto handler = new SST::Event::Handler<Phold, uint32_t>(this, &Phold::handleEvent, i);
-    ASSERT(handler, "Failed to create event handler %u\n", i);
-    if (i != getId())
-    {
-      port = prefix + std::to_string(i);
+  // Either one handler for all links, or one per link
+  if (m_config.shared)
+    {
+      // Reads the sender from the event.  We own this one, not the links
+      m_sharedHandler = new SST::Event::Handler<Phold>(this, variant.shared);
+      ASSERT(m_sharedHandler, "Failed to create shared event handler\n");
+    }
+  auto makeHandler = [this, &variant](SST::ComponentId_t i) -> SST::Event::HandlerBase *
+    {
+      if (m_sharedHandler) return m_sharedHandler;
+      // Each link needs it's own handler.  SST manages the destruction in ~Link
+      return new SST::Event::Handler<Phold, uint32_t>(this, variant.handler, i);
+    };
+
+  auto linkup = [this, &prefix, &makeHandler](SST::ComponentId_t i)
+    {
+      auto handler = makeHandler(i);
+      ASSERT(handler, "Failed to create event handler %" PRIu64 "\n", i);
+      auto port = prefix + std::to_string(i);
       ASSERT(isPortConnected(port),
              "Port %s is not connected\n", port.c_str());
-      m_links[i] = configureLink(port, handler);
-      ASSERT(m_links[i], "Failed to create link\n");
-      VERBOSE(4, "    link %u: %s @%p with handler @%p\n",
-              i, port.c_str(), (void*)m_links[i], (void*)handler);
-
-    } else {
+      auto link = configureLink(port, handler);
+      ASSERT(link, "Failed to configure link %" PRIu64 "\n", i);
+      // The latency configured in the Python, in TIMEBASE units
+      auto latency = m_timeConverter->convertFromCoreTime(link->getLatency());
+      VERBOSE(4, "    link %" PRIu64 ": %s @%p with handler @%p, latency %" PRIu64 "\n",
+              i, port.c_str(), (void*)link, (void*)handler, latency);
+      m_links.push_back({i, link, latency});
+    };
+  for (auto i : targets) linkup(i);
+  for (auto i : tree)    linkup(i);
 
-      m_links[i] = configureSelfLink("self", handler);
-      VERBOSE(4, "    link %u: self   @%p with handler @%p\n",
-              i, (void*)m_links[i], (void*)handler);
+  m_latencyMin = std::numeric_limits<SST::SimTime_t>::max();
+  m_latencySum = 0;
+  for (std::size_t n = 0; n < m_nTargets; ++n)
+    {
+      m_latencyMin = std::min(m_latencyMin, m_links[n].latency);
+      m_latencySum += m_links[n].latency;
     }
-    ASSERT(m_links[i], "Failed to configure link %u\n", i);
-  }
+
+  // First neighbor above us, wrapping around
+  auto above = std::upper_bound(targets.begin(), targets.end(), getId());
+  m_nextTarget = m_nTargets ? (above - targets.begin()) % m_nTargets : 0;
+
+  // With the self queue m_self only carries wake ups
+  auto handler = m_config.selfQueue
+    ? new SST::Event::Handler<Phold>(this, variant.wake)
+    : makeHandler(getId());
+  ASSERT(handler, "Failed to create self event handler\n");
+  m_self = configureSelfLink("self", handler);
+  ASSERT(m_self, "Failed to configure self link\n");
+  VERBOSE(4, "    link %" PRIu64 ": self   @%p with handler @%p\n",
+          getId(), (void*)m_self, (void*)handler);
 
   // Register statistics
   VERBOSE(3, "%s", "Initializing statistics\n");
-  // Stop stat collection at stop time
+  // Stop stat collection at stop time.
+  // Plain counters only count events before stop anyway,
+  // and have to be flushed later, in complete()
   SST::Params statParams;
-  std::string stopat {toBestSI(m_stop)};
-  VERBOSE(3, "  Setting stopat to %s\n", stopat.c_str());
-  statParams.insert("stopat", stopat);
+  if ( ! m_config.counters)
+    {
+      std::string stopat {toBestSI(m_config.stop)};
+      VERBOSE(3, "  Setting stopat to %s\n", stopat.c_str());
+      statParams.insert("stopat", stopat);
+    }
+  if (m_config.counters && m_config.delaysOut) m_plain.delays.resize(m_config.delayBins, 0);
 
   m_sendCount = dynamic_cast<decltype(m_sendCount)>(registerStatistic<uint64_t>(statParams, "SendCount"));
   ASSERT(m_sendCount,
          "Failed to register SendCount statistic");
-  m_sendCount->setFlagOutputAtEndOfSim(m_statsOut);
+  m_sendCount->setFlagOutputAtEndOfSim(m_config.statsOut);
   ASSERT(m_sendCount->isEnabled(),
          "SendCount statistic is not enabled!\n");
   ASSERT( ! m_sendCount->isNullStatistic(),
@@ -242,7 +588,7 @@ Phold::Phold( SST::ComponentId_t id, SST::Params& params )
   m_recvCount = dynamic_cast<decltype(m_recvCount)>(registerStatistic<uint64_t>(statParams, "RecvCount"));
   ASSERT(m_recvCount,
          "Failed to register RecvCount statistic");
-  m_recvCount->setFlagOutputAtEndOfSim(m_statsOut);
+  m_recvCount->setFlagOutputAtEndOfSim(m_config.statsOut);
   ASSERT(m_recvCount->isEnabled(),
          "RecvCount statistic is not enabled!\n");
   ASSERT( ! m_recvCount->isNullStatistic(),
@@ -254,9 +600,9 @@ Phold::Phold( SST::ComponentId_t id, SST::Params& params )
   m_delays = registerStatistic<float>(statParams, "Delays");
   ASSERT(m_delays,
          "Failed to register Delays statistic\n");
-  if (m_statsOut && m_delaysOut)
+  if (m_config.statsOut && m_config.delaysOut)
     {
-      m_delays->setFlagOutputAtEndOfSim(m_delaysOut);
+      m_delays->setFlagOutputAtEndOfSim(m_config.delaysOut);
       ASSERT(m_delays->isEnabled(),
              "Delays statistic is not enabled!\n");
       ASSERT( ! m_delays->isNullStatistic(),
@@ -266,6 +612,19 @@ Phold::Phold( SST::ComponentId_t id, SST::Params& params )
     }
   VERBOSE(4, "  m_delays   @%p\n", (void*)m_delays);
 
+  // Self queue counts are only enabled with the self queue
+  m_selfQueueCount = registerStatistic<uint64_t>(statParams, "SelfQueueCount");
+  ASSERT(m_selfQueueCount,
+         "Failed to register SelfQueueCount statistic\n");
+  m_selfWakeCount = registerStatistic<uint64_t>(statParams, "SelfWakeCount");
+  ASSERT(m_selfWakeCount,
+         "Failed to register SelfWakeCount statistic\n");
+  if (m_config.statsOut && m_config.selfQueue)
+    {
+      m_selfQueueCount->setFlagOutputAtEndOfSim(true);
+      m_selfWakeCount->setFlagOutputAtEndOfSim(true);
+    }
+
   // Initial events created in setup()
 
   // Tell SST to wait until we authorize it to exit
@@ -275,6 +634,9 @@ Phold::Phold( SST::ComponentId_t id, SST::Params& params )
   // Alternative would be to pass the `--stop-at=TIME` option to SST
   // or from Python `sst.setProgramOption('stop-at', TIME)`
 
+  m_ctorNanos += SteadyNanos() - ctorStart;
+  ++m_ctorCount;
+
 }  // Phold(...)
 
 
@@ -283,14 +645,10 @@ Phold::Phold() : SST::Component(-1)
   VERBOSE(2, "%s", "Default c'tor()\n");
   /*
    * \todo How to initialize a Component after deserialization?
-   * Here we need m_number, m_average
+   * Here we need m_config.number, m_config.average
    * These are class static, so available in this case,
    * but what to do in the general case of instance data?
    */
-  m_rng  = new Phold::RNG_t;
-  m_remRng = m_rng;
-  m_nodeRng = new SST::RNG::SSTUniformDistribution(m_number, m_rng);
-  m_delayRng = new SST::RNG::SSTExponentialDistribution(m_average.invert().getDoubleValue(), m_rng);
 
 }  // Phold()
 
@@ -298,30 +656,19 @@ Phold::Phold() : SST::Component(-1)
 Phold::~Phold() noexcept
 {
   VERBOSE(2, "%s", "Destructor()\n");
-#define DELETE(p) \
-  VERBOSE(4, "  deleting %s @%p\n", #p, (void*)(p));  \
-  delete p; \
-  p = 0
-
-  DELETE(m_rng);
-  DELETE(m_nodeRng);
-  DELETE(m_delayRng);
-
-#undef DELETE
-<<<<<<< HEAD
-
-}  // ~Phold()
-=======
->>>>>>> pdbj/master
+  // Events still in flight keep their own references
+  if (m_sharedPayload) m_sharedPayload->Release();
+  // The links outlive us, so detach the shared handler before freeing it,
+  // however we got here
+  DetachSharedHandler();
+  delete m_sharedHandler;
 
 }  // ~Phold()
 
-<<<<<<< HEAD
-=======
 
->>>>>>> pdbj/master
 void
-Phold::ShowConfiguration(double thread_latency) const
+Phold::ShowConfiguration(const Latencies & latencies, const Topology & topology,
+                         const Variant & variant) const
 {
   VERBOSE(2, "%s", "\n");
 
@@ -332,56 +679,79 @@ Phold::ShowConfiguration(double thread_latency) const
           m_timeConverter->getPeriod().toStringBestSI().c_str(),
           m_timeConverter->getPeriod().getDoubleValue());
 
-  auto minimum = TIMEBASE * m_minimum;
-  // duty_factor = m_average / (minimum + m_average)
-  auto duty = m_average;
-  duty += TIMEBASE * m_minimum;
-  auto period = duty;  // minimum + m_average
+  // duty_factor = m_config.average / (minimum + m_config.average)
+  auto duty = m_config.average;
+  duty += TIMEBASE * m_config.minimum;
+  auto period = duty;  // minimum + m_config.average
   duty.invert();
-  duty *= m_average;
+  duty *= m_config.average;
   double duty_factor = duty.getDoubleValue();
-<<<<<<< HEAD
-  VERBOSE(3, "  min: %s, duty: %s, df: %f\n",
-          minimum.toStringBestSI().c_str(), 
-          duty.toStringBestSI().c_str(), 
-=======
   VERBOSE(3, "  period: %s, duty factor: %f\n",
           period.toStringBestSI().c_str(),
->>>>>>> pdbj/master
           duty_factor);
 
-  double ev_per_win = m_events * duty_factor;
+  double ev_per_win = m_config.events * duty_factor;
   const double min_ev_per_win = 10;
   unsigned long min_events = min_ev_per_win / duty_factor;
   VERBOSE(3, "  m_ev: %lu, ev_win: %f, min_ev_win: %f, min_ev: %lu\n",
-          m_events, ev_per_win, min_ev_per_win, min_events);
+          m_config.events, ev_per_win, min_ev_per_win, min_events);
 
   // Convert period to rate, then expected total number of events
-  auto tEvents = (TIMEBASE * m_number * m_events * m_stop) / period;
+  auto tEvents = (TIMEBASE * m_config.number * m_config.events * m_config.stop) / period;
   double totalEvents = tEvents.getDoubleValue();
 
   std::stringstream ss;
   ss << "PHOLD Configuration:"
 
-#ifndef PHOLD_FIXED
-     << "\n    Remote LP fraction:                   " << m_remote
-#else
-     << "\n    Remote LP fraction:                   " << "1 (fixed)"
-#endif
+     << "\n    Remote LP fraction:                   " << m_config.remote
 
-     << "\n    Minimum inter-event delay:            " << toBestSI(m_minimum)
-     << "\n    Inter-thread min delay:               " << toBestSI(thread_latency)
+     << "\n    Minimum inter-event delay:            " << toBestSI(m_config.minimum)
+     << "\n    Inter-thread min delay:               "
+     << toBestSI(latencies.getConfig().thread * PHOLD_PY_TIMEFACTOR)
+     << "\n    Link latencies:                       " << latencies.toString()
+     << "\n    Lookahead between ranks, at least:    "
+     << toBestSI(latencies.Lookahead() * PHOLD_PY_TIMEFACTOR)
 
-#ifndef PHOLD_FIXED
-     << "\n    Additional exponential average delay: " << m_average.toStringBestSI()
-#else
-     << "\n    Additional fixed delay:               " << m_average.toStringBestSI()
-#endif
+     << "\n    Additional average delay:             " << m_config.average.toStringBestSI()
      << "\n    Average period:                       " << period.toStringBestSI()
-     << "\n    Stop time:                            " << toBestSI(m_stop)
-     << "\n    Number of LPs:                        " << m_number
-     << "\n    Number of initial events per LP:      " << m_events
-     << "\n    Size of event data buffer (bytes):    " << m_bufferSize
+     << "\n    Warm up, not counted:                 " << toBestSI(m_config.warmup)
+     << "\n    Stop time:                            " << toBestSI(m_config.stop)
+     << "\n    Number of LPs:                        " << m_config.number
+     << "\n    Topology:                             " << topology.toString()
+     << "\n    Neighbors of LP 0:                    " << topology.neighbors(0).size()
+     << "\n    Destination distribution:             " << m_destinations->toString()
+     << "\n    Number of initial events per LP:      " << m_config.events
+     << "\n    Size of event data buffer (bytes):    " << m_config.payloads.toString()
+     << (m_config.payloads.Max() <= PholdEvent::INLINE_BYTES ? " (inline)" : "")
+     << (m_config.sharedBuffer ? ", shared" : "")
+     << "\n    Event pool:                           " << (m_config.pool ? "yes" : "no")
+     << "\n    Event handlers:                       " << (m_config.shared ? "shared" : "per link")
+     << "\n    Local events:                         "
+     << (m_config.selfQueue ? "self queue" : "self link")
+     << "\n    Event counting:                       "
+     << (m_config.counters ? "plain counters" : "statistics")
+     << "\n    Init/complete tree fan-out:           " << m_config.fanout
+     << (m_config.audit ? ", with audit" : "")
+     << "\n    Timed handleEvent() calls, 1 in:      " << m_config.timingSample
+     << "\n    Log output:                           " << m_log.toString()
+     << "\n    Event trace:                          "
+     << (m_config.traceBase.empty() ? std::string("none")
+         : m_config.traceBase + "_<rank>_<thread>.trace")
+     << "\n    Clocks:                               " << m_config.clocks;
+  if (m_config.clocks)
+    {
+      ss << (m_config.clockRank ? " per rank" : " per LP")
+         << ", every " << toBestSI(m_config.clockPeriod)
+         << (m_config.clockSpread ? " times 1, 2, ..." : "");
+    }
+  ss << "\n    Heartbeat interval:                   "
+     << (m_config.heartbeat ? toBestSI(m_config.heartbeat) : std::string("none"))
+     << "\n    Work per event:                       " << m_config.work.toString();
+  if (m_config.work.isEnabled())
+    {
+      ss << ", about " << m_config.work.Calibrate() * 1e6 << " us";
+    }
+  ss
 
      << "\n    Approx. events per LP window:         " << ev_per_win;
 
@@ -391,18 +761,11 @@ Phold::ShowConfiguration(double thread_latency) const
     }
   ss << "\n    Expected total number of events:      " << totalEvents
 
-#ifdef PHOLD_DEBUG
-     << "\n    Clock print interval:                 " << m_clockPrintInterval
-     << " cycles"
-#endif
+     << "\n    Output delay histogram:               " << (m_config.delaysOut ? "yes" : "no")
 
-     << "\n    Output delay histogram:               " << (m_delaysOut ? "yes" : "no")
-
-#ifndef PHOLD_FIXED
-     << "\n    Sampling:                             " << "rng"
-#else
-     << "\n    Sampling:                             " << "fixed"
-#endif
+     << "\n    Random number generator:              " << variant.rng
+     << "\n    Destination selection:                " << variant.destination
+     << "\n    Delay distribution:                   " << variant.delay
 
      << "\n    Optimization level:                   " << OPT_LEVEL
      << "\n    Verbosity level:                      " << m_verbose;
@@ -462,11 +825,16 @@ Phold::ShowSizes() const
     << " (" << member << ")";      \
   pholdTotal += sizeof(object)
 
+  // Avoid the comma in the SIZEOF macro arg
+  typedef SST::Event::Handler<Phold, uint32_t> LinkHandler_t;
+
   std::stringstream ss;
   std::size_t pholdTotal{0};
 
   ss << "Sizes of objects:";
-  SIZEOF(PholdEvent, "empty event");
+  SIZEOF(PholdEvent, "event, without an inline buffer");
+  SIZEOF(InlineEvent, "event with an inline buffer");
+  TABLE("PholdEvent::INLINE_BYTES", PholdEvent::INLINE_BYTES);
   SIZEOF(SST::Event, "base class");
   SIZEOF(SST::Activity, "base class");
   SIZEOF(InitEvent, "init() event");
@@ -474,21 +842,38 @@ Phold::ShowSizes() const
   SIZEOF(SST::Core::Serialization::serializable, "vtable");
   ss << "\n";
   SIZEOF(Phold, "class instance");                 pholdTotal = 0;
+  // The hot state runs from m_links to the end of Phold
+  const auto base = reinterpret_cast<const char *>(this);
+  const std::size_t hotStart = reinterpret_cast<const char *>(&m_links) - base;
+  const std::size_t hotBytes = reinterpret_cast<const char *>(&m_warm + 1) - base - hotStart;
+  TABLE("  Per event state offset", hotStart) << " (m_links onward)";
+  TABLE("  Per event state", hotBytes)
+    << " (" << (hotBytes + CACHE_LINE - 1) / CACHE_LINE << " cache lines, then PholdT::m_rng)";
+  ss << "\n      Plus, in PholdT:";
+  SIZEOF(SstRng<SST::RNG::XORShiftRNG>, "PholdT::m_rng, phold.Phold, phold.PholdFixed, phold.PholdFast");
+  SIZEOF(SstRng<SST::RNG::MersenneRNG>, "PholdT::m_rng, phold.PholdMersenne");
+  SIZEOF(PhiloxRng, "PholdT::m_rng, phold.PholdPhilox, phold.PholdPhiloxFast");
+  TABLE("Subtotal in PholdT: ", pholdTotal);       pholdTotal = 0;
   ss << "\n      Plus heap allocated:";
-  SIZEOF(SST::RNG::MersenneRNG, "m_rng");
-  SIZEOF(SST::RNG::MarsagliaRNG, "m_remRng");
-  SIZEOF(SST::RNG::SSTUniformDistribution, "m_nodeRng");
-  SIZEOF(SST::RNG::SSTExponentialDistribution, "m_delayRNg");
   SIZEOF(SST::Statistics::AccumulatorStatistic<uint64_t>, "m_sendCount");
   SIZEOF(SST::Statistics::AccumulatorStatistic<uint64_t>, "m_recvCount");
   SIZEOF(SST::Statistics::HistogramStatistic<uint64_t>, "m_delays");
   ss << "\n      (Bins are stored in a map, so additional 3 * "
      << sizeof(uint64_t) << " bytes per bin.)";
   TABLE("Subtotal heap allocated: ", pholdTotal);
-  SIZEOF(SST::Link, "N * (N - 1) links total");
-
-
-  SIZEOF(SST::UnitAlgebra, "statics TIMEBASE, m_average");
+  SIZEOF(SST::Link, "one per neighbor, plus tree links");
+  SIZEOF(LinkHandler_t, "per link handler, unless shared");
+  SIZEOF(SST::Event::Handler<Phold>, "one per LP, if shared");
+  SIZEOF(LocalEvent, "m_localQueue entry, per pending local event");
+  SIZEOF(Neighbor, "m_links entry, per link");
+
+
+  SIZEOF(Config, "static m_config, shared by all LPs");
+  const std::size_t hotConfig = reinterpret_cast<const char *>(&m_config.average)
+    - reinterpret_cast<const char *>(&m_config);
+  TABLE("  Per event configuration", hotConfig)
+    << " (" << (hotConfig + CACHE_LINE - 1) / CACHE_LINE << " cache lines)";
+  SIZEOF(SST::UnitAlgebra, "statics TIMEBASE, m_config.average");
   SIZEOF(SST::TimeConverter, "static m_timeConverter");
   SIZEOF(SST::Output, "m_output, included in Phold");
   SIZEOF(SST::Core::ThreadSafe::Barrier, "many instances in Simulator_impl");
@@ -509,60 +894,161 @@ Phold::ShowSizes() const
 
 
 void
-Phold::SendEvent(bool mustLive /* = false */)
+Phold::ShowStartup() const
+{
+  // Only once per rank
+  static std::atomic<bool> shown {false};
+  if (shown.exchange(true)) return;
+
+  const double count = m_ctorCount;
+  const double ctor = m_ctorNanos * 1e-9;
+  const double wall = (SteadyNanos() - m_ctorFirst) * 1e-9;
+
+  std::stringstream ss;
+  ss << "Startup, rank " << getRank().rank
+     << ", " << (m_config.shared ? "shared handler" : "handler per link") << ":"
+     << "\n    LPs constructed:                      " << m_ctorCount
+     << "\n    Total c'tor time (s):                 " << ctor
+     << "\n    Mean c'tor time per LP (us):          " << (count ? 1e6 * ctor / count : 0)
+     << "\n    Wall time, first c'tor to setup (s):  " << wall
+     << std::endl;
+  m_output.output("%s\n", ss.str().c_str());
+
+}  // ShowStartup()
+
+
+void
+Phold::ShowRates() const
+{
+  // Only once per rank, after all LPs have contributed
+  static std::atomic<bool> shown {false};
+  if (shown.exchange(true)) return;
+
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  const auto & totals = m_rankShare.totals;
+  const double seconds = RankShareSeconds();
+  const double perSecond = seconds > 0 ? 1 / seconds : 0;
+
+  std::stringstream ss;
+  ss << "Event rate, rank " << getRank().rank << ":"
+     << "\n    Wall clock run time (s):              " << seconds
+     << "\n    Committed events (receives):          " << totals.recvs
+     << "\n    Events per second, rank:              " << totals.recvs * perSecond
+     << "\n    Events per second per LP, mean:       "
+     << (totals.lps ? totals.recvs * perSecond / totals.lps : 0);
+  for (std::size_t t = 0; t < m_rankShare.threadRecvs.size(); ++t)
+    {
+      ss << "\n    Events per second, thread " << std::setw(4) << t << ":       "
+         << m_rankShare.threadRecvs[t] * perSecond;
+    }
+
+  if (m_config.timingSample)
+    {
+      uint64_t samples {0};
+      for (auto & c : m_rankShare.cycles) samples += c;
+      ss << "\n    handleEvent() cycles, 1 in " << m_config.timingSample
+         << " sampled, " << samples << " samples:";
+      for (std::size_t b = 0; b < CYCLE_BINS; ++b)
+        {
+          const uint64_t count = m_rankShare.cycles[b];
+          if ( ! count) continue;
+          ss << "\n      [2^" << std::setw(2) << b << ", 2^" << std::setw(2) << b + 1 << "): "
+             << std::setw(12) << count
+             << "  " << std::fixed << std::setprecision(1)
+             << 100.0 * count / samples << " %" << std::defaultfloat;
+        }
+    }
+  ss << std::endl;
+  m_output.output("%s\n", ss.str().c_str());
+
+}  // ShowRates()
+
+
+void
+Phold::ShowPool() const
+{
+  // Only once per rank; all threads share the same EventPool counts
+  static std::atomic<bool> shown {false};
+  if (shown.exchange(true)) return;
+
+  auto counts = EventPool::GetCounts();
+  auto allocs = counts.hits + counts.misses;
+  double hitRate = allocs ? 100.0 * counts.hits / allocs : 0;
+
+  std::stringstream ss;
+  ss << "Event pool, rank " << getRank().rank
+     << (m_config.pool ? "" : " (disabled)") << ":"
+     << "\n    Threads:                              " << counts.threads
+     << "\n    Allocations from free lists (hits):   " << counts.hits
+     << "\n    Allocations from global (misses):     " << counts.misses
+     << "\n    Hit rate:                             " << hitRate << " %"
+     << "\n    Frees to free lists:                  " << counts.frees
+     << "\n    Frees to global (lists full):         " << counts.released
+     << "\n    Bytes cached in free lists:           " << counts.cached
+     << std::endl;
+  m_output.output("%s\n", ss.str().c_str());
+
+}  // ShowPool()
+
+
+template <class V>
+void
+Phold::SendEventT(bool mustLive [[maybe_unused]] /* = false */)
 {
   VERBOSE(3, "%s", "\n");
+  typedef typename V::DestinationPolicy Destination;
+  typedef typename V::DelayPolicy       Delay;
+  auto & rng = static_cast<V *>(this)->m_rng;
 
   // Remote or local?
   SST::ComponentId_t nextId = getId();
-
-#ifndef PHOLD_FIXED
-  const auto rem = m_remRng->nextUniform();
-#else
-  const auto rem = 1.0;
-#endif
+  SST::Link * link = m_self;
+  // Self sends add m_config.minimum themselves
+  SST::SimTime_t latency = m_config.minimum;
 
   // Whether the event is local or remote
   bool local = false;
-  if (rem < m_remote)
+  if (Destination::IsRemote(rng, m_config.remote))
   {
-    auto reps = 0;
-    do
+    unsigned reps = 0;
+    if (Topology::Kind::FULL == m_config.topology)
       {
-#ifndef PHOLD_FIXED
-        nextId = static_cast<SST::ComponentId_t>(m_nodeRng->getNextDouble());
-#else
-        nextId = (nextId + 1) % m_number;
-#endif
+        nextId = Destination::Any(rng, *m_destinations, getId(), reps);
+        // m_links has no entry for self
+        const auto & neighbor = m_links[nextId < getId() ? nextId : nextId - 1];
+        link = neighbor.link;
+        latency = neighbor.latency;
+      }
+    else
+      {
+        // Sparse topology, choose one of our neighbors
+        auto index = Destination::Neighbor(rng, m_nTargets, m_nextTarget);
         ++reps;
-      } while (nextId == getId());
+        nextId = m_links[index].id;
+        link = m_links[index].link;
+        latency = m_links[index].latency;
+      }
 
-      VERBOSE(3, "  next rng: %f, remote (%u tries) %" PRIu64 "\n",
-              rem, reps, nextId);
+      VERBOSE(3, "  remote (%u tries) %" PRIu64 "\n", reps, nextId);
   }
   else
   {
     local = true;
-    VERBOSE(3, "  next rng: %f, self             %" PRIu64 "\n", rem, nextId);
+    VERBOSE(3, "  self             %" PRIu64 "\n", nextId);
   }
-  ASSERT(static_cast<std::size_t>(nextId) < m_number, "invalid nextId: %" PRIu64 "\n", nextId);
+  ASSERT(static_cast<std::size_t>(nextId) < m_config.number,
+         "invalid nextId: %" PRIu64 "\n", nextId);
 
   // When?
   auto now = getCurrentSimTime();
-#ifndef PHOLD_FIXED
-  auto delay = static_cast<SST::SimTime_t>(m_delayRng->getNextDouble());
-#else
-  static const
-  auto delayAvg = static_cast<SST::SimTime_t>(m_average.getDoubleValue() / TIMEFACTOR);
-  auto delay = delayAvg;
-#endif
-  auto delayTotal = delay + m_minimum;
+  auto delay = Delay::Draw(rng, m_config.delayMean);
+  auto delayTotal = delay + latency;
   auto nextEventTime = delayTotal + now;
 
   // Clean up delay
   if ( ! local)
     {
-      // For remotes m_minimum is added by the link
+      // For remotes the link latency is added by the link
       VERBOSE(3, "  delay: %" PRIu64 ", total: %" PRIu64 " => %" PRIu64 "\n",
               delay,
               delayTotal,
@@ -571,7 +1057,7 @@ Phold::SendEvent(bool mustLive /* = false */)
     } else {
       VERBOSE(3, "  delay: %" PRIu64 " + %" PRIu64 " = %" PRIu64 " => %" PRIu64 "\n",
               delay,
-              m_minimum,
+              m_config.minimum,
               delayTotal,
               nextEventTime);
       // Self links don't have a min latency configured,
@@ -581,21 +1067,42 @@ Phold::SendEvent(bool mustLive /* = false */)
 
 
   // Send a new event.  This is deleted at the reciever in handleEvent()
-  auto event = new PholdEvent(getCurrentSimTime(), m_bufferSize);
-  m_links[nextId]->send(delay, event);
+  PholdEvent * event {nullptr};
+  // Draw the size even if self queued, so selfqueue doesn't change the draws
+  const std::size_t bytes = m_config.payloads.Sample(rng);
+  if (local && m_config.selfQueue)
+    {
+      QueueLocal(nextEventTime, now);
+    }
+  else
+    {
+      event = PholdEvent::Make(getId(), getCurrentSimTime(), bytes, m_sharedPayload);
+      if (m_config.work.getConfig().kind == Work::Kind::HASH && ! event->isShared())
+        {
+          Work::Fill(event->getBuffer(), bytes, m_workSink ^ getId());
+        }
+      link->send(delay, event);
+    }
 
-  // Record only sends which will be *received* before stop time.
-  if (nextEventTime < m_stop)
+  if (m_tracer && nextEventTime < m_config.stop)
     {
-      m_sendCount->addData(1);
+      m_tracer->Append({now, nextEventTime, getId(), nextId,
+                        static_cast<uint32_t>(bytes), local ? Trace::LOCAL : 0u});
+    }
+
+  // Record only sends which will be *received* after warm up, and before stop time.
+  if (m_config.warmup <= nextEventTime && nextEventTime < m_config.stop)
+    {
+      CountSend(local && m_config.selfQueue);
+      m_checksum += EventHash(getId(), nextId, now, nextEventTime);
       VERBOSE(2, "from %" PRIu64 " @ %" PRIu64 ", delay: %" PRIu64 
               " -> %" PRIu64 " @ %" PRIu64 ", @%p, sendC: %" PRIu64 "\n",
               getId(), now, delay, 
               nextId, nextEventTime, (void*)event,
-              m_sendCount->getCount());
+              SendCount());
 
       VERBOSE(3, "  histogramming %f\n", delayTotal * TIMEFACTOR);
-      m_delays->addData(delayTotal * TIMEFACTOR);
+      RecordDelay(delayTotal);
 
 #ifdef PHOLD_DEBUG
       if (mustLive && !m_initLive)
@@ -610,87 +1117,284 @@ Phold::SendEvent(bool mustLive /* = false */)
               " -> %" PRIu64 " @ %" PRIu64 ", @%p, sendC: %" PRIu64 "%s\n",
               getId(), now, delay,
               nextId, nextEventTime, (void*)event,
-              m_sendCount->getCount(),
-              (nextEventTime < m_stop ? "" : ", (too late)"));
+              SendCount(),
+              (nextEventTime < m_config.stop ? ", (warm up)" : ", (too late)"));
   }
 
   VERBOSE(3, "%s", "  done\n");
 
-}  // SendEvent()
+}  // SendEventT()
 
 
+template <class V>
 void
-Phold::handleEvent(SST::Event *ev, uint32_t from)
+Phold::handleEventT(SST::Event *ev, uint32_t from [[maybe_unused]])
 {
+  // Sampled timing, 1 in m_config.timingSample events
+  uint64_t start {0};
+  if (m_config.timingSample && 0 == --m_sampleCountdown)
+    {
+      m_sampleCountdown = m_config.timingSample;
+      start = Cycles();
+    }
+
   auto event = dynamic_cast<PholdEvent*>(ev);
   ASSERT(event, "Failed to cast SST::Event * to PholdEvent *");
   // Extract any useful data, then clean it up
-  auto sendTime [[maybe_unused]] = event->getSendTime();
+  auto src = event->getSrcId();
+  auto sendTime = event->getSendTime();
   auto size [[maybe_unused]] = event->getBufferSize();
-  ASSERT(size == m_bufferSize, "Unexpected buffer size: %lu\n", size);
-  VERBOSE(3, "  deleting event @%p\n", (void*)event);
-  delete event;
+  ASSERT(size <= m_config.payloads.Max(), "Unexpected buffer size: %lu\n", size);
 
   auto now = getCurrentSimTime();
 
+  // Work on the payload before we free it
+  if (m_config.work.isEnabled() && now < m_config.stop) DoWorkT<V>(event->getBuffer(), size);
+  VERBOSE(3, "  deleting event @%p\n", (void*)event);
+  delete event;
+
   // Check the stopping condition
-  if (now < m_stop)
+  if (now < m_config.stop)
   {
     VERBOSE(2, "now: %" PRIu64 ", from %" PRIu32 " @ %" PRIu64 ", @%p, recvC before: %" PRIu64 "\n",
             now, from, sendTime, (void*)ev,
-            m_recvCount->getCount());
+            RecvCount());
 
     // Record the receive. 
-    m_recvCount->addData(1);
+    CountRecv(now, src, sendTime);
 
-    SendEvent();
+    SendEventT<V>();
 
   } else {
     VERBOSE(2, "now: %" PRIu64 ", from %u @ %" PRIu64
             ", @%p, stopping due to late event, recvC: %" PRIu64 "\n",
             now, from, sendTime, (void*)ev,
-            m_recvCount->getCount());
+            RecvCount());
+    ContributeRank();
     primaryComponentOKToEndSim();
   }
+
+  if (start)
+    {
+      auto bin = CycleBin(Cycles() - start);
+      m_rankShare.cycles[bin].fetch_add(1, std::memory_order_relaxed);
+    }
   VERBOSE(3, "%s", "  done\n");
 
-}  // handleEvent()
+}  // handleEventT()
 
 
-bool
-Phold::clockTick(SST::Cycle_t cycle)
+template <class V>
+void
+Phold::handleSharedEventT(SST::Event *ev)
 {
-  auto nextCore  = m_clockTimeConverter->convertToCoreTime(cycle + 1);
-  auto next = m_timeConverter->convertFromCoreTime(nextCore);
+  auto event = static_cast<PholdEvent*>(ev);
+  handleEventT<V>(ev, static_cast<uint32_t>(event->getSrcId()));
+
+}  // handleSharedEventT()
+
 
-  // Print periodically
-  if (cycle % m_clockPrintInterval == 0)
+template <class V>
+void
+Phold::handleWakeT(SST::Event *ev)
+{
+  delete ev;
+  auto now = getCurrentSimTime();
+  m_wakes.erase(now);
+  CountWake();
+
+  // Execute everything due now; new local events are at least m_config.minimum later
+  while ( ! m_localQueue.empty() && m_localQueue.top().first <= now)
     {
-      auto nextCycle = getNextClockCycle(m_clockTimeConverter);
-      auto nextPrint = cycle + m_clockPrintInterval;
-      OUTPUT0("Clock tick %" PRIu64 ", next: %" PRIu64 ", next print: %" PRIu64 "\n",
-              cycle, nextCycle, nextPrint);
+      const auto sent = m_localQueue.top().second;
+      m_localQueue.pop();
+      if (now >= m_config.stop)
+        {
+          VERBOSE(2, "now: %" PRIu64 ", stopping due to late local event, recvC: %" PRIu64 "\n",
+                  now, RecvCount());
+          ContributeRank();
+          primaryComponentOKToEndSim();
+          return;
+        }
+      VERBOSE(2, "now: %" PRIu64 ", from self, recvC before: %" PRIu64 "\n",
+              now, RecvCount());
+      CountRecv(now, getId(), sent);
+      if (m_config.work.isEnabled())
+        {
+          DoWorkT<V>(nullptr, static_cast<std::size_t>(m_config.payloads.Mean()));
+        }
+      SendEventT<V>();
     }
+  if ( ! m_localQueue.empty()) ScheduleWake(m_localQueue.top().first);
+
+}  // handleWakeT()
 
-  // To signal stop from a clock return true
-  // To continue return false
 
-  if (next > m_stop)
+template <class V>
+void
+Phold::DoWorkT(const char * payload, std::size_t bytes)
+{
+  auto & rng = static_cast<V *>(this)->m_rng;
+  const auto units = m_config.work.Units(rng);
+  if ( ! payload)
     {
-      OUTPUT0("Next tick %" PRIu64 ", stop %" PRIu64 ", stopping clock\n",
-              next, m_stop);
+      // Self queue events have no payload, so use our own copy
+      payload = reinterpret_cast<const char *>(m_workSet.data());
     }
-  return next > m_stop;
+  m_config.work.Do(units, payload, bytes, m_workSet, m_workSink);
+  VERBOSE(3, "  work %" PRIu64 " units, sink %" PRIx64 "\n", units, m_workSink);
+
+}  // DoWorkT()
+
+
+void
+Phold::QueueLocal(SST::SimTime_t when, SST::SimTime_t sent)
+{
+  m_localQueue.emplace(when, sent);
+  ScheduleWake(when);
+
+}  // QueueLocal()
+
+
+void
+Phold::ScheduleWake(SST::SimTime_t when)
+{
+  // Already have a wake up at or before when?
+  if ( ! m_wakes.empty() && *m_wakes.begin() <= when) return;
+  m_wakes.insert(when);
+  m_self->send(when - getCurrentSimTime(), new PholdEvent(getId(), getCurrentSimTime()));
+
+}  // ScheduleWake()
+
+
+void
+Phold::ConfigureClocks()
+{
+  if (0 == m_config.clocks) return;
+  // With rank scope only the first LP constructed on each rank has clocks
+  if (m_config.clockRank && m_rankShare.clocksTaken.exchange(true)) return;
+  for (uint32_t k = 0; k < m_config.clocks; ++k)
+    {
+      auto handler = new SST::Clock::Handler<Phold, uint32_t>(this, &Phold::clockTick, k);
+      ASSERT(handler, "Failed to create clock handler %" PRIu32 "\n", k);
+      auto rate = TIMEBASE * ClockPeriod(k);
+      rate.invert();
+      registerClock(rate, handler);
+      VERBOSE(3, "  clock %" PRIu32 " every %s\n", k, toBestSI(ClockPeriod(k)).c_str());
+    }
+  VERBOSE(2, "Configured %" PRIu32 " clocks\n", m_config.clocks);
+
+}  // ConfigureClocks()
+
+
+bool
+Phold::clockTick(SST::Cycle_t /* cycle */, uint32_t index)
+{
+  const auto now = getCurrentSimTime();
+  if (now < m_config.stop && now >= m_config.warmup) ++m_clockTicks;
+  // Unregister after the last tick before stop
+  return now + ClockPeriod(index) >= m_config.stop;
 
 }  // clockTick()
 
 
+void
+Phold::OpenTrace()
+{
+  if (m_config.traceBase.empty()) return;
+  const auto thread = getRank().thread;
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  auto & tracers = m_rankShare.tracers;
+  if (tracers.size() <= thread) tracers.resize(thread + 1);
+  auto & tracer = tracers[thread];
+  if ( ! tracer.writer)
+    {
+      const auto file = Trace::FileName(m_config.traceBase, getRank().rank, thread);
+      tracer.writer.reset(new Trace::Writer(file, getRank().rank, thread, TIMEFACTOR));
+      if ( ! tracer.writer->isOpen())
+        {
+          m_output.fatal(CALL_INFO, 1, "Can't open trace file %s\n", file.c_str());
+        }
+      VERBOSE(2, "Tracing thread %" PRIu32 " to %s\n", thread, file.c_str());
+    }
+  ++tracer.lps;
+  m_tracer = tracer.writer.get();
+
+}  // OpenTrace()
+
+
+void
+Phold::CloseTrace()
+{
+  if ( ! m_tracer) return;
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  auto & tracer = m_rankShare.tracers[getRank().thread];
+  m_tracer = nullptr;
+  // The last LP on the thread closes
+  if (--tracer.lps) return;
+  tracer.writer->Close();
+  m_output.output("Trace: %" PRIu64 " records written\n", tracer.writer->Count());
+
+}  // CloseTrace()
+
+
+bool
+Phold::heartbeatTick(SST::Cycle_t /* cycle */)
+{
+  const auto now = getCurrentSimTime();
+  const bool last = now + m_config.heartbeat > m_config.stop;
+
+  uint64_t recvs {0};
+  for (uint32_t t = 0; t < m_rankShare.beatThreads; ++t)
+    {
+      recvs += m_rankShare.beatCounts[t].recvs.load(std::memory_order_relaxed);
+    }
+  const auto events = recvs - m_rankShare.beatRecvs;
+  m_rankShare.beatRecvs = recvs;
+
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  const auto wall = SteadyNanos();
+  const auto since = m_rankShare.beatWall ? m_rankShare.beatWall : m_rankShare.runStart;
+  const double seconds = (wall - since) * 1e-9;
+  const double rate = seconds > 0 ? events / seconds : 0;
+  // Simulation seconds per wall second, to estimate the time left
+  const double advance = (now - m_rankShare.beatSim) * TIMEFACTOR;
+  const double remaining = (m_config.stop - std::min(now, m_config.stop)) * TIMEFACTOR;
+  const double left = advance > 0 ? remaining * seconds / advance : 0;
+  m_output.output("Heartbeat: %s (%.1f%%), %" PRIu64 " events in %.3f s, "
+                  "%.0f events/s, about %.1f s to stop\n",
+                  toBestSI(now).c_str(), 100.0 * now / m_config.stop,
+                  events, seconds, rate, left);
+  m_rankShare.beatWall = wall;
+  m_rankShare.beatSim = now;
+  return last;
+
+}  // heartbeatTick()
+
+
+SST::Link *
+Phold::getLink(SST::ComponentId_t id) const
+{
+  auto byId = [](const Neighbor & n, SST::ComponentId_t i) { return n.id < i; };
+  // Check the topology neighbors, then the extra tree links
+  auto targetsEnd = m_links.begin() + m_nTargets;
+  auto it = std::lower_bound(m_links.begin(), targetsEnd, id, byId);
+  if (it != targetsEnd && it->id == id) return it->link;
+  it = std::lower_bound(targetsEnd, m_links.end(), id, byId);
+  if (it != m_links.end() && it->id == id) return it->link;
+  return nullptr;
+
+}  // getLink()
+
+
 template <typename E>
 E *
 Phold::getEvent(SST::ComponentId_t id)
 {
   VERBOSE(3, "    getting event from link %" PRIu64 "\n", id);
-  auto event = m_links[id]->recvUntimedData();
+  auto link = getLink(id);
+  ASSERT(link, "No link to %" PRIu64 "\n", id);
+  auto event = link->recvUntimedData();
   VERBOSE(3, "    got %p\n", (void*)(event));
   return dynamic_cast<E*>(event);
 
@@ -699,12 +1403,13 @@ Phold::getEvent(SST::ComponentId_t id)
 
 template <typename E>
 void
-Phold::checkForEvents(const std::string msg)
+Phold::checkForEvents(const std::string & msg [[maybe_unused]])
 {
-  for (SST::ComponentId_t id = 0; id < m_number; ++id)
+  for (auto & n : m_links)
     {
+      auto id [[maybe_unused]] = n.id;
       VERBOSE(3, "  checking link %" PRIu64 "\n", id);
-      auto event = getEvent<E>(id);
+      auto event = dynamic_cast<E*>(n.link->recvUntimedData());
       ASSERT(NULL == event,
              "    got %s event from %" PRIu64 "\n", msg.c_str(), id);
       // This won't run because of the assert above
@@ -721,12 +1426,12 @@ Phold::checkForEvents(const std::string msg)
 void
 Phold::sendToChild(SST::ComponentId_t child)
 {
-  if (child < m_number)
+  if (child < m_config.number)
     {
       // This is deleted in init()
       auto event = new InitEvent(getId());
       VERBOSE(3, "    sending to child %" PRIu64 ", @%p\n", child, (void*)(event));
-      m_links[child]->sendUntimedData(event);
+      getLink(child)->sendUntimedData(event);
     }
   else
     {
@@ -738,24 +1443,30 @@ Phold::sendToChild(SST::ComponentId_t child)
 void
 Phold::init(unsigned int phase)
 {
-  // Use binary tree indexing to form a tree of Phold components
-  using bt = BinaryTree;
+  // Use k-ary tree indexing to form a tree of Phold components
+  if (0 == phase) Memory::Record(Memory::CONSTRUCTION);
+  const KaryTree kt(m_config.fanout);
 
   // phase is the level in the tree we're working now,
-  // which includes all components with getId() < bt::capacity(phase)
+  // which includes all components with getId() < kt.capacity(phase)
   if (0 == phase) OUTPUT0("First init phase\n");
-  if (bt::depth(m_number - 1)  == phase) OUTPUT0("Last init phase\n");
+  if (kt.depth(m_config.number - 1)  == phase) OUTPUT0("Last init phase\n");
 
-  std::size_t depth = bt::depth(getId());
+  std::size_t depth = kt.depth(getId());
   VERBOSE((0 == getId() ? 1 : 2),
           "my depth: %zu, phase: %u, begin: %zu, end: %zu\n",
-          depth, phase, bt::begin(depth), bt::end(depth));
+          depth, phase, kt.begin(depth), kt.end(depth));
+
+  // Without the audit we only poll the parent link, in our phase
 
   // First check for early init event
   if (phase < depth)
     {
-      VERBOSE(3, "%s", "  checking for early events\n");
-      checkForEvents<InitEvent>("EARLY");
+      if (m_config.audit)
+        {
+          VERBOSE(3, "%s", "  checking for early events\n");
+          checkForEvents<InitEvent>("EARLY");
+        }
     }
 
   else if (phase == depth)
@@ -766,7 +1477,7 @@ Phold::init(unsigned int phase)
       // Root id 0 does not have a parent, so skip it
       if (0 != getId())
         {
-          auto parent = bt::parent(getId());
+          auto parent = kt.parent(getId());
           VERBOSE(3, "    checking for expected event from parent %zu\n", parent);
           auto event = getEvent<InitEvent>(parent);
 
@@ -786,26 +1497,31 @@ Phold::init(unsigned int phase)
           VERBOSE(3, "    initiating tree: child %" PRIu64 "\n", getId());
         }
 
-      // Send to two children
-      auto children = bt::children(getId());
-      VERBOSE(3, "    sending to my children %zu and %zu\n",
+      // Send to our children
+      auto children = kt.children(getId());
+      VERBOSE(3, "    sending to my children [%zu, %zu)\n",
               children.first, children.second);
-      sendToChild(children.first);
-      sendToChild(children.second);
+      for (auto c = children.first; c < children.second; ++c) sendToChild(c);
 
       // Check for any other events
-      VERBOSE(3, "%s", "  checking for other events\n");
-      checkForEvents<InitEvent>("OTHER");
+      if (m_config.audit)
+        {
+          VERBOSE(3, "%s", "  checking for other events\n");
+          checkForEvents<InitEvent>("OTHER");
+        }
     }
 
   else
 
     {
-      VERBOSE(3, "%s", "  checking for late events\n");
-      ASSERT(phase > bt::depth(getId()),
+      ASSERT(phase > kt.depth(getId()),
              "  expected to be late in this phase, but not\n");
-      // Check for late events
-      checkForEvents<InitEvent>("LATE");
+      if (m_config.audit)
+        {
+          VERBOSE(3, "%s", "  checking for late events\n");
+          // Check for late events
+          checkForEvents<InitEvent>("LATE");
+        }
     }
 
 }  // init()
@@ -814,10 +1530,15 @@ Phold::init(unsigned int phase)
 void
 Phold::setup()
 {
-  VERBOSE(2, "initial events: %lu\n", m_events);
+  VERBOSE(2, "initial events: %lu\n", m_config.events);
+  Memory::Record(Memory::INIT);
+  {
+    std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+    if (0 == m_rankShare.runStart) m_rankShare.runStart = SteadyNanos();
+  }
 
   // Generate initial event set
-  for (auto i = 0ul; i < m_events; ++i)
+  for (auto i = 0ul; i < m_config.events; ++i)
     {
 #ifdef PHOLD_DEBUG
       SendEvent(true);  // record if any events are scheduled before stop
@@ -842,64 +1563,382 @@ Phold::setup()
 
   // Ensure we have a late event so we primaryComponentOKToEndSim()
   VERBOSE(3, "%s", "  sending late event to self\n");
-  auto event = new PholdEvent(getCurrentSimTime(), m_bufferSize);
-  auto delay = m_stop + m_minimum;
-  m_links[getId()]->send(delay, event);
+  auto delay = m_config.stop + m_config.minimum;
+  if (m_config.selfQueue)
+    {
+      QueueLocal(getCurrentSimTime() + delay, getCurrentSimTime());
+    }
+  else
+    {
+      auto event = PholdEvent::Make(getId(), getCurrentSimTime(),
+                                    std::min(m_config.bufferSize, m_config.payloads.Max()));
+      m_self->send(delay, event);
+    }
 
+  ShowStartup();
   OUTPUT0("Setup complete\n");
 
 }  // setup()
 
 
-std::pair<std::size_t, std::size_t>
-Phold::getChildCounts(SST::ComponentId_t child)
+void
+Phold::getChildCounts(SST::ComponentId_t child, CompleteEvent::Totals & totals)
 {
-  std::pair<std::size_t, std::size_t> counts{0, 0};
-
-  if (child < m_number)
+  if (child < m_config.number)
     {
       VERBOSE(3, "    getting expected event from child %" PRIu64 "\n", child);
       auto event = getEvent<CompleteEvent>(child);
       ASSERT(event,
              "   failed to receive expected event from child %" PRIu64 "\n", child);
-      counts.first  = event->getSendCount();
-      counts.second = event->getRecvCount();
       VERBOSE(4, "      child %" PRIu64 " reports %zu sends, %zu recvs, @%p\n",
-              child, counts.first, counts.second, (void*)event);
+              child, event->getSendCount(), event->getRecvCount(), (void*)event);
+      totals.Merge(event->getTotals());
       VERBOSE(3, "  deleting event @%p\n", (void*)event);
       delete event;
     }
   else {
     VERBOSE(3, "    skipping overflow child %" PRIu64 "\n", child);
   }
-  return counts;
 
 }  // getChildCounts
 
 
 void
-Phold::sendToParent(SST::ComponentId_t parent,
-                    std::size_t sendCount, std::size_t recvCount)
+Phold::sendToParent(SST::ComponentId_t parent, const CompleteEvent::Totals & totals)
 {
   // This is deleted in getChildCounts()
-  auto event = new CompleteEvent(sendCount, recvCount);
-  VERBOSE(3, "    sending to parent %" PRIu64 " with sends: %zu, recvs: %zu, @%p\n",
-          parent, sendCount, recvCount, (void*)event);
-  m_links[parent]->sendUntimedData(event);
+  auto event = new CompleteEvent(totals);
+  VERBOSE(3, "    sending to parent %" PRIu64 " with sends: %" PRIu64 ", recvs: %" PRIu64 ", @%p\n",
+          parent, totals.sends, totals.recvs, (void*)event);
+  getLink(parent)->sendUntimedData(event);
 
 }  // sendToParents()
 
 
+void
+Phold::ShowTotals(const CompleteEvent::Totals & totals) const
+{
+  OUTPUT0("Last complete phase\n");
+  OUTPUT0("Grand total sends: %" PRIu64 ", receives: %" PRIu64 ", error: %lld\n",
+          totals.sends, totals.recvs, (long long)totals.sends - (long long)totals.recvs);
+  // Serial, thread and MPI runs of the same configuration should agree
+  OUTPUT0("Committed event checksum: %016" PRIx64 "\n", totals.checksum);
+  // Every counted send should be received once, as sent
+  OUTPUT0("Received event checksum: %016" PRIx64 "%s\n", totals.recvChecksum,
+          totals.recvChecksum == totals.checksum ? "" : " MISMATCH");
+
+  // The one number to track
+  const double rate = totals.wall > 0 ? totals.recvs / totals.wall : 0;
+  OUTPUT0("Global committed event rate (events/s): %f\n", rate);
+  // The smallest cross-rank latency sets the SST synchronization window
+  if (totals.links)
+    {
+      OUTPUT0("Link latency, min (s): %f, mean (s): %f\n",
+              totals.minLatency * TIMEFACTOR,
+              double(totals.sumLatency) / totals.links * TIMEFACTOR);
+    }
+
+  if (totals.ticks)
+    {
+      OUTPUT0("Clock ticks: %" PRIu64 ", per second: %f, per event: %f\n",
+              totals.ticks, totals.wall > 0 ? totals.ticks / totals.wall : 0,
+              totals.recvs ? double(totals.ticks) / totals.recvs : 0);
+    }
+
+  // In steady state both halves of the measured run commit the same number
+  // of events; allow three standard deviations of the counting noise
+  const uint64_t early = totals.recvs - totals.late;
+  if (early)
+    {
+      const double halves = double(totals.late) / early;
+      const double tolerance = std::max(0.02, 3 * std::sqrt(2.0 / early));
+      OUTPUT0("Steady state, second / first half receives: %f\n", halves);
+      if (std::fabs(halves - 1) > tolerance)
+        {
+          OUTPUT0("  (Not steady!  Suggest a longer '--warmup', or '--stop')\n");
+        }
+    }
+
+  const double meanLoad = totals.lps ? double(totals.recvs) / totals.lps : 0;
+  const double perSecond = totals.wall > 0 ? 1 / totals.wall : 0;
+  std::stringstream ss;
+  ss << "Load balance:"
+     << "\n    Wall clock run time, longest rank (s): " << totals.wall
+     << "\n    LPs reporting:                        " << totals.lps
+     << "\n    Receives per LP, min:                 " << (totals.lps ? totals.minLoad : 0)
+     << "\n    Receives per LP, mean:                " << meanLoad
+     << "\n    Receives per LP, max:                 " << totals.maxLoad
+     << "\n    LP imbalance (max / mean):            " << (meanLoad ? totals.maxLoad / meanLoad : 0)
+     << "\n    Event rate per LP, min (events/s):    " << (totals.lps ? totals.minLoad : 0) * perSecond
+     << "\n    Event rate per LP, mean (events/s):   " << meanLoad * perSecond
+     << "\n    Event rate per LP, max (events/s):    " << totals.maxLoad * perSecond;
+  if (totals.ranks)
+    {
+      const double meanRate = totals.sumRate / totals.ranks;
+      ss << "\n    Ranks reporting:                      " << totals.ranks
+         << "\n    Rank event rate, min (events/s):      " << totals.minRate
+         << "\n    Rank event rate, mean (events/s):     " << meanRate
+         << "\n    Rank event rate, max (events/s):      " << totals.maxRate
+         << "\n    Total event rate (events/s):          " << totals.sumRate
+         << "\n    Rank imbalance (mean / min rate):     "
+         << (totals.minRate > 0 ? meanRate / totals.minRate : 0);
+    }
+  OUTPUT0("%s\n\n", ss.str().c_str());
+  ShowFootprint(totals);
+
+}  // ShowTotals()
+
+
+namespace {
+
+/**
+ * Convert to MiB.
+ * @param bytes The number of bytes.
+ * @returns The number of MiB.
+ */
+double
+MiB(uint64_t bytes)
+{
+  return bytes / double(1 << 20);
+}
+
+}  // anonymous namespace
+
+
+void
+Phold::ShowFootprint(const CompleteEvent::Totals & totals) const
+{
+  const double lps = totals.lps ? double(totals.lps) : 1;
+  const auto & f = totals.footprint;
+  std::stringstream ss;
+  auto line = [&ss](const std::string & label, double value)
+    {
+      ss << "\n    " << std::left << std::setw(38) << (label + ":") << std::right << value;
+    };
+  ss << "Memory footprint:";
+  line("Ranks reporting", totals.memRanks);
+  for (auto p : {Memory::CONSTRUCTION, Memory::INIT, Memory::RUN})
+    {
+      line(std::string("Peak RSS, max rank, ") + Memory::Name(p) + " (MiB)", MiB(totals.peakMax[p]));
+    }
+  line("Peak RSS, sum of ranks, run (MiB)",  MiB(totals.peakSum[Memory::RUN]));
+  line("Measured RSS growth per LP, c'tor (B)", totals.ctorGrowth / lps);
+  line("Counted bytes per LP, links",        f.links / lps);
+  line("Counted bytes per LP, handlers",     f.handlers / lps);
+  line("Counted bytes per LP, rng",          f.rng / lps);
+  line("Counted bytes per LP, statistics",   f.stats / lps);
+  line("Counted bytes per LP, total",        f.Total() / lps);
+  line("Event bytes in flight, end of run",  totals.inFlight);
+  line("Event bytes in flight per LP",       totals.inFlight / lps);
+  OUTPUT0("%s\n\n", ss.str().c_str());
+
+}  // ShowFootprint()
+
+
+Memory::Footprint
+Phold::Footprint() const
+{
+  // Avoid the comma in the sizeof() args
+  typedef SST::Event::Handler<Phold, uint32_t>            LinkHandler_t;
+  typedef SST::Statistics::AccumulatorStatistic<uint64_t> Accumulator_t;
+  typedef SST::Statistics::HistogramStatistic<float>      Histogram_t;
+
+  Memory::Footprint f;
+  // Our side of each link, plus the self link
+  f.links = (m_links.size() + 1) * sizeof(SST::Link) + m_links.capacity() * sizeof(Neighbor);
+  // One handler for all links, or one per link plus the self link
+  if (m_config.shared) f.handlers = sizeof(SST::Event::Handler<Phold>);
+  else                 f.handlers = m_links.size() * sizeof(LinkHandler_t);
+  if (m_config.selfQueue)      f.handlers += sizeof(SST::Event::Handler<Phold>);
+  else if ( ! m_config.shared) f.handlers += sizeof(LinkHandler_t);
+  f.rng = RngBytes();
+  f.stats = 2 * sizeof(Accumulator_t) + m_plain.delays.capacity() * sizeof(uint64_t);
+  if ( ! m_delays->isNullStatistic())         f.stats += sizeof(Histogram_t);
+  if ( ! m_selfQueueCount->isNullStatistic()) f.stats += sizeof(Accumulator_t);
+  if ( ! m_selfWakeCount->isNullStatistic())  f.stats += sizeof(Accumulator_t);
+  return f;
+
+}  // Footprint()
+
+
+void
+Phold::ShowMemory() const
+{
+  // Only once per rank, after the last phase
+  static std::atomic<bool> shown {false};
+  if (shown.exchange(true)) return;
+
+  std::stringstream ss;
+  ss << "Memory, rank " << getRank().rank << ":"
+     << "\n    Phase            RSS (MiB)   Peak RSS (MiB)"
+     << std::fixed << std::setprecision(1);
+  for (std::size_t p = 0; p < Memory::PHASES; ++p)
+    {
+      const auto phase = static_cast<Memory::Phase>(p);
+      const auto sample = Memory::Get(phase);
+      ss << "\n    " << std::left << std::setw(13) << Memory::Name(phase) << std::right
+         << std::setw(12) << MiB(sample.resident)
+         << std::setw(17) << MiB(sample.peak);
+    }
+  ss << std::endl;
+  m_output.output("%s\n", ss.str().c_str());
+
+}  // ShowMemory()
+
+
+SST::ComponentId_t
+Phold::RankLeader(uint32_t rank) const
+{
+  const auto n = getNumRanks();
+  const uint64_t parts = uint64_t(n.rank) * n.thread;
+  const uint64_t per = m_config.number / parts;
+  const uint64_t extra = m_config.number % parts;
+  const uint64_t p = uint64_t(rank) * n.thread;
+  return p * per + std::min(p, extra);
+
+}  // RankLeader()
+
+
+SST::RankInfo
+Phold::LinearPlacement(SST::ComponentId_t id) const
+{
+  const auto n = getNumRanks();
+  const uint64_t parts = uint64_t(n.rank) * n.thread;
+  const uint64_t per = m_config.number / parts;
+  const uint64_t extra = m_config.number % parts;
+  // The first extra blocks have per + 1 LPs
+  const uint64_t big = extra * (per + 1);
+  const uint64_t p = id < big ? id / (per + 1) : extra + (id - big) / per;
+  return SST::RankInfo(static_cast<uint32_t>(p / n.thread),
+                       static_cast<uint32_t>(p % n.thread));
+
+}  // LinearPlacement()
+
+
+void
+Phold::ContributeRank()
+{
+  if (m_contributed) return;
+  m_contributed = true;
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  m_rankShare.totals.AddLp(SendCount(), RecvCount(), m_lateRecvs);
+  m_rankShare.totals.ticks += m_clockTicks;
+  m_rankShare.totals.checksum += m_checksum;
+  m_rankShare.totals.recvChecksum += m_recvChecksum;
+  m_rankShare.totals.footprint += Footprint();
+  m_rankShare.totals.AddLinks(m_latencyMin, m_latencySum, m_nTargets);
+  m_rankShare.runEnd = std::max(m_rankShare.runEnd, SteadyNanos());
+  const auto thread = getRank().thread;
+  if (m_rankShare.threadRecvs.size() <= thread) m_rankShare.threadRecvs.resize(thread + 1, 0);
+  m_rankShare.threadRecvs[thread] += RecvCount();
+
+}  // ContributeRank()
+
+
+void
+Phold::Warm()
+{
+  m_warm = true;
+  const auto now = SteadyNanos();
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  if (0 == m_rankShare.warmStart || now < m_rankShare.warmStart) m_rankShare.warmStart = now;
+
+}  // Warm()
+
+
+double
+Phold::RankSeconds() const
+{
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  return RankShareSeconds();
+
+}  // RankSeconds()
+
+
+void
+Phold::completeRanks(unsigned int phase)
+{
+  const KaryTree kt(m_config.fanout);
+  const auto nRanks = getNumRanks().rank;
+  const auto rank = getRank().rank;
+
+  if (0 == phase) OUTPUT0("First complete phase, reducing over %" PRIu32 " ranks\n", nRanks);
+
+  // Only the rank leaders take part
+  if (getId() != RankLeader(rank))
+    {
+      if (m_config.audit) checkForEvents<CompleteEvent>("NON-LEADER");
+      return;
+    }
+
+  std::size_t maxDepth = kt.depth(nRanks - 1);
+  std::size_t ephase = maxDepth - phase;
+  VERBOSE(2, "complete phase: %u, rank %" PRIu32 ", max depth %zu, ephase: %zu\n",
+          phase, rank, maxDepth, ephase);
+
+  if (ephase != kt.depth(rank))
+    {
+      if (m_config.audit) checkForEvents<CompleteEvent>("EARLY/LATE");
+      return;
+    }
+
+  // Everyone finished before complete(), so the rank totals are final
+  CompleteEvent::Totals totals;
+  {
+    std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+    totals = m_rankShare.totals;
+    const double seconds = RankShareSeconds();
+    totals.AddRate(seconds > 0 ? totals.recvs / seconds : 0);
+    totals.wall = seconds;
+    totals.AddMemory(m_rankShare.inFlight);
+  }
+  ASSERT(totals.lps == m_ctorCount,
+         "Rank totals from %" PRIu64 " LPs, expected %" PRIu64 "\n",
+         totals.lps, uint64_t(m_ctorCount));
+
+  auto children = kt.children(rank);
+  for (auto c = children.first; c < children.second && c < nRanks; ++c)
+    {
+      getChildCounts(RankLeader(static_cast<uint32_t>(c)), totals);
+    }
+
+  if (0 < rank)
+    {
+      sendToParent(RankLeader(static_cast<uint32_t>(kt.parent(rank))), totals);
+    }
+  else
+    {
+      ShowTotals(totals);
+    }
+  if (m_config.audit) checkForEvents<CompleteEvent>("OTHER");
+
+}  // completeRanks()
+
+
 void
 Phold::complete(unsigned int phase)
 {
-  using bt = BinaryTree;
+  if (0 == phase)
+    {
+      Memory::Record(Memory::RUN);
+      // Every event still allocated is queued, undelivered
+      std::call_once(m_rankShare.inFlightOnce,
+                     []() { m_rankShare.inFlight = EventPool::GetCounts().live; });
+      FlushCounters();
+    }
+  if (m_config.rankReduce)
+    {
+      completeRanks(phase);
+      return;
+    }
+
+  const KaryTree kt(m_config.fanout);
 
   // Similar pattern to init(), but starting from the leaves
   if (0 == phase) OUTPUT0("First complete phase\n");
 
   // depth containing the last Component
-  std::size_t maxDepth = bt::depth(m_number - 1);
+  std::size_t maxDepth = kt.depth(m_config.number - 1);
   // effective phase, starting up from leaves, to parallel init()
   std::size_t ephase = maxDepth - phase;
 
@@ -907,67 +1946,140 @@ Phold::complete(unsigned int phase)
           phase, maxDepth, ephase);
 
   // First check for early events
-  if (ephase > bt::depth(getId()))
+  if (ephase > kt.depth(getId()))
     {
-      VERBOSE(3, "%s", "  checking for early events\n");
-      checkForEvents<CompleteEvent>("EARLY");
+      if (m_config.audit)
+        {
+          VERBOSE(3, "%s", "  checking for early events\n");
+          checkForEvents<CompleteEvent>("EARLY");
+        }
     }
 
-  else if (ephase == bt::depth(getId()))
+  else if (ephase == kt.depth(getId()))
 
     {
       VERBOSE(3, "%s", "  our phase\n");
-      // Get the send counts from children
-      auto children = bt::children(getId());
-      auto left = getChildCounts(children.first);
-      auto right = getChildCounts(children.second);
-
-      // Accumulate the send counts
-      auto sendCount = m_sendCount->getCount() + left.first + right.first;
-      auto recvCount = m_recvCount->getCount() + left.second + right.second;
+      CompleteEvent::Totals totals;
+      totals.AddLp(SendCount(), RecvCount(), m_lateRecvs);
+      totals.ticks = m_clockTicks;
+      totals.checksum = m_checksum;
+      totals.recvChecksum = m_recvChecksum;
+      totals.footprint = Footprint();
+      totals.AddLinks(m_latencyMin, m_latencySum, m_nTargets);
+      totals.wall = RankSeconds();
+      // Only one LP per rank adds the rank memory
+      if ( ! m_rankShare.memoryAdded.exchange(true)) totals.AddMemory(m_rankShare.inFlight);
       VERBOSE(2, "my counts: send: %" PRIu64 ", recv: %" PRIu64 ", total: %" PRIu64 "\n",
-              m_sendCount->getCount(), m_recvCount->getCount(),
-              m_sendCount->getCount() + m_recvCount->getCount());
+              SendCount(), RecvCount(),
+              SendCount() + RecvCount());
 
-      VERBOSE(3, "    accumulating sends: me: %" PRIu64 ", left: %zu, right: %zu, total: %zu\n",
-              m_sendCount->getCount(), left.first, right.first, sendCount);
-      VERBOSE(3, "    accumulating recvs: me: %" PRIu64 ", left: %zu, right: %zu, total: %" PRIu64 "\n",
-              m_recvCount->getCount(), left.second, right.second, recvCount);
+      // Accumulate the counts from children
+      auto children = kt.children(getId());
+      for (auto c = children.first; c < children.second; ++c)
+        {
+          getChildCounts(c, totals);
+        }
+      VERBOSE(3, "    accumulated sends: me: %" PRIu64 ", total: %" PRIu64 "\n",
+              SendCount(), totals.sends);
+      VERBOSE(3, "    accumulated recvs: me: %" PRIu64 ", total: %" PRIu64 "\n",
+              RecvCount(), totals.recvs);
 
       // Send the totals to our parent, unless we're at the root
       if (0 < getId())
       {
-        sendToParent(bt::parent(getId()), sendCount, recvCount);
+        sendToParent(kt.parent(getId()), totals);
+      }
+      else
+      {
+        ShowTotals(totals);
       }
-      // Log the total, from root
-      OUTPUT0("Last complete phase\n");
-      OUTPUT0("Grand total sends: %" PRIu64 ", receives: %" PRIu64 ", error: %lld\n",
-             sendCount, recvCount, (long long)sendCount - recvCount);
 
       // Finally, check for any other events
-      VERBOSE(3, "%s", "  checking for other events\n");
-      checkForEvents<CompleteEvent>("OTHER");
+      if (m_config.audit)
+        {
+          VERBOSE(3, "%s", "  checking for other events\n");
+          checkForEvents<CompleteEvent>("OTHER");
+        }
     }
 
   else
 
     {
-      VERBOSE(3, "%s", "  checking for late events\n");
-      ASSERT(ephase < bt::depth(getId()),
+      ASSERT(ephase < kt.depth(getId()),
              "  expected to be late in this phase, but not\n");
-      // Check for late eents
-      checkForEvents<CompleteEvent>("LATE");
+      if (m_config.audit)
+        {
+          VERBOSE(3, "%s", "  checking for late events\n");
+          // Check for late eents
+          checkForEvents<CompleteEvent>("LATE");
+        }
     }
 
 }  // complete()
 
 
+void
+Phold::FlushCounters()
+{
+  if ( ! m_config.counters) return;
+  VERBOSE(3, "  flushing counters: sends: %" PRIu64 ", recvs: %" PRIu64 "\n",
+          m_plain.sends, m_plain.recvs);
+  // addDataNTimes() gives the same sums and counts as addData() per event
+  if (m_plain.sends)      m_sendCount->addDataNTimes(m_plain.sends, 1);
+  if (m_plain.recvs)      m_recvCount->addDataNTimes(m_plain.recvs, 1);
+  if (m_plain.selfQueued) m_selfQueueCount->addDataNTimes(m_plain.selfQueued, 1);
+  if (m_plain.selfWakes)  m_selfWakeCount->addDataNTimes(m_plain.selfWakes, 1);
+  for (std::size_t bin = 0; bin < m_plain.delays.size(); ++bin)
+    {
+      // Bin centers land in the same Delays bins
+      auto count = m_plain.delays[bin];
+      if (count) m_delays->addDataNTimes(count, (bin + 0.5) * m_config.delayBinWidth);
+    }
+  m_plain = PlainCounters{};
+
+}  // FlushCounters()
+
+
 void
 Phold::finish()
 {
   VERBOSE(2, "%s", "\n");
+  Memory::Record(Memory::COMPLETE);
+  ShowRates();
+  ShowPool();
+  ShowMemory();
+  CloseTrace();
+  m_log.Flush(getRank().thread);
   OUTPUT0("Finish complete\n");
 }
 
 
+void
+Phold::DetachSharedHandler()
+{
+  if ( ! m_sharedHandler) return;
+  // Only called from ~Phold(), after the last delivery, while every link is still alive
+  for (auto & neighbor : m_links) neighbor.link->setFunctor(nullptr);
+  if ( ! m_config.selfQueue) m_self->setFunctor(nullptr);
+
+}  // DetachSharedHandler()
+
+
+// Hot path instantiations, one per registered variant in Phold.h
+#define PHOLD_INSTANTIATE(V)                                            \
+  template void Phold::SendEventT<V>(bool);                             \
+  template void Phold::handleEventT<V>(SST::Event *, uint32_t);         \
+  template void Phold::handleSharedEventT<V>(SST::Event *);            \
+  template void Phold::handleWakeT<V>(SST::Event *)
+
+PHOLD_INSTANTIATE(PholdXorShift::PholdT);
+PHOLD_INSTANTIATE(PholdMersenne::PholdT);
+PHOLD_INSTANTIATE(PholdPhilox::PholdT);
+PHOLD_INSTANTIATE(PholdFixed::PholdT);
+PHOLD_INSTANTIATE(PholdFast::PholdT);
+PHOLD_INSTANTIATE(PholdPhiloxFast::PholdT);
+
+#undef PHOLD_INSTANTIATE
+
+
 }  // namespace Phold
@@ -16,25 +16,38 @@
 # define ULLONG_MAX 0xffffffffffffffffULL 
 #endif
 
+#include "Checksum.h"
+#include "Destinations.h"
+#include "Latencies.h"
+#include "Log.h"
+#include "Memory.h"
+#include "Payloads.h"
 #include "PholdEvent.h"
+#include "PholdPolicy.h"
+#include "Topology.h"
+#include "Trace.h"
+#include "Work.h"
 
 #include <sst/core/component.h>
 #include <sst/core/link.h>
 #include <sst/core/eli/elementinfo.h>
-#include <sst/core/rng/mersenne.h>
-#include <sst/core/rng/marsaglia.h>
-#include <sst/core/rng/xorshift.h>
-#include <sst/core/rng/uniform.h>
-#include <sst/core/rng/expon.h>
 #include <sst/core/eli/statsInfo.h>
 #include <sst/core/statapi/stataccumulator.h>
 #include <sst/core/statapi/stathistogram.h>
 
+#include <array>
+#include <atomic>
+#include <functional>  // greater
+#include <memory>      // unique_ptr
+#include <mutex>
+#include <queue>
+#include <set>
+#include <utility>     // pair
 #include <vector>
 
 /**
  * @file
- * Phold::Phold class declaration.
+ * Phold::Phold, Phold::PholdT and PHOLD variant class declarations.
  */
 
 /** Namespace for Phold benchmark. */
@@ -49,17 +62,25 @@ namespace Phold {
  * In the literature each Phold instance is considered a "logical process" (LP).
  * Since this also serves as an SST example, we'll mostly use the SST terminology
  * and refer to the Phold LPs as "components".
+ *
+ * This class holds everything except the event hot path, SendEventT(),
+ * which is specialized at compile time by PholdT over the sampling
+ * policies in PholdPolicy.h and SamplingPolicy.h.  The registered
+ * components are the PholdT instantiations at the end of this file,
+ * such as PholdXorShift (registered as `phold.Phold`) and PholdFixed
+ * (`phold.PholdFixed`).
  */
 class Phold : public SST::Component
 {
 
 public:
 
-  /**
-   * @copydoc  component.h#SST_ELI_REGISTER_COMPONENT
-   *
-   * Register this component with SST.
-   */
+   /**
+    * Registration with SST is done by each PHOLD variant,
+    * for example PholdXorShift::SST_ELI_REGISTER_COMPONENT.
+    * The parameters, statistics and ports documented here are
+    * inherited by all variants.
+    */
    /**
     * 
     * Long macro chain starting in `sst-core/sst/core/component.h`:
@@ -102,15 +123,6 @@ public:
       \endcode
     *
     */
-  SST_ELI_REGISTER_COMPONENT
-  (
-   Phold,
-   "phold",
-   "Phold",
-   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
-   "PHOLD benchmark LP component for SST",
-   COMPONENT_CATEGORY_UNCATEGORIZED
-   );
 
    /**
     * Macro defined in `sst-core/src/sst/core/eli/paramsInfo.h`:
@@ -156,10 +168,218 @@ public:
      "Initial number of events per LP. Must be > 0.",
      "1"
    },
+   { "thread",
+     "Latency between LPs on the same rank, in seconds, for the global linklatency. "
+     "Only reported, since the links are configured in the Python.",
+     "1"
+   },
+   { "linklatency",
+     "Link latency model: 'global', 'tier' or 'uniform'. "
+     "Only reported, since the links are configured in the Python.",
+     "global"
+   },
+   { "tiers",
+     "Link latencies for the tier linklatency, in seconds, as "
+     "\"thread,rank,node,remote\".",
+     "1,1,1,1"
+   },
+   { "latencymax",
+     "Largest link latency for the uniform linklatency, in seconds. "
+     "The smallest is minimum; latencies are whole seconds apart, "
+     "so latencymax - minimum must be a whole number.",
+     "10"
+   },
+   { "rankspernode",
+     "Number of ranks per node, for the tier linklatency.",
+     "1"
+   },
+   { "topology",
+     "LP connectivity: full, ring, torus2, torus3, random, hierarchical.",
+     "full"
+   },
+   { "dims",
+     "Torus dimensions, as \"x,y[,z]\". Empty to factor number automatically.",
+     ""
+   },
+   { "neighbors",
+     "Number of neighbors per LP for the random topology.",
+     "4"
+   },
+   { "seed",
+     "Seed for choosing the random topology.",
+     "1"
+   },
+   { "group",
+     "Number of LPs per group in the hierarchical topology. Must be > 0.",
+     "0"
+   },
+   { "remotes",
+     "Number of links to other groups (in each direction) in the hierarchical topology.",
+     "1"
+   },
+   { "distribution",
+     "Remote destination distribution: 'uniform', 'local' or 'zipf'. "
+     "Non-uniform distributions require the full topology.",
+     "uniform"
+   },
+   { "locality",
+     "Probability of choosing an LP in the same block, for the local distribution.",
+     "0.9"
+   },
+   { "localsize",
+     "Number of LPs in each local block, for the local distribution. "
+     "0 for the number of LPs per thread.",
+     "0"
+   },
+   { "zipf",
+     "Exponent of the zipf distribution.",
+     "1.0"
+   },
+   { "buffer",
+     "Size of the event payload, in bytes, or the mean for the lognormal bufferdist.",
+     "0"
+   },
+   { "bufferdist",
+     "Payload size distribution: 'fixed', 'uniform', 'lognormal' or 'bimodal'.",
+     "fixed"
+   },
+   { "buffermin",
+     "Smallest payload, for the uniform and bimodal bufferdist, in bytes.",
+     "0"
+   },
+   { "buffermax",
+     "Largest payload, for the uniform and bimodal bufferdist, or the lognormal "
+     "truncation (0 for 16 * buffer), in bytes.",
+     "0"
+   },
+   { "buffersigma",
+     "Standard deviation of the log of the lognormal payload size.",
+     "1.0"
+   },
+   { "bufferlarge",
+     "Probability of the large payload, for the bimodal bufferdist.",
+     "0.1"
+   },
+   { "sharedbuffer",
+     "Reference one shared payload per LP, instead of allocating one per event. "
+     "Only events to other ranks copy the payload, when serialized.",
+     "false"
+   },
    { "delays",
      "Output delay histogram.",
      "false"
    },
+   { "pool",
+     "Recycle events through per-thread free lists.  Must be the same for every LP.",
+     "true"
+   },
+   { "shared",
+     "Use a single event handler for all links, instead of one per link.",
+     "false"
+   },
+   { "rngseed",
+     "Seed for the counter-based generator in phold.PholdPhilox.",
+     "1"
+   },
+   { "selfqueue",
+     "Keep local events in a per-LP queue, instead of sending them on the self link.",
+     "false"
+   },
+   { "counters",
+     "Count in plain counters, and flush them to the statistics in complete().",
+     "false"
+   },
+   { "fanout",
+     "Fan-out of the init() and complete() tree over LP ids.",
+     "2"
+   },
+   { "audit",
+     "Check all links for unexpected events in every init() and complete() phase, "
+     "instead of only the tree links. This is O(N^2) overall with the full topology.",
+     "false"
+   },
+   { "rankreduce",
+     "Reduce the complete() totals within each rank first, then over rank leaders. "
+     "Requires the linear partitioner.",
+     "false"
+   },
+   { "timingsample",
+     "Time one in this many handleEvent() calls with the cycle counter, "
+     "reported as a histogram per rank. 0 to disable.",
+     "0"
+   },
+   { "log",
+     "Where OUTPUT and VERBOSE messages go: 'direct' to SST::Output, flushed "
+     "per message, 'buffer' through per thread buffers to stdout, or 'file' through "
+     "per thread buffers to <logfile>_<rank>.log.  The final report is always direct.",
+     "direct"
+   },
+   { "logfile",
+     "Log file base name, with log 'file'.",
+     "phold"
+   },
+   { "logbuffer",
+     "Log buffer size per thread, bytes.  Full buffers are written in one block.",
+     "1048576"
+   },
+   { "trace",
+     "Write a binary trace of the events sent, one file per thread, "
+     "named <trace>_<rank>_<thread>.trace.  Read with phold-trace. Empty to disable.",
+     ""
+   },
+   { "warmup",
+     "Warm up time, in seconds.  Events received before this are not counted "
+     "in the statistics or event rates.  Must be < stop.",
+     "0"
+   },
+   { "clocks",
+     "Number of clock handlers to register, next to the event traffic. 0 for none.",
+     "0"
+   },
+   { "clockperiod",
+     "Period of the clocks, in seconds.",
+     "1"
+   },
+   { "clockspread",
+     "Give clock k the period (k + 1) * clockperiod, so each is a separate SST clock, "
+     "instead of all sharing one.",
+     "false"
+   },
+   { "clockscope",
+     "Register the clocks on every LP ('lp'), or on one LP per rank ('rank').",
+     "lp"
+   },
+   { "heartbeat",
+     "Report the progress of each rank every this many seconds of simulation time: "
+     "committed events, event rate and the estimated wall time to stop. 0 to disable.",
+     "0"
+   },
+   { "delaybins",
+     "Number of delay histogram bins kept by each LP with counters, "
+     "matching the Delays statistic. 0 to record each delay directly.",
+     "0"
+   },
+   { "delaybinwidth",
+     "Width of the delay histogram bins, in seconds, matching the Delays statistic.",
+     "1"
+   },
+   { "work",
+     "Synthetic work per event: 'none', 'flops', 'hash' (the payload) or 'memory'.",
+     "none"
+   },
+   { "workmean",
+     "Mean work units per event: flops loop iterations, hash passes over the payload, "
+     "or memory cache lines.",
+     "1000"
+   },
+   { "workdist",
+     "Distribution of work units per event: 'fixed' or 'exponential'.",
+     "fixed"
+   },
+   { "workset",
+     "Per-LP working set for the memory work, in bytes.",
+     "1048576"
+   },
    { "pverbose",
      "Verbose output",
      "false"
@@ -198,12 +418,22 @@ public:
      "Histogram of sampled delay times.",
      "s",
      2
+   },
+   { "SelfQueueCount",
+     "Count of local events sent through the self queue, to execute before stop time.",
+     "events",
+     1
+   },
+   { "SelfWakeCount",
+     "Count of self link wake ups to drain the self queue.",
+     "events",
+     1
    }
    );
 
   /**
-   * Format for dynamic ports `port_x`. The number of ports created
-   * will be determined from the `number` argument.
+   * Format for dynamic ports `port_x`. The ports created
+   * will be determined from the `number` and `topology` arguments.
    */
   static constexpr char PORT_NAME[]   = "port_%(number)d";
 
@@ -235,19 +465,37 @@ public:
   (
    { PORT_NAME,
      "Representative port",
-     {"phold.PholdEvent", ""}
+     {"phold.PholdEvent", "phold.InlineEvent"}
     }
   );
 
 
+  /** Incoming event handler, as a pointer to a member of Phold. */
+  typedef void (Phold::*EventHandler_t)(SST::Event *ev, uint32_t from);
+  /** Shared event handler, as a pointer to a member of Phold. */
+  typedef void (Phold::*SharedEventHandler_t)(SST::Event *ev);
+
+  /** The pieces of a PholdT needed by the Phold c'tor. */
+  struct Variant
+  {
+    EventHandler_t       handler;      /**< Per link event handler. */
+    SharedEventHandler_t shared;       /**< Shared event handler. */
+    SharedEventHandler_t wake;         /**< Self queue wake up handler. */
+    const char *         rng;          /**< Rng policy name. */
+    const char *         destination;  /**< Destination policy name. */
+    const char *         delay;        /**< Delay policy name. */
+  };
+
+
   // **** Rule of 5 ****
 
   /**
    * Constructor
-   * @param id     Component instance unique id
-   * @param params Configuration parameters
+   * @param id      Component instance unique id
+   * @param params  Configuration parameters
+   * @param variant The event handlers and policy names of the PholdT.
    */
-  Phold( SST::ComponentId_t id, SST::Params& params );
+  Phold( SST::ComponentId_t id, SST::Params& params, const Variant & variant );
   /** D'tor */
   ~Phold() noexcept override;
 
@@ -331,35 +579,142 @@ public:
   virtual void finish() override;
 
 
-private:
+protected:
 
   /** Default c'tor for serialization only. */
   Phold();
 
   /** 
-   * Send a new event to a random LP. 
+   * Send a new event to a random LP, from setup().
+   * PholdT implements this with SendEventT().
    * @param [in] mustLive If @c true record (in m_initLive) 
    *     if the scheduled event will be executed before the stop time.
    */
-  void SendEvent(bool mustLive = false);
+  virtual void SendEvent(bool mustLive = false) = 0;
+
+  /** @returns The size of the Rng policy object, for Footprint(). */
+  virtual std::size_t RngBytes() const = 0;
+
+  /** @returns The sizes of the objects allocated by this LP. */
+  Memory::Footprint Footprint() const;
+
+  /** 
+   * Send a new event to a random LP, using the policies of @c V.
+   * This is the hot path, explicitly instantiated in Phold.cc for each variant.
+   * @tparam V The PholdT variant.
+   * @param [in] mustLive If @c true record (in m_initLive) 
+   *     if the scheduled event will be executed before the stop time.
+   */
+  template <class V>
+  void SendEventT(bool mustLive = false);
 
   /**
    * Incoming event handler.
+   * @tparam V The PholdT variant.
    * @param ev The incoming event.
    * @param from The sending LP id.
    */
-  void handleEvent(SST::Event *ev, uint32_t from);
+  template <class V>
+  void handleEventT(SST::Event *ev, uint32_t from);
+
+  /**
+   * Incoming event handler shared by all links,
+   * getting the sender id from the event.
+   * @tparam V The PholdT variant.
+   * @param ev The incoming event.
+   */
+  template <class V>
+  void handleSharedEventT(SST::Event *ev);
+
+  /**
+   * Self link handler when using the self queue:
+   * execute all the local events due now.
+   * @tparam V The PholdT variant.
+   * @param ev The wake up event.
+   */
+  template <class V>
+  void handleWakeT(SST::Event *ev);
+
+  /**
+   * Do the synthetic work for one event, with m_config.work.
+   * @tparam V The PholdT variant.
+   * @param payload The event payload, or \c nullptr for self queue events.
+   * @param bytes The payload size.
+   */
+  template <class V>
+  void DoWorkT(const char * payload, std::size_t bytes);
+
+  /** @returns The mean exponential delay, in TIMEBASE units. */
+  static double DelayMean()
+  {
+    return m_config.delayMean;
+  }
+
+  /** @returns The seed for counter-based generators. */
+  static uint32_t RngSeed()
+  {
+    return m_config.rngSeed;
+  }
+
+private:
+
+  /**
+   * Detach m_sharedHandler from our links, so ~Link doesn't delete it.
+   * Called from ~Phold(), which runs before the links are destroyed,
+   * so it doesn't depend on finish() having run.
+   */
+  void DetachSharedHandler();
+
+  /** Register the load clocks, if any, from the `clocks` parameters. */
+  void ConfigureClocks();
+
+  /**
+   * @param index The clock index.
+   * @returns The period of clock @c index, in TIMEBASE units.
+   */
+  static SST::SimTime_t ClockPeriod(uint32_t index)
+  {
+    return m_config.clockPeriod * (m_config.clockSpread ? index + 1 : 1);
+  }
+
+  /**
+   * Load clock handler.  Only counts the tick, so the cost measured
+   * is the SST clock scheduling, next to the event traffic.
+   * @param cycle The current cycle of this clock.
+   * @param index The clock index.
+   * @return \c true after the last tick before stop, to unregister.
+   */
+  bool clockTick(SST::Cycle_t cycle, uint32_t index);
+
+  /**
+   * Heartbeat clock handler, on one LP per rank.  Reports the rank
+   * progress from the per thread receive counts in m_rankShare.
+   * Other threads can be up to a sync window ahead or behind, so
+   * the counts are approximate at each beat, but exact over the run.
+   * @param cycle The heartbeat number.
+   * @return \c true after the last beat before m_config.stop.
+   */
+  bool heartbeatTick(SST::Cycle_t cycle);
 
   /**
-   * Clock handler, only enabled in debug builds.
-   * @param cycle The current time when this is called.
-   * @return \c true if this clock should be disabled.
+   * Open the trace file for our thread, if tracing,
+   * or share it with the other LPs on the thread.
    */
-  bool clockTick(SST::Cycle_t cycle);
+  void OpenTrace();
+
+  /** Stop tracing; the last LP on the thread closes the file. */
+  void CloseTrace();
 
   /** Helper functions for init(), complete() */
   /** @{ */
 
+  /**
+   * Find the link to an LP by id.
+   * @param id The LP id on the far end.
+   * @returns The link, or \c nullptr if we're not connected to @c id.
+   */
+  SST::Link * getLink(SST::ComponentId_t id) const;
+
   /**
    * Get a possible event from the link at @c id.
    * @tparam E The Phold event type to return
@@ -371,42 +726,201 @@ private:
 
   /**
    * Check for unexpected messages during init() or complete().
-   * This iterates through all links checking for messages.
+   * This iterates through all links (except self) checking for messages,
+   * so is only done with m_config.audit.
    * Check for expected messages before calling this function.
    * Asserts if any messages are found.
    * @tparam E The Phold event type to check for.
+   * @param msg Label for the VERBOSE() messages, such as "EARLY".
    */
   template <typename E>
-  void checkForEvents(const std::string msg);
+  void checkForEvents(const std::string & msg);
 
   /**
    * Send an init event to a child by index.
-   * This skips children greater than @c m_number, so it's ok to call this
-   * on both pair members returned by BinaryTree::children().
+   * This skips children greater than @c m_config.number, so it's ok to call this
+   * on the whole range returned by KaryTree::children().
    * @param child The child index to send to
    */
   void sendToChild(SST::ComponentId_t child);
 
   /**
-   * Get the send and receive counts from a child.
+   * Get the totals from a child, and add them to @c totals.
+   * This skips children greater than @c m_config.number.
    * @param child The child to receive from
-   * @returns A pair of the send count and the receive count.
+   * @param [in,out] totals The totals to add to.
   */
-  std::pair<std::size_t, std::size_t>
-  getChildCounts(SST::ComponentId_t child);
+  void getChildCounts(SST::ComponentId_t child, CompleteEvent::Totals & totals);
 
   /**
-   * Send a complete event to a parent by index, containing the total
-   * number of events sent by me an my children.
+   * Send a complete event to a parent by index, containing the totals
+   * for me and my children.
    * @param parent The parent index.
-   * @param sendCount The total number of events sent by me and my children
-   * @param recvCount The total number of events received by me and my children
+   * @param totals The totals for me and my children.
    */
-  void sendToParent(SST::ComponentId_t parent,
-                    std::size_t sendCount, std::size_t recvCount);
+  void sendToParent(SST::ComponentId_t parent, const CompleteEvent::Totals & totals);
+
+  /**
+   * complete() reduction over rank leaders, with m_config.rankReduce.
+   * Each rank's totals are summed in m_rankShare, then only the
+   * leaders, the first LP on each rank, take part in the tree.
+   * @param phase The complete() phase.
+   */
+  void completeRanks(unsigned int phase);
+
+  /**
+   * Show the reduced totals, from the root.
+   * @param totals The grand totals.
+   */
+  void ShowTotals(const CompleteEvent::Totals & totals) const;
 
   /** @} */  // init(), complete() helpers
 
+  /**
+   * Linear partition helpers, for m_config.rankReduce.  These follow the SST
+   * linear partitioner: the LPs are split into contiguous blocks, one
+   * per rank and thread, with the first `number % (ranks * threads)`
+   * blocks getting one extra LP.
+   */
+  /** @{ */
+
+  /**
+   * @param rank The rank.
+   * @returns The id of the first LP on @c rank.
+   */
+  SST::ComponentId_t RankLeader(uint32_t rank) const;
+
+  /**
+   * @param id The LP id.
+   * @returns The rank and thread of LP @c id.
+   */
+  SST::RankInfo LinearPlacement(SST::ComponentId_t id) const;
+
+  /**
+   * Add our counts to m_rankShare, once, when we're done.
+   * Called when we receive an event at or after stop.
+   */
+  void ContributeRank();
+
+  /** @returns The wall clock run time of this rank so far, in seconds. */
+  double RankSeconds() const;
+
+  /** @} */  // Linear partition helpers
+
+  /**
+   * Statistics recording.  With m_config.counters these just bump the plain
+   * counters, avoiding the per event cost of the SST statistics.
+   */
+  /** @{ */
+
+  /**
+   * Record a send which will be received before stop.
+   * @param selfQueue Whether the event went through the self queue.
+   */
+  void CountSend(bool selfQueue)
+  {
+    if (m_config.counters)
+      {
+        ++m_plain.sends;
+        m_plain.selfQueued += selfQueue;
+        return;
+      }
+    m_sendCount->addData(1);
+    if (selfQueue) m_selfQueueCount->addData(1);
+  }
+
+  /**
+   * Record a receive before stop, if after the warm up.
+   * @param now The current time.
+   * @param src The sending LP.
+   * @param sendTime The time the event was sent.
+   */
+  void CountRecv(SST::SimTime_t now, SST::ComponentId_t src, SST::SimTime_t sendTime)
+  {
+    if (now < m_config.warmup) return;
+    if ( ! m_warm) Warm();
+    m_recvChecksum += EventHash(src, getId(), sendTime, now);
+    m_lateRecvs += (now >= m_config.halfway);
+    if (m_config.counters) ++m_plain.recvs;
+    else            m_recvCount->addData(1);
+    // Only this thread writes it, so no read-modify-write is needed
+    if (m_beatCount) m_beatCount->store(m_beatCount->load(std::memory_order_relaxed) + 1,
+                                        std::memory_order_relaxed);
+  }
+
+  /** Start the measured run, at our first receive after the warm up. */
+  void Warm();
+
+  /** Record a self queue wake up. */
+  void CountWake()
+  {
+    if (m_config.counters) ++m_plain.selfWakes;
+    else            m_selfWakeCount->addData(1);
+  }
+
+  /**
+   * Record a delay.
+   * @param delayTotal The total delay, in TIMEBASE units.
+   */
+  void RecordDelay(SST::SimTime_t delayTotal)
+  {
+    const float value = delayTotal * TIMEFACTOR;
+    if (m_config.counters)
+      {
+        if ( ! m_config.delaysOut) return;
+        const auto bin = static_cast<std::size_t>(value / m_config.delayBinWidth);
+        if (bin < m_plain.delays.size())
+          {
+            ++m_plain.delays[bin];
+            return;
+          }
+        // Out of range, let the histogram deal with it
+      }
+    m_delays->addData(value);
+  }
+
+  /** Flush the plain counters into the statistics, from complete(). */
+  void FlushCounters();
+
+  /** @returns The number of sends recorded so far, flushed or not. */
+  uint64_t SendCount() const
+  {
+    return m_sendCount->getCount() + m_plain.sends;
+  }
+
+  /** @returns The number of receives recorded so far, flushed or not. */
+  uint64_t RecvCount() const
+  {
+    return m_recvCount->getCount() + m_plain.recvs;
+  }
+
+  /** @} */  // Statistics recording
+
+  /**
+   * Add a local event to the self queue.
+   * @param when The event time.
+   * @param sent The send time, for the receive checksum.
+   */
+  void QueueLocal(SST::SimTime_t when, SST::SimTime_t sent);
+
+  /**
+   * Make sure the self link wakes us up no later than @c when.
+   * @param when The time of the earliest queued local event.
+   */
+  void ScheduleWake(SST::SimTime_t when);
+
+  /**
+   * Add a message to m_log, as from SST::Output, with our time and place.
+   * @param line The source line.
+   * @param file The source file.
+   * @param function The function.
+   * @param prefix The unexpanded prefix.
+   * @param format The printf format.
+   */
+  void LogWrite(uint32_t line, const char * file, const char * function,
+                const std::string & prefix, const char * format, ...) const
+    __attribute__ ((format (printf, 6, 7)));
+
   /**
    * Generate the best SI representation of the time.
    * @param sim The time value to conver to a string.
@@ -416,13 +930,46 @@ private:
 
   /**
    *  Show the configuration. 
-   *  @param thread_latency Latency between LPs on the same thread, in seconds.
+   *  @param latencies The link latency model, as configured in the Python.
+   *  @param topology The LP connectivity.
+   *  @param variant The sampling policy names.
    */
-  void ShowConfiguration(double thread_latency) const;
+  void ShowConfiguration(const Latencies & latencies, const Topology & topology,
+                         const Variant & variant) const;
 
   /** Show sizes of objects. */
   void ShowSizes() const;
 
+  /**
+   * Show the construction timing, once per rank.
+   * Called from setup(), after all c'tors and init() have run.
+   */
+  void ShowStartup() const;
+
+  /**
+   * Show the event rates and handleEvent() timing, once per rank.
+   * Called from finish(), after all LPs have contributed.
+   */
+  void ShowRates() const;
+
+  /**
+   * Show the EventPool allocation counts, once per rank.
+   * Called from finish(), since the totals aren't known until then.
+   */
+  void ShowPool() const;
+
+  /**
+   * Show the memory measured at each phase, once per rank.
+   * Called from finish(), after the last phase.
+   */
+  void ShowMemory() const;
+
+  /**
+   * Show the memory footprint, reduced over all ranks.
+   * @param totals The reduced totals.
+   */
+  void ShowFootprint(const CompleteEvent::Totals & totals) const;
+
   // **** Class static data members ****
 
   /** Default time base for component and associated links */
@@ -432,33 +979,154 @@ private:
   /** Conversion factor between python timebase and PHOLD component. */
   static /* const */ double PHOLD_PY_TIMEFACTOR;
 
-  static double            m_remote;     /**< Remote event fraction */
-  static SST::SimTime_t    m_minimum;    /**< Minimum event delay */
-  static SST::UnitAlgebra  m_average;    /**< Mean event delay, added to m_minimum */
-  static SST::SimTime_t    m_stop;       /**< Stop time */
-  static uint64_t          m_number;     /**< Total number of LPs */
-  static uint64_t          m_events;     /**< Initial number of events per LP */
-  static std::size_t       m_bufferSize; /**< Event buffer size, bytes */
-  static bool              m_statsOut;   /**< Output statistics */
-  static bool              m_delaysOut;  /**< Include delays histogram in stats output*/
+  /** Assumed cache line size, bytes, for the layout of m_config. */
+  static constexpr std::size_t CACHE_LINE {64};
+
+  /**
+   * Run configuration, the same for every LP.
+   * Each c'tor parses and checks its params into one of these,
+   * and the first publishes it to m_config, which is read only from then on.
+   * The fields read on every event come first, on cache line boundaries,
+   * so the event path touches a few read only lines, shared by every
+   * LP and thread on the rank; see ShowSizes().
+   */
+  struct alignas(CACHE_LINE) Config
+  {
+    // Read on every event
+    SST::SimTime_t    stop     {0};       /**< Stop time */
+    SST::SimTime_t    warmup   {0};       /**< Events received before this aren't counted */
+    SST::SimTime_t    halfway  {0};       /**< Middle of the measured run */
+    SST::SimTime_t    minimum  {0};       /**< Minimum event delay */
+    uint64_t          number   {2};       /**< Total number of LPs */
+    double            remote   {0.9};     /**< Remote event fraction */
+    double            delayMean {0};      /**< Mean exponential delay, TIMEBASE units */
+    uint64_t          timingSample {0};   /**< Time 1 in this many handleEvent() */
+    bool              pool     {true};    /**< Recycle events through EventPool */
+    bool              shared   {false};   /**< Share one handler for all links */
+    bool              selfQueue {false};  /**< Queue local events instead of using m_self */
+    bool              counters {false};   /**< Plain counters, flushed in complete() */
+    bool              sharedBuffer {false}; /**< Reference a per-LP shared payload */
+    bool              delaysOut {false};  /**< Include delays histogram in stats output*/
+    bool              statsOut {false};   /**< Output statistics */
+    std::size_t       bufferSize {0};     /**< Event buffer size, bytes */
+    std::size_t       delayBins {0};      /**< Plain delay histogram bins */
+    double            delayBinWidth {1};  /**< Plain delay histogram bin width, s */
+    Payloads          payloads;           /**< Event payload size distribution */
+    Work              work;               /**< Synthetic work per event */
+
+    // Setup, clocks and reporting
+    SST::UnitAlgebra  average;            /**< Mean event delay, added to minimum */
+    uint64_t          events   {1};       /**< Initial number of events per LP */
+    std::size_t       fanout   {2};       /**< init(), complete() tree fan-out */
+    bool              audit    {false};   /**< Check all links in init(), complete() */
+    bool              rankReduce {false}; /**< Reduce within ranks, then over ranks */
+    bool              clockSpread {false}; /**< Clock k has period (k + 1) * clockPeriod */
+    bool              clockRank {false};  /**< Load clocks per rank, instead of per LP */
+    uint32_t          clocks   {0};       /**< Number of load clocks */
+    SST::SimTime_t    clockPeriod {0};    /**< Load clock period */
+    SST::SimTime_t    heartbeat {0};      /**< Heartbeat interval, 0 for none */
+    uint32_t          rngSeed  {1};       /**< Seed for the counter-based RNG */
+    Topology::Kind    topology {Topology::Kind::FULL};  /**< LP connectivity */
+    std::string       traceBase;          /**< Trace file base name, empty for none */
+  };
+  /** The run configuration, set by the first c'tor. */
+  static Config            m_config;
   static uint32_t          m_verbose;    /**< Verbose output flag */
+  /** Remote destination distribution, shared by all LPs, never freed. */
+  static const Destinations * m_destinations;
 
   static SST::TimeConverter * m_timeConverter;
 
+  /** Construction timing, summed over all LPs on this rank. */
+  /** @{ */
+  static std::atomic<uint64_t> m_ctorNanos;   /**< Total c'tor time, ns */
+  static std::atomic<uint64_t> m_ctorCount;   /**< Number of c'tors */
+  static std::atomic<int64_t>  m_ctorFirst;   /**< Start of first c'tor, steady_clock ns */
+  /** @} */
+
+  /** Number of log2 bins in the handleEvent() cycle histogram. */
+  static constexpr std::size_t CYCLE_BINS {64};
+
+  /** Totals and timing shared by the LPs on this rank. */
+  struct RankShare
+  {
+    std::mutex            mutex;         /**< Guard for the rest, except the atomics and beat fields. */
+    CompleteEvent::Totals totals;        /**< Sum over LPs on this rank. */
+    int64_t               runStart {0};  /**< First setup(), steady_clock ns. */
+    int64_t               runEnd   {0};  /**< Last ContributeRank(), steady_clock ns. */
+    /** First receive after the warm up, steady_clock ns, or 0 if no warm up. */
+    int64_t               warmStart {0};
+    std::vector<uint64_t> threadRecvs;   /**< Receives by thread. */
+    /** Sampled handleEvent() cycles, bin @c b counts `[2^b, 2^(b+1))`. */
+    std::array<std::atomic<uint64_t>, CYCLE_BINS> cycles;
+    /** Guard for inFlight. */
+    std::once_flag        inFlightOnce;
+    /** EventPool bytes live at the end of the run. */
+    uint64_t              inFlight {0};
+    /** Whether the rank memory has been added to a complete() reduction. */
+    std::atomic<bool>     memoryAdded {false};
+    /** Receives on one thread, for the heartbeat, on its own cache line. */
+    struct alignas(CACHE_LINE) BeatCount
+    {
+      std::atomic<uint64_t> recvs {0};  /**< Only written by its thread. */
+    };
+    /** Receives by thread, with m_config.heartbeat. */
+    std::unique_ptr<BeatCount[]> beatCounts;
+    /** Number of threads in beatCounts. */
+    uint32_t              beatThreads {0};
+    /** Guard for beatCounts. */
+    std::once_flag        beatOnce;
+    /** Whether an LP has taken the heartbeat clock. */
+    std::atomic<bool>     beatTaken {false};
+    /** Sum of beatCounts at the last report. */
+    uint64_t              beatRecvs {0};
+    int64_t               beatWall {0};  /**< Last report, steady_clock ns. */
+    SST::SimTime_t        beatSim  {0};  /**< Last report, simulation time. */
+    /** A trace file, shared by the LPs on one thread. */
+    struct Tracer
+    {
+      std::unique_ptr<Trace::Writer> writer;  /**< The writer. */
+      uint64_t                       lps {0}; /**< LPs still using it. */
+    };
+    /** Trace files, by thread. */
+    std::vector<Tracer>   tracers;
+    /** Whether an LP has taken the clocks, with rank scope clocks. */
+    std::atomic<bool>     clocksTaken {false};
+  };
+  /** The rank totals. */
+  static RankShare m_rankShare;
+
+  /** Buffered OUTPUT() and VERBOSE() messages, with the `log` parameter. */
+  static Log m_log;
+
+  /**
+   * The measured wall clock time of this rank, from the end of the
+   * warm up, or the start of the run, to the last LP finishing.
+   * The caller must hold m_rankShare.mutex.
+   * @returns The time, in seconds.
+   */
+  static double RankShareSeconds()
+  {
+    const auto start = m_rankShare.warmStart ? m_rankShare.warmStart : m_rankShare.runStart;
+    return (m_rankShare.runEnd - start) * 1e-9;
+  }
+
   /** Flag to record that at least one initial event is scheduled
    *  before the stop time.
    *  This is set by SendEvent(true), called by Setup()
    */
   static bool m_initLive;
 
-  /** Number of cycles between print statements in mainTick */
-  SST::Cycle_t m_clockPrintInterval;
-
 
   // **** Class instance data members ****
+  // Cold state, used in setup, reporting and the optional features,
+  // comes first.  The state touched by every event is last, so it's
+  // contiguous, and runs straight into PholdT::m_rng.
 
   /** Output stream for verbose output */
   mutable SST::Output              m_output;
+  /** The m_output prefix, also used for buffered OUTPUT(). */
+  std::string                      m_outputPrefix;
 #ifdef PHOLD_DEBUG
   /**
    * Verbose output prefix,
@@ -467,28 +1135,58 @@ private:
   std::string VERBOSE_PREFIX;
 #endif
 
-  /** The list of links to other LPs */
-  std::vector<SST::Link *> m_links;
-
-  /** The clock. */
-  SST::TimeConverter *     m_clockTimeConverter;
+  /** Smallest topology neighbor link latency, TIMEBASE units. */
+  SST::SimTime_t           m_latencyMin;
+  /** Sum of the topology neighbor link latencies, for the mean. */
+  SST::SimTime_t           m_latencySum;
+  /** Count of local events through the self queue, if enabled. */
+  Statistic<uint64_t> * m_selfQueueCount;
+  /** Count of self queue wake ups, if enabled. */
+  Statistic<uint64_t> * m_selfWakeCount;
+  /** Whether we've added our counts to m_rankShare. */
+  bool                     m_contributed {false};
+  /** Load clock ticks after the warm up. */
+  uint64_t                 m_clockTicks {0};
+  /** Working set for m_config.work. */
+  std::vector<uint64_t>    m_workSet;
 
+  /** Self queue entry: the event time, then the send time. */
+  typedef std::pair<SST::SimTime_t, SST::SimTime_t> LocalEvent;
   /**
-   * Choice of underlying RNG:
-   * * SST::RNG::MersenneRNG
-   * * SST::RNG::MarsagliaRNG
-   * * SST::RNG::XORShiftRNG
+   * Self queue: pending local events, earliest first.
+   * Local events don't need an SST::Event, or a trip through the
+   * time vortex; we only send a wake up on m_self when the earliest
+   * local event moves earlier.
    */
-  typedef SST::RNG::XORShiftRNG RNG_t;
+  std::priority_queue<LocalEvent, std::vector<LocalEvent>,
+                      std::greater<LocalEvent> > m_localQueue;
+  /** Times of scheduled wake ups on m_self. */
+  std::set<SST::SimTime_t> m_wakes;
 
-  /** Base RNG instance */
-  RNG_t                                * m_rng;
-  /** Uniform RNG for deciding if event should be remote */
-  RNG_t                                * m_remRng;
-  /** Uniform RNG for picking remote LPs */
-  SST::RNG::SSTUniformDistribution     * m_nodeRng;
-  /** Exponential RNG for picking delay times */
-  SST::RNG::SSTExponentialDistribution * m_delayRng;
+  // Hot state, touched by every event
+
+  /** A link to another LP. */
+  struct Neighbor
+  {
+    SST::ComponentId_t id;       /**< The LP id on the far end. */
+    SST::Link *        link;     /**< The link. */
+    SST::SimTime_t     latency;  /**< The link latency, TIMEBASE units. */
+  };
+
+  /**
+   * The links to other LPs.  The first m_nTargets are the topology
+   * neighbors, sorted by id, which are the possible event destinations.
+   * Any remaining links, also sorted, are only used by the init()
+   * and complete() tree, when the topology doesn't already provide them.
+   * With the full topology this holds every other LP, with no gap at self.
+   */
+  std::vector<Neighbor>    m_links;
+  /** Number of topology neighbors at the beginning of m_links. */
+  std::size_t              m_nTargets;
+  /** Index of the first neighbor above us, wrapping, for FixedDestination. */
+  std::size_t              m_nextTarget;
+  /** Link to self, for local events, or self queue wake ups. */
+  SST::Link *              m_self;
 
   // Class instance statistics
   /** Count of events sent. */
@@ -504,7 +1202,254 @@ private:
    */
   Statistic<float> * m_delays;
 
+  /** Plain counters, used instead of the statistics with m_config.counters. */
+  struct PlainCounters
+  {
+    uint64_t sends      {0};  /**< Sends, as m_sendCount. */
+    uint64_t recvs      {0};  /**< Receives, as m_recvCount. */
+    uint64_t selfQueued {0};  /**< Self queue events, as m_selfQueueCount. */
+    uint64_t selfWakes  {0};  /**< Self queue wake ups, as m_selfWakeCount. */
+    /** Delay histogram, in m_config.delayBins bins from 0, as m_delays. */
+    std::vector<uint64_t> delays;
+  };
+  /** The plain counters. */
+  PlainCounters            m_plain;
+  /** Events until the next timed handleEvent(), with m_config.timingSample. */
+  uint64_t                 m_sampleCountdown {0};
+  /** Receives in the second half of the measured run. */
+  uint64_t                 m_lateRecvs {0};
+  /** Sum of the hashes of our counted sends; see CompleteEvent::Totals::checksum. */
+  uint64_t                 m_checksum {0};
+  /** Sum of the hashes of our counted receives; see CompleteEvent::Totals::recvChecksum. */
+  uint64_t                 m_recvChecksum {0};
+  /** Trace writer for our thread, or \c nullptr if not tracing. */
+  Trace::Writer *          m_tracer {nullptr};
+  /** Payload referenced by our events, with m_config.sharedBuffer. */
+  SharedPayload *          m_sharedPayload {nullptr};
+  /**
+   * The one handler for all our links, with m_config.shared.
+   * The links don't own it: ~Phold() detaches and frees it.
+   */
+  SST::Event::Handler<Phold> * m_sharedHandler {nullptr};
+  /** Accumulated m_config.work results, so the work can't be optimized away. */
+  uint64_t                 m_workSink {0};
+  /** Our thread's heartbeat receive count, or \c nullptr with no heartbeat. */
+  std::atomic<uint64_t> *  m_beatCount {nullptr};
+  /** Whether we've received an event after the warm up. */
+  bool                     m_warm {true};
+
 };  // class Phold
 
+
+/**
+ * PHOLD LP specialized by sampling policies.
+ *
+ * The policies are used through their concrete types, so the per event
+ * path, from the SST link handler through Phold::SendEventT(), has no
+ * virtual calls and the sampling is inlined.
+ *
+ * @tparam Rng         The random number generator policy.
+ * @tparam Destination The destination selection policy.
+ * @tparam Delay       The delay distribution policy.
+ * @see PholdPolicy.h, SamplingPolicy.h
+ */
+template <class Rng, class Destination, class Delay>
+class PholdT : public Phold
+{
+public:
+
+  /** The generator policy. */
+  typedef Rng         RngPolicy;
+  /** The destination selection policy. */
+  typedef Destination DestinationPolicy;
+  /** The delay distribution policy. */
+  typedef Delay       DelayPolicy;
+
+  /**
+   * Constructor
+   * @param id     Component instance unique id
+   * @param params Configuration parameters
+   */
+  PholdT( SST::ComponentId_t id, SST::Params& params )
+    : Phold(id, params, Variant{ &PholdT::template handleEventT<PholdT>,
+                                 &PholdT::template handleSharedEventT<PholdT>,
+                                 &PholdT::template handleWakeT<PholdT>,
+                                 Rng::Name(), Destination::Name(), Delay::Name() }),
+      m_rng(RngSeed(), getId(), DelayMean())
+  {
+  }
+
+protected:
+
+  /** @copydoc Phold::SendEvent() */
+  void SendEvent(bool mustLive = false) final
+  {
+    SendEventT<PholdT>(mustLive);
+  }
+
+  /** @copydoc Phold::RngBytes() */
+  std::size_t RngBytes() const final
+  {
+    return sizeof(Rng);
+  }
+
+private:
+
+  // Phold::SendEventT() uses m_rng
+  friend class Phold;
+
+  /** The generator for this LP. */
+  Rng m_rng;
+
+};  // class PholdT
+
+
+/** Standard PHOLD, with the SST XORShift generator. */
+class PholdXorShift
+  : public PholdT<SstRng<SST::RNG::XORShiftRNG>, RandomDestination, ExponentialDelay>
+{
+public:
+
+  /**
+   * @copydoc  component.h#SST_ELI_REGISTER_COMPONENT
+   *
+   * Register this component with SST.
+   * See the Phold class documentation for the expansion of this macro.
+   */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdXorShift,
+   "phold",
+   "Phold",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "PHOLD benchmark LP component for SST",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdT::PholdT;
+
+};  // class PholdXorShift
+
+
+/** PHOLD with the SST Mersenne twister generator. */
+class PholdMersenne
+  : public PholdT<SstRng<SST::RNG::MersenneRNG>, RandomDestination, ExponentialDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdMersenne,
+   "phold",
+   "PholdMersenne",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "PHOLD benchmark LP component, with the Mersenne twister RNG",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdT::PholdT;
+
+};  // class PholdMersenne
+
+
+/**
+ * PHOLD with the counter-based Philox generator.
+ * Results are independent of partitioning; see CounterRng.
+ */
+class PholdPhilox
+  : public PholdT<PhiloxRng, RandomDestination, ExponentialDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdPhilox,
+   "phold",
+   "PholdPhilox",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "PHOLD benchmark LP component, with the counter-based Philox RNG",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdT::PholdT;
+
+};  // class PholdPhilox
+
+
+/**
+ * PHOLD with the SST XORShift generator, drawing delays from the
+ * Ziggurat and uniform destinations with BoundedInt(), so the hot path
+ * does no `log()` and no double to integer scaling in most events.
+ * The distributions are the same as phold.Phold, but not the sequence.
+ */
+class PholdFast
+  : public PholdT<SstRng<SST::RNG::XORShiftRNG>, BoundedDestination, ZigguratDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdFast,
+   "phold",
+   "PholdFast",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "PHOLD benchmark LP component, with ziggurat delays and bounded integer destinations",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdT::PholdT;
+
+};  // class PholdFast
+
+
+/** PholdFast with the counter-based Philox generator. */
+class PholdPhiloxFast
+  : public PholdT<PhiloxRng, BoundedDestination, ZigguratDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdPhiloxFast,
+   "phold",
+   "PholdPhiloxFast",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "PHOLD benchmark LP component, with Philox, ziggurat delays and bounded integer destinations",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdT::PholdT;
+
+};  // class PholdPhiloxFast
+
+
+/**
+ * PHOLD with no sampling: every event goes to the next LP,
+ * with the mean delay.  This measures the framework cost alone.
+ */
+class PholdFixed
+  : public PholdT<SstRng<SST::RNG::XORShiftRNG>, FixedDestination, FixedDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdFixed,
+   "phold",
+   "PholdFixed",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "PHOLD benchmark LP component, with fixed destinations and delays",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdT::PholdT;
+
+};  // class PholdFixed
+
 }  // namespace Phold
 
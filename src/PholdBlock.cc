@@ -0,0 +1,468 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "PholdBlock.h"
+
+#include <sst/core/timeConverter.h>
+#include <sst/core/sst_types.h>
+
+#include <algorithm>  // min()
+#include <cinttypes>  // PRIxxx
+#include <mutex>      // call_once()
+#include <string>     // to_string()
+
+/**
+ * \file
+ * Phold::PholdBlock class implementation.
+ */
+
+#ifndef PHOLD_DEBUG
+
+#  define ASSERT(...)
+#  define VERBOSE(...)
+
+#else
+
+#  define ASSERT(condition, ...)                                        \
+   if (! (condition))                                                   \
+   Component::sst_assert(condition, CALL_INFO_LONG, 1, __VA_ARGS__)
+
+#  define VERBOSE(l, f, ...)                                    \
+   do {                                                         \
+    m_output.verbose(CALL_INFO, l, 0,                           \
+                     "[%u] " f, l, ## __VA_ARGS__);             \
+    m_output.flush();                                           \
+  } while (0)
+
+#endif
+
+#define OUTPUT0(...)                            \
+  if (0 == getId()) m_output.output(CALL_INFO, __VA_ARGS__)
+
+
+namespace Phold {
+
+// Class static data members
+constexpr char PholdBlock::PORT_NAME[];  // constexpr initialized in PholdBlock.h
+/* const */ SST::UnitAlgebra PholdBlock::TIMEBASE("1ms");
+/* const */ double PholdBlock::PHOLD_PY_TIMEFACTOR{1e3};
+
+PholdBlock::Config   PholdBlock::m_config;
+uint32_t             PholdBlock::m_verbose;
+const Destinations * PholdBlock::m_destinations {nullptr};
+
+
+PholdBlock::PholdBlock( SST::ComponentId_t id, SST::Params& params, const Variant & variant )
+  : SST::Component(id),
+    m_seq{0},
+    m_batches{0},
+    m_batched{0},
+    m_sends{0},
+    m_recvs{0},
+    m_localSends{0}
+{
+  m_verbose = params.find<long>("pverbose", 0);
+  m_output.init("@t:@X:PholdBlock-" + getName() + " [@p()] -> ",
+                m_verbose, 0, SST::Output::STDOUT);
+
+  // Parse into a local Config, published to m_config below
+  Config config;
+  config.remote     = params.find<double>     ("remote", 0.9);
+  config.minimum    = params.find<double>     ("minimum", 1.0) *PHOLD_PY_TIMEFACTOR;
+  config.delayMean  = params.find<double>     ("average", 9.0) *PHOLD_PY_TIMEFACTOR;
+  config.stop       = params.find<double>     ("stop", 10)     *PHOLD_PY_TIMEFACTOR;
+  config.number     = params.find<uint64_t>   ("number", 2);
+  config.lps        = params.find<uint64_t>   ("lps", 1);
+  config.events     = params.find<uint64_t>   ("events", 1);
+  config.bufferSize = params.find<std::size_t>("buffer", 0);
+  config.batch      = params.find<uint64_t>   ("batch", 0);
+  config.rngSeed    = params.find<uint32_t>   ("rngseed", 1);
+  auto flush        = params.find<std::string>("flush", "deadline");
+  if (flush != "deadline" && flush != "eager")
+    {
+      m_output.fatal(CALL_INFO, 1, "Unknown flush policy '%s'\n", flush.c_str());
+    }
+  config.eager      = (flush == "eager");
+  if (config.lps < 1 || config.number < 2)
+    {
+      m_output.fatal(CALL_INFO, 1, "Need lps > 0 and number > 1\n");
+    }
+  config.blocks     = (config.number + config.lps - 1) / config.lps;
+
+  // Uniform over all other LPs, sampled as in Phold
+  Destinations::Config destConfig;
+  destConfig.number = config.number;
+  static std::once_flag destOnce;
+  std::call_once(destOnce, [&destConfig]() { m_destinations = new Destinations(destConfig); });
+  std::string why;
+  if ( ! m_destinations->isValid(why))
+    {
+      m_output.fatal(CALL_INFO, 1, "Invalid distribution: %s\n", why.c_str());
+    }
+
+  // As Phold, only the first c'tor writes m_config, which is then read only
+  static std::once_flag configOnce;
+  std::call_once(configOnce, [&config]() { m_config = config; });
+
+  m_first = getId() * m_config.lps;
+  m_end   = std::min(m_first + m_config.lps, m_config.number);
+  VERBOSE(2, "block %" PRIu64 " hosting LPs [%" PRIu64 ", %" PRIu64 ")\n",
+          getId(), m_first, m_end);
+
+  registerTimeBase(TIMEBASE.toString(), true);
+
+  if (0 == getId())
+    {
+      std::stringstream ss;
+      ss << "PHOLD Block Configuration:"
+         << "\n    Remote LP fraction:                   " << m_config.remote
+         << "\n    Minimum inter-event delay:            " << m_config.minimum << " ms"
+         << "\n    Additional exponential average delay: " << m_config.delayMean << " ms"
+         << "\n    Stop time:                            " << m_config.stop << " ms"
+         << "\n    Number of LPs:                        " << m_config.number
+         << "\n    LPs per block:                        " << m_config.lps
+         << "\n    Number of blocks:                     " << m_config.blocks
+         << "\n    Number of initial events per LP:      " << m_config.events
+         << "\n    Size of event data buffer (bytes):    " << m_config.bufferSize
+         << "\n    Sampling, rng, destination, delay:    "
+         << variant.rng << ", " << variant.destination << ", " << variant.delay
+         << "\n    Maximum events per batch:             " << m_config.batch;
+      if (m_config.batch > 1)
+        {
+          ss << "\n    Batch flush policy:                   " << flush;
+        }
+      ss << std::endl;
+      OUTPUT0("%s\n", ss.str().c_str());
+    }
+
+  // The RNG itself is constructed by PholdBlockT, with m_config.delayMean
+
+  // Links to other blocks
+  auto pre = std::string(PORT_NAME);
+  const auto prefix(pre.erase(pre.find('%')));
+  m_links.resize(m_config.blocks, nullptr);
+  if (m_config.batch > 1) m_outbox.resize(m_config.blocks);
+  for (uint64_t b = 0; b < m_config.blocks; ++b)
+    {
+      if (b == getId()) continue;
+      auto handler = new SST::Event::Handler<PholdBlock>(this, variant.handler);
+      auto port = prefix + std::to_string(b);
+      m_links[b] = configureLink(port, handler);
+      // complete() sends the totals straight to block 0, and SendEvent()
+      // to any block, so every pair of blocks must be connected
+      if ( ! m_links[b])
+        {
+          m_output.fatal(CALL_INFO, 1,
+                         "Missing link %s: PholdBlock needs a complete block graph\n",
+                         port.c_str());
+        }
+    }
+  m_self = configureSelfLink("self",
+                             new SST::Event::Handler<PholdBlock>(this, variant.wake));
+  ASSERT(m_self, "Failed to configure self link\n");
+
+  m_sendCount = registerStatistic<uint64_t>("SendCount");
+  m_recvCount = registerStatistic<uint64_t>("RecvCount");
+
+  registerAsPrimaryComponent();
+  primaryComponentDoNotEndSim();
+
+}  // PholdBlock(...)
+
+
+PholdBlock::PholdBlock() : SST::Component(-1)
+{
+}
+
+
+PholdBlock::~PholdBlock() noexcept
+{
+}
+
+
+template <class V>
+void
+PholdBlock::SendEventT(SST::ComponentId_t src)
+{
+  typedef typename V::DestinationPolicy Destination;
+  typedef typename V::DelayPolicy       Delay;
+  auto & rng = static_cast<V *>(this)->m_rng;
+
+  // Destination: self, or another LP, sampled as in Phold
+  SST::ComponentId_t dst = src;
+  if (Destination::IsRemote(rng, m_config.remote))
+    {
+      unsigned reps = 0;
+      dst = Destination::Any(rng, *m_destinations, src, reps);
+    }
+  ASSERT(dst < m_config.number, "Invalid destination %" PRIu64 "\n", dst);
+
+  const auto now = getCurrentSimTime();
+  const auto delay = Delay::Draw(rng, m_config.delayMean);
+  const auto when = now + m_config.minimum + delay;
+
+  // Events arriving after stop would just be discarded
+  if (when >= m_config.stop) return;
+  ++m_sends;
+
+  if (m_first <= dst && dst < m_end)
+    {
+      ++m_localSends;
+      m_queue.push({when, m_seq++, src, dst});
+      ScheduleWake(when);
+    }
+  else if (m_config.batch > 1)
+    {
+      // Must flush by now + delay, so the batch arrives (after the link
+      // adds m_config.minimum) no later than this event is due
+      const auto block = BlockOf(dst);
+      auto & box = m_outbox[block];
+      const auto deadline = m_config.eager ? now : now + delay;
+      if (box.entries.empty() || deadline < box.deadline) box.deadline = deadline;
+      box.entries.push_back({when, src, dst});
+      if (box.entries.size() >= m_config.batch)
+        {
+          Flush(block);
+        }
+      else
+        {
+          ScheduleWake(box.deadline);
+        }
+    }
+  else
+    {
+      // The link adds m_config.minimum
+      auto event = new BlockEvent(src, dst, now, m_config.bufferSize);
+      m_links[BlockOf(dst)]->send(delay, event);
+    }
+
+}  // SendEventT()
+
+
+void
+PholdBlock::Flush(uint64_t block)
+{
+  auto & box = m_outbox[block];
+  if (box.entries.empty()) return;
+  ++m_batches;
+  m_batched += box.entries.size();
+  auto bytes = box.entries.size() * m_config.bufferSize;
+  auto batch = new PholdBatchEvent(getId(), getCurrentSimTime(), box.entries, bytes);
+  box.entries.clear();
+  // The link adds m_config.minimum
+  m_links[block]->send(0, batch);
+
+}  // Flush()
+
+
+template <class V>
+void
+PholdBlock::ExecuteEventT(SST::ComponentId_t dst)
+{
+  ++m_recvs;
+  SendEventT<V>(dst);
+
+}  // ExecuteEventT()
+
+
+void
+PholdBlock::ScheduleWake(SST::SimTime_t when)
+{
+  // Already have a wake up at or before when?
+  if ( ! m_wakes.empty() && *m_wakes.begin() <= when) return;
+  m_wakes.insert(when);
+  m_self->send(when - getCurrentSimTime(),
+               new PholdEvent(getId(), getCurrentSimTime()));
+
+}  // ScheduleWake()
+
+
+void
+PholdBlock::ScheduleNextWake()
+{
+  if ( ! m_queue.empty()) ScheduleWake(m_queue.top().time);
+  for (auto & box : m_outbox)
+    {
+      if ( ! box.entries.empty()) ScheduleWake(box.deadline);
+    }
+
+}  // ScheduleNextWake()
+
+
+template <class V>
+void
+PholdBlock::handleBatchT(PholdBatchEvent * batch)
+{
+  const auto now = getCurrentSimTime();
+  for (auto & entry : batch->getEntries())
+    {
+      ASSERT(entry.time >= now, "Late batch entry for %" PRIu64 "\n", entry.dst);
+      if (entry.time == now)
+        {
+          ExecuteEventT<V>(entry.dst);
+        }
+      else
+        {
+          m_queue.push({entry.time, m_seq++, entry.src, entry.dst});
+          ScheduleWake(entry.time);
+        }
+    }
+  delete batch;
+
+}  // handleBatchT()
+
+
+template <class V>
+void
+PholdBlock::handleEventT(SST::Event *ev)
+{
+  // All blocks share m_config.batch, so every link carries the same event type
+  if (m_config.batch > 1)
+    {
+      ASSERT(dynamic_cast<PholdBatchEvent*>(ev), "Expected a PholdBatchEvent\n");
+      handleBatchT<V>(static_cast<PholdBatchEvent*>(ev));
+      return;
+    }
+  ASSERT(dynamic_cast<BlockEvent*>(ev), "Expected a BlockEvent\n");
+  auto event = static_cast<BlockEvent*>(ev);
+  auto dst = event->getDstId();
+  ASSERT(m_first <= dst && dst < m_end,
+         "Event for LP %" PRIu64 " not in this block\n", dst);
+  delete event;
+  ExecuteEventT<V>(dst);
+
+}  // handleEventT()
+
+
+template <class V>
+void
+PholdBlock::handleWakeT(SST::Event *ev)
+{
+  delete ev;
+  const auto now = getCurrentSimTime();
+  m_wakes.erase(now);
+
+  if (now >= m_config.stop)
+    {
+      primaryComponentOKToEndSim();
+      return;
+    }
+
+  // Execute everything due now; new local events are at least m_config.minimum later
+  while ( ! m_queue.empty() && m_queue.top().time <= now)
+    {
+      auto dst = m_queue.top().dst;
+      m_queue.pop();
+      ExecuteEventT<V>(dst);
+    }
+
+  // Flush any batches at their deadline, after executing, so they
+  // also pick up events just created
+  for (uint64_t b = 0; b < m_outbox.size(); ++b)
+    {
+      if ( ! m_outbox[b].entries.empty() && m_outbox[b].deadline <= now) Flush(b);
+    }
+  ScheduleNextWake();
+
+}  // handleWakeT()
+
+
+void
+PholdBlock::setup()
+{
+  for (auto lp = m_first; lp < m_end; ++lp)
+    {
+      for (uint64_t i = 0; i < m_config.events; ++i) SendEvent(lp);
+    }
+
+  // Wake at stop to end the simulation
+  m_self->send(m_config.stop, new PholdEvent(getId(), 0));
+
+  OUTPUT0("Setup complete\n");
+
+}  // setup()
+
+
+void
+PholdBlock::complete(unsigned int phase)
+{
+  if (0 == phase)
+    {
+      m_sendCount->addData(m_sends);
+      m_recvCount->addData(m_recvs);
+      if (0 != getId())
+        {
+          m_links[0]->sendUntimedData(new CompleteEvent(BlockTotals()));
+        }
+    }
+  else if (1 == phase && 0 == getId())
+    {
+      auto totals = BlockTotals();
+      for (auto link : m_links)
+        {
+          if ( ! link) continue;
+          auto event = dynamic_cast<CompleteEvent*>(link->recvUntimedData());
+          ASSERT(event, "Missing complete event\n");
+          if (event)
+            {
+              totals.Merge(event->getTotals());
+              delete event;
+            }
+        }
+      OUTPUT0("Grand total sends: %" PRIu64 ", receives: %" PRIu64 ", error: %lld\n",
+              totals.sends, totals.recvs, (long long)totals.sends - (long long)totals.recvs);
+      OUTPUT0("Local event fraction: %f\n",
+              totals.sends ? double(totals.localSends) / totals.sends : 0.0);
+      if (m_config.batch > 1)
+        {
+          OUTPUT0("Batches sent: %" PRIu64 ", mean events per batch: %f\n",
+                  totals.batches,
+                  totals.batches ? double(totals.batched) / totals.batches : 0.0);
+        }
+    }
+
+}  // complete()
+
+
+CompleteEvent::Totals
+PholdBlock::BlockTotals() const
+{
+  CompleteEvent::Totals totals;
+  totals.AddLp(m_sends, m_recvs);
+  totals.localSends = m_localSends;
+  totals.batches = m_batches;
+  totals.batched = m_batched;
+  return totals;
+
+}  // BlockTotals()
+
+
+void
+PholdBlock::finish()
+{
+  OUTPUT0("Finish complete\n");
+
+}  // finish()
+
+
+// Hot path instantiations, one per registered variant in PholdBlock.h
+#define PHOLD_BLOCK_INSTANTIATE(V)                                      \
+  template void PholdBlock::SendEventT<V>(SST::ComponentId_t);          \
+  template void PholdBlock::handleEventT<V>(SST::Event *);              \
+  template void PholdBlock::handleWakeT<V>(SST::Event *)
+
+PHOLD_BLOCK_INSTANTIATE(PholdBlockXorShift::PholdBlockT);
+PHOLD_BLOCK_INSTANTIATE(PholdBlockPhilox::PholdBlockT);
+PHOLD_BLOCK_INSTANTIATE(PholdBlockFast::PholdBlockT);
+PHOLD_BLOCK_INSTANTIATE(PholdBlockPhiloxFast::PholdBlockT);
+
+#undef PHOLD_BLOCK_INSTANTIATE
+
+
+}  // namespace Phold
@@ -0,0 +1,570 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+// Work around a Clang12-MacPorts MPI configuration issue
+#include <climits>
+#ifndef ULLONG_MAX
+# pragma message "Supplying fallback ULLONG_MAX"
+# define ULLONG_MAX 0xffffffffffffffffULL
+#endif
+
+#include "Destinations.h"
+#include "PholdEvent.h"
+#include "PholdPolicy.h"
+
+#include <sst/core/component.h>
+#include <sst/core/link.h>
+#include <sst/core/eli/elementinfo.h>
+#include <sst/core/eli/statsInfo.h>
+#include <sst/core/statapi/stataccumulator.h>
+
+#include <functional>  // greater
+#include <queue>
+#include <set>
+#include <vector>
+
+/**
+ * @file
+ * Phold::PholdBlock, Phold::PholdBlockT and PholdBlock variant class declarations.
+ */
+
+namespace Phold {
+
+/**
+ * Container component hosting many PHOLD LPs.
+ *
+ * Each PholdBlock hosts `lps` consecutive PHOLD LPs, indexed globally
+ * with block `b` holding LPs `[b * lps, (b + 1) * lps)`.
+ * Events between LPs in the same block are kept in a local pending event
+ * queue, and never touch the SST core.  Only events to LPs in other
+ * blocks are sent over SST links, which connect every pair of blocks.
+ *
+ * The LPs themselves are minimal: they share the block RNG and counters.
+ * Comparing the event rate with Phold at the same `number` separates
+ * the SST per-component and per-event framework costs from the
+ * PHOLD event processing itself.  To keep that comparison fair the
+ * destinations and delays are drawn with the same sampling policies
+ * as Phold, through PholdBlockT, and the parameters are parsed once
+ * into a shared, read only Config.
+ *
+ * With `batch > 1` events to the same destination block are coalesced
+ * into a PholdBatchEvent.  A batch is flushed when it reaches `batch`
+ * events, or at its deadline, whichever comes first.  With the `deadline`
+ * flush policy the deadline is the latest time which still delivers
+ * every entry on time: the earliest entry send time plus its delay beyond
+ * the link minimum.  This holds batches open for up to a full lookahead
+ * window.  With the `eager` policy the deadline is the current time,
+ * so only events created at the same simulation time are coalesced.
+ *
+ * As with Phold, the SST component id is assumed to be the block index.
+ *
+ * This class holds everything except the event hot path, which is
+ * specialized over the sampling policies by PholdBlockT.  The registered
+ * components are the PholdBlockT instantiations at the end of this file,
+ * such as PholdBlockXorShift (registered as `phold.PholdBlock`).
+ */
+class PholdBlock : public SST::Component
+{
+
+public:
+
+  /**
+   * Registration with SST is done by each variant,
+   * for example PholdBlockXorShift::SST_ELI_REGISTER_COMPONENT.
+   * The parameters, statistics and ports documented here are
+   * inherited by all variants.
+   */
+  SST_ELI_DOCUMENT_PARAMS
+  (
+   { "remote",
+     "Fraction of events which should go to other LPs",
+     "0.9"
+   },
+   { "minimum",
+     "Minimum delay when sending events, in seconds. Must be >0.",
+     "1"
+   },
+   { "average",
+     "Mean delay to be added to min when sending events, in seconds. Must be >0.",
+     "9"
+   },
+   { "stop",
+     "Maximum simulation time, in seconds. Must be >0",
+     "10"
+   },
+   { "number",
+     "Total number of LPs, over all blocks. Must be at least >1.",
+     "2"
+   },
+   { "lps",
+     "Number of LPs per block. Must be > 0.",
+     "1"
+   },
+   { "events",
+     "Initial number of events per LP. Must be > 0.",
+     "1"
+   },
+   { "buffer",
+     "Size of the event data buffer for events between blocks, in bytes.",
+     "0"
+   },
+   { "batch",
+     "Maximum number of events coalesced into a batch to another block. "
+     "0 or 1 to send events individually.",
+     "0"
+   },
+   { "flush",
+     "Batch flush policy: 'deadline' or 'eager'.",
+     "deadline"
+   },
+   { "rngseed",
+     "Seed for the counter-based generator in phold.PholdBlockPhilox.",
+     "1"
+   },
+   { "pverbose",
+     "Verbose output",
+     "false"
+   }
+  );
+
+  SST_ELI_DOCUMENT_STATISTICS
+  (
+   { "SendCount",
+     "Count of events sent by all LPs in this block to execute before stop time.",
+     "events",
+     1
+   },
+   { "RecvCount",
+     "Count of events received by all LPs in this block before stop time.",
+     "events",
+     1
+   }
+   );
+
+  /** Format for dynamic ports `port_x`, where `x` is the other block index. */
+  static constexpr char PORT_NAME[]   = "port_%(blocks)d";
+
+  SST_ELI_DOCUMENT_PORTS
+  (
+   { PORT_NAME,
+     "Link to another block",
+     {"phold.BlockEvent", "phold.PholdBatchEvent"}
+    }
+  );
+
+
+  /** Event handler, as a pointer to a member of PholdBlock. */
+  typedef void (PholdBlock::*EventHandler_t)(SST::Event *ev);
+
+  /** The pieces of a PholdBlockT needed by the PholdBlock c'tor. */
+  struct Variant
+  {
+    EventHandler_t handler;      /**< Handler for events from other blocks. */
+    EventHandler_t wake;         /**< Self link wake up handler. */
+    const char *   rng;          /**< Rng policy name. */
+    const char *   destination;  /**< Destination policy name. */
+    const char *   delay;        /**< Delay policy name. */
+  };
+
+
+  // **** Rule of 5 ****
+
+  /**
+   * Constructor
+   * @param id      Component instance unique id
+   * @param params  Configuration parameters
+   * @param variant The event handlers and policy names of the PholdBlockT.
+   */
+  PholdBlock( SST::ComponentId_t id, SST::Params& params, const Variant & variant );
+  /** D'tor */
+  ~PholdBlock() noexcept override;
+
+  // Rest of Rule of 5 are deleted
+  /** Copy c'tor, deleted. */
+  PholdBlock(const PholdBlock &) = delete;
+  /** Copy assignment, deleted. */
+  PholdBlock & operator= (const PholdBlock &) = delete;
+  /** Move c'tor, deleted. */
+  PholdBlock(PholdBlock &&) = delete;
+  /** Move assignment, deleted. */
+  PholdBlock & operator= (PholdBlock &&) = delete;
+
+
+  // **** Inherited from SST::BaseComponent ****
+
+  /** Send the initial events for all our LPs. */
+  virtual void setup() override;
+
+  /**
+   * Pass the event counts to block 0, which reports the run-wide totals:
+   * sends and receives, the local event fraction, and batching.
+   * Since all blocks are connected this takes just two phases.
+   * The constructor checks the block graph is complete.
+   * The per-block counts are in the SendCount and RecvCount statistics.
+   */
+  virtual void complete(unsigned int phase) override;
+
+  /** Report that we've finished. */
+  virtual void finish() override;
+
+
+protected:
+
+  /** Default c'tor for serialization only. */
+  PholdBlock();
+
+  /**
+   * Send a new event from LP @c src, from setup().
+   * PholdBlockT implements this with SendEventT().
+   * @param src The sending LP.
+   */
+  virtual void SendEvent(SST::ComponentId_t src) = 0;
+
+  /**
+   * Send a new event from LP @c src, using the policies of @c V.
+   * Destinations in this block go to the local queue,
+   * others are sent over the link to their block.
+   * This is the hot path, explicitly instantiated in PholdBlock.cc for each variant.
+   * @tparam V The PholdBlockT variant.
+   * @param src The sending LP.
+   */
+  template <class V>
+  void SendEventT(SST::ComponentId_t src);
+
+  /**
+   * Execute an event at LP @c dst, which generates a new event.
+   * @tparam V The PholdBlockT variant.
+   * @param dst The destination LP.
+   */
+  template <class V>
+  void ExecuteEventT(SST::ComponentId_t dst);
+
+  /**
+   * Incoming event from another block.
+   * @tparam V The PholdBlockT variant.
+   * @param ev The incoming event, a PholdBatchEvent if `batch > 1`,
+   *           otherwise a BlockEvent.
+   */
+  template <class V>
+  void handleEventT(SST::Event *ev);
+
+  /**
+   * Unpack a batch from another block.
+   * Entries due now are executed, the rest go to the local queue.
+   * @tparam V The PholdBlockT variant.
+   * @param batch The batch.
+   */
+  template <class V>
+  void handleBatchT(PholdBatchEvent * batch);
+
+  /**
+   * Self wake up, to execute local events.
+   * @tparam V The PholdBlockT variant.
+   * @param ev The wake up event.
+   */
+  template <class V>
+  void handleWakeT(SST::Event *ev);
+
+  /** @returns The mean exponential delay, in TIMEBASE units. */
+  static double DelayMean()
+  {
+    return m_config.delayMean;
+  }
+
+  /** @returns The seed for counter-based generators. */
+  static uint32_t RngSeed()
+  {
+    return m_config.rngSeed;
+  }
+
+private:
+
+  /** An event pending in the local queue. */
+  struct Pending
+  {
+    SST::SimTime_t     time;      /**< Delivery time. */
+    uint64_t           seq;       /**< Insertion order, to break ties. */
+    SST::ComponentId_t src;       /**< Sending LP. */
+    SST::ComponentId_t dst;       /**< Destination LP. */
+
+    /** Order by time, then insertion order. */
+    bool operator> (const Pending & rhs) const
+    {
+      return time > rhs.time || (time == rhs.time && seq > rhs.seq);
+    }
+  };
+
+  /**
+   * Schedule a self wake up, if there isn't one already at or before @c when.
+   * @param when The time to wake up.
+   */
+  void ScheduleWake(SST::SimTime_t when);
+
+  /** Schedule a wake up for the next local event or batch deadline. */
+  void ScheduleNextWake();
+
+  /**
+   * Send the pending batch to a block.
+   * @param block The destination block.
+   */
+  void Flush(uint64_t block);
+
+  /**
+   * Totals for this block, for the complete() reduction to block 0.
+   * @returns The block counters, with the block as one Totals LP.
+   */
+  CompleteEvent::Totals BlockTotals() const;
+
+  /**
+   * Block index of an LP.
+   * @param lp The LP id.
+   * @returns The block index.
+   */
+  uint64_t BlockOf(SST::ComponentId_t lp) const
+  {
+    return lp / m_config.lps;
+  }
+
+  // **** Class static data members ****
+
+  /** Default time base for component and associated links */
+  static /* const */ SST::UnitAlgebra TIMEBASE;
+  /** Conversion factor between python timebase and PHOLD component. */
+  static /* const */ double PHOLD_PY_TIMEFACTOR;
+
+  /**
+   * Run configuration, the same for every block, as Phold::Config.
+   * Each c'tor parses and checks its params into one of these,
+   * and the first publishes it to m_config, which is read only from then on.
+   * The fields read on every event come first.
+   */
+  struct Config
+  {
+    // Read on every event
+    SST::SimTime_t    stop      {0};      /**< Stop time */
+    SST::SimTime_t    minimum   {0};      /**< Minimum event delay */
+    uint64_t          lps       {1};      /**< Number of LPs per block */
+    double            remote    {0.9};    /**< Remote event fraction */
+    double            delayMean {0};      /**< Mean exponential delay, TIMEBASE units */
+    uint64_t          batch     {0};      /**< Maximum events per batch */
+    bool              eager     {false};  /**< Eager flush policy */
+    std::size_t       bufferSize {0};     /**< Event buffer size, bytes */
+
+    // Setup and reporting
+    uint64_t          number    {2};      /**< Total number of LPs */
+    uint64_t          blocks    {1};      /**< Number of blocks */
+    uint64_t          events    {1};      /**< Initial number of events per LP */
+    uint32_t          rngSeed   {1};      /**< Seed for the counter-based RNG */
+  };
+  /** The run configuration, set by the first c'tor. */
+  static Config            m_config;
+  static uint32_t          m_verbose;    /**< Verbose output flag */
+  /** Destination distribution, shared by all blocks, never freed. */
+  static const Destinations * m_destinations;
+
+
+  // **** Class instance data members ****
+
+  /** Output stream for verbose output */
+  mutable SST::Output      m_output;
+
+  /** First LP in this block. */
+  SST::ComponentId_t       m_first;
+  /** One past the last LP in this block. */
+  SST::ComponentId_t       m_end;
+
+  /** Links to other blocks, indexed by block, null for self. */
+  std::vector<SST::Link *> m_links;
+  /** Self link, for local queue wake ups. */
+  SST::Link *              m_self;
+
+  /** Local pending event queue, earliest first. */
+  std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending> > m_queue;
+  /** Insertion counter for m_queue. */
+  uint64_t                 m_seq;
+  /** Times of scheduled self wake ups. */
+  std::set<SST::SimTime_t> m_wakes;
+
+  /** Events waiting to be sent to another block. */
+  struct Outbox
+  {
+    /** The pending events. */
+    std::vector<PholdBatchEvent::Entry> entries;
+    /** Latest time to flush without delivering an entry late. */
+    SST::SimTime_t deadline;
+  };
+  /** Pending batches, indexed by destination block. */
+  std::vector<Outbox>      m_outbox;
+  /** Number of batches sent. */
+  uint64_t                 m_batches;
+  /** Number of events sent in batches. */
+  uint64_t                 m_batched;
+
+  /** Events sent by our LPs, which will execute before stop. */
+  uint64_t                 m_sends;
+  /** Events received by our LPs before stop. */
+  uint64_t                 m_recvs;
+  /** Of m_sends, those which went to the local queue. */
+  uint64_t                 m_localSends;
+
+  /** Count of events sent. */
+  SST::Statistics::Statistic<uint64_t> * m_sendCount;
+  /** Count of events received. */
+  SST::Statistics::Statistic<uint64_t> * m_recvCount;
+
+};  // class PholdBlock
+
+
+/**
+ * PholdBlock specialized by sampling policies, as PholdT.
+ * All the LPs in the block share one generator.
+ *
+ * @tparam Rng         The random number generator policy.
+ * @tparam Destination The destination selection policy.
+ * @tparam Delay       The delay distribution policy.
+ * @see PholdPolicy.h, SamplingPolicy.h
+ */
+template <class Rng, class Destination, class Delay>
+class PholdBlockT : public PholdBlock
+{
+public:
+
+  /** The generator policy. */
+  typedef Rng         RngPolicy;
+  /** The destination selection policy. */
+  typedef Destination DestinationPolicy;
+  /** The delay distribution policy. */
+  typedef Delay       DelayPolicy;
+
+  /**
+   * Constructor
+   * @param id     Component instance unique id
+   * @param params Configuration parameters
+   */
+  PholdBlockT( SST::ComponentId_t id, SST::Params& params )
+    : PholdBlock(id, params, Variant{ &PholdBlockT::template handleEventT<PholdBlockT>,
+                                      &PholdBlockT::template handleWakeT<PholdBlockT>,
+                                      Rng::Name(), Destination::Name(), Delay::Name() }),
+      m_rng(RngSeed(), getId(), DelayMean())
+  {
+  }
+
+protected:
+
+  /** @copydoc PholdBlock::SendEvent() */
+  void SendEvent(SST::ComponentId_t src) final
+  {
+    SendEventT<PholdBlockT>(src);
+  }
+
+private:
+
+  // PholdBlock::SendEventT() uses m_rng
+  friend class PholdBlock;
+
+  /** The generator for this block. */
+  Rng m_rng;
+
+};  // class PholdBlockT
+
+
+/** PholdBlock with the SST XORShift generator, as phold.Phold. */
+class PholdBlockXorShift
+  : public PholdBlockT<SstRng<SST::RNG::XORShiftRNG>, RandomDestination, ExponentialDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdBlockXorShift,
+   "phold",
+   "PholdBlock",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "Many PHOLD LPs in a single SST component",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdBlockT::PholdBlockT;
+
+};  // class PholdBlockXorShift
+
+
+/** PholdBlock with the counter-based Philox generator, as phold.PholdPhilox. */
+class PholdBlockPhilox
+  : public PholdBlockT<PhiloxRng, RandomDestination, ExponentialDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdBlockPhilox,
+   "phold",
+   "PholdBlockPhilox",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "Many PHOLD LPs in a single SST component, with the counter-based Philox RNG",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdBlockT::PholdBlockT;
+
+};  // class PholdBlockPhilox
+
+
+/**
+ * PholdBlock with ziggurat delays and bounded integer destinations,
+ * as phold.PholdFast.
+ */
+class PholdBlockFast
+  : public PholdBlockT<SstRng<SST::RNG::XORShiftRNG>, BoundedDestination, ZigguratDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdBlockFast,
+   "phold",
+   "PholdBlockFast",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "Many PHOLD LPs in a single SST component, with ziggurat delays "
+   "and bounded integer destinations",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdBlockT::PholdBlockT;
+
+};  // class PholdBlockFast
+
+
+/** PholdBlockFast with the counter-based Philox generator, as phold.PholdPhiloxFast. */
+class PholdBlockPhiloxFast
+  : public PholdBlockT<PhiloxRng, BoundedDestination, ZigguratDelay>
+{
+public:
+
+  /** @copydoc PholdXorShift::SST_ELI_REGISTER_COMPONENT */
+  SST_ELI_REGISTER_COMPONENT
+  (
+   PholdBlockPhiloxFast,
+   "phold",
+   "PholdBlockPhiloxFast",
+   SST_ELI_ELEMENT_VERSION( 1, 0, 0 ),
+   "Many PHOLD LPs in a single SST component, with Philox, ziggurat delays "
+   "and bounded integer destinations",
+   COMPONENT_CATEGORY_UNCATEGORIZED
+   );
+
+  using PholdBlockT::PholdBlockT;
+
+};  // class PholdBlockPhiloxFast
+
+}  // namespace Phold
@@ -10,45 +10,206 @@
 #ifndef PHOLD_PHOLDEVENT_H
 #define PHOLD_PHOLDEVENT_H
 
+#include "EventPool.h"
+#include "Memory.h"
+
 #include <sst/core/event.h>
 
+#include <algorithm>  // min(), max()
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <new>      // placement new
+#include <utility>  // move()
+#include <vector>
+
 /**
  * \file
  * Event types for PHOLD benchmark:
- * Phold::PholdEvent, Phold::InitEvent, Phold::CompleteEvent.
+ * Phold::PholdEvent, Phold::InlineEvent, Phold::BlockEvent,
+ * Phold::PholdBatchEvent, Phold::InitEvent, Phold::CompleteEvent,
+ * and the Phold::SharedPayload they can reference.
  */
 
 
+/**
+ * Capacity of the inline payload storage in each InlineEvent, in bytes.
+ * Payloads up to this size don't need a separate allocation.
+ * Set from the Makefile with `PHOLD_INLINE=<bytes>`.
+ */
+#ifndef PHOLD_INLINE_BYTES
+#  define PHOLD_INLINE_BYTES 64
+#endif
+
 namespace Phold {
 
+/**
+ * Reference counted, immutable payload storage, shared by events.
+ *
+ * Each LP with `sharedbuffer` makes one, and every event it sends
+ * references a prefix of it, instead of allocating and filling a
+ * new payload.  Events delivered on the same rank are passed by
+ * pointer, so they never copy the payload; events to other ranks are
+ * serialized, and unpack into their own storage.
+ * The count is atomic since events can be freed on other threads.
+ */
+class SharedPayload
+{
+public:
+  /**
+   * Make a new payload, with one reference.
+   * @param bytes The capacity.
+   * @returns The payload.
+   */
+  static SharedPayload * Make(std::size_t bytes)
+  {
+    auto p = EventPool::Allocate(sizeof(SharedPayload) + bytes);
+    return new (p) SharedPayload(bytes);
+  }
+
+  /** @returns This, with another reference. */
+  SharedPayload * Acquire()
+  {
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+    return this;
+  }
+
+  /** Drop a reference, freeing the storage with the last one. */
+  void Release()
+  {
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        const auto size = sizeof(SharedPayload) + m_bytes;
+        this->~SharedPayload();
+        EventPool::Free(this, size);
+      }
+  }
+
+  /** @returns The payload bytes. */
+  char * data()
+  {
+    return reinterpret_cast<char *>(this + 1);
+  }
+
+  /** @returns The capacity, in bytes. */
+  std::size_t size() const
+  {
+    return m_bytes;
+  }
+
+private:
+  /**
+   * C'tor, only through Make().
+   * @param bytes The capacity.
+   */
+  explicit SharedPayload(std::size_t bytes)
+    : m_refs{1},
+      m_bytes{bytes}
+  {}
+
+  std::atomic<uint32_t> m_refs;   /**< Reference count. */
+  std::size_t           m_bytes;  /**< Capacity. */
+
+};  // class SharedPayload
+
+
 /**
  * Event sent by PHOLD LPs during simulation,
- * just containing the send time, for debugging.
+ * containing the sender id and the send time.
+ *
+ * Events and their payloads are allocated from the per-thread EventPool,
+ * or reference a SharedPayload.  PholdEvent itself has no inline
+ * storage, so events without a payload stay small; use Make() to get
+ * an InlineEvent for small payloads.
  */
 class PholdEvent : public SST::Event
 {
 public:
+  /** Capacity of the InlineEvent payload buffer. */
+  static constexpr std::size_t INLINE_BYTES {PHOLD_INLINE_BYTES};
+
   /**
    * C'tor.
+   * @param src The sending LP id.
    * @param sendTime The simulation time when the event was sent.
    * @param bytes The number of additional data bytes to include
    *        as payload in the event.
    */
-  explicit
-    PholdEvent(SST::SimTime_t sendTime, std::size_t bytes = 0)
+  PholdEvent(SST::ComponentId_t src, SST::SimTime_t sendTime, std::size_t bytes = 0)
     : SST::Event(),
+      m_src{src},
       m_sendTime{sendTime},
       m_bytes{bytes},
-      m_buffer{nullptr}
+      m_buffer{nullptr},
+      m_shared{nullptr}
   {
-    if (m_bytes > 0) m_buffer = new char[m_bytes];
+    AllocateBuffer();
+  };
+
+  /**
+   * C'tor referencing a shared payload, if it doesn't fit inline.
+   * @param src The sending LP id.
+   * @param sendTime The simulation time when the event was sent.
+   * @param bytes The payload size, at most the size of @c shared.
+   * @param shared The shared payload, or \c nullptr to allocate as usual.
+   */
+  PholdEvent(SST::ComponentId_t src, SST::SimTime_t sendTime, std::size_t bytes,
+             SharedPayload * shared)
+    : SST::Event(),
+      m_src{src},
+      m_sendTime{sendTime},
+      m_bytes{bytes},
+      m_buffer{nullptr},
+      m_shared{nullptr}
+  {
+    if (shared && bytes > INLINE_BYTES)
+      {
+        m_shared = shared->Acquire();
+        m_buffer = m_shared->data();
+      }
+    else
+      {
+        AllocateBuffer();
+      }
   };
 
   ~PholdEvent()
     {
-      delete [] m_buffer;
+      FreeBuffer();
     };
 
+  /**
+   * Make an event, with the payload inline if it fits.
+   * @param src The sending LP id.
+   * @param sendTime The simulation time when the event was sent.
+   * @param bytes The payload size.
+   * @param shared A shared payload for large payloads, or \c nullptr.
+   * @returns An InlineEvent for payloads up to INLINE_BYTES,
+   *          otherwise a PholdEvent.
+   */
+  static PholdEvent * Make(SST::ComponentId_t src, SST::SimTime_t sendTime,
+                           std::size_t bytes, SharedPayload * shared = nullptr);
+
+  /**
+   * Allocate events from the EventPool.
+   * @param size The size of the event.
+   * @returns The storage for the event.
+   */
+  static void * operator new(std::size_t size)
+  {
+    return EventPool::Allocate(size);
+  }
+  /**
+   * Return events to the EventPool.
+   * @param p The event storage.
+   * @param size The size of the event.
+   */
+  static void operator delete(void * p, std::size_t size)
+  {
+    EventPool::Free(p, size);
+  }
+
   // Rule of 5
   PholdEvent(const PholdEvent &) = delete;
   PholdEvent & operator= (const PholdEvent &) = delete;
@@ -56,8 +217,17 @@ public:
   PholdEvent & operator= (const PholdEvent &&) = delete;
   
 
-  // Basic PHOLD has no event data to send
-  // \todo Consider adding src tracking, QHOLD hash...
+  // Basic PHOLD has no event data to send;
+  // the payload is only filled and hashed with the Work hash kernel
+
+  /**
+   * Get the sender id, so a single handler can serve all links.
+   * @returns The sending LP id.
+   */
+  SST::ComponentId_t getSrcId() const
+  {
+    return m_src;
+  };
 
   /**
    * Extract the send time from the event.
@@ -77,22 +247,53 @@ public:
       return m_bytes;
     }
 
+  /**
+   * Get the payload.
+   * @returns The event data buffer, \c nullptr if empty.
+   */
+  char * getBuffer()
+    {
+      return m_buffer;
+    }
+
+  /** @copydoc getBuffer() */
+  const char * getBuffer() const
+    {
+      return m_buffer;
+    }
+
+  /** @returns \c true if the payload is a SharedPayload. */
+  bool isShared() const
+    {
+      return m_shared != nullptr;
+    }
+
   /** Default c'tor, for serialization. */
   PholdEvent()
     : SST::Event(),
+    m_src(0),
     m_sendTime(0),
     m_bytes(0),
-    m_buffer{nullptr}
+    m_buffer{nullptr},
+    m_shared{nullptr}
   {};
 
   // Inherited
   void
   serialize_order(SST::Core::Serialization::serializer & ser) override
   {
+    // A shared payload is packed like any other, and unpacks into our own storage
     Event::serialize_order(ser);
+    ser & m_src;
     ser & m_sendTime;
-    // Serializes m_bytes then m_buffer
-    ser.binary(m_buffer, m_bytes);
+    // Serialize m_bytes then m_buffer.
+    // Not ser.binary(), since that unpacks into new char[]
+    ser & m_bytes;
+    if (ser.mode() == SST::Core::Serialization::serializer::UNPACK)
+      {
+        AllocateBuffer();
+      }
+    if (m_bytes > 0) ser.raw(m_buffer, m_bytes);
   };
 
   /*
@@ -103,19 +304,266 @@ public:
   */
   ImplementSerializable(Phold::PholdEvent);
 
+protected:
+
+  /**
+   * Get the inline payload storage, if this event type has any.
+   * Not used during construction, so subclasses set their payload
+   * with Resize() from their own c'tor.
+   * @returns The storage, of INLINE_BYTES, or \c nullptr.
+   */
+  virtual char * InlineBuffer()
+  {
+    return nullptr;
+  }
+
+  /** Point m_buffer at inline storage if it fits, otherwise the EventPool. */
+  void AllocateBuffer()
+  {
+    char * storage = m_bytes <= INLINE_BYTES ? InlineBuffer() : nullptr;
+    if (m_bytes == 0)
+      m_buffer = nullptr;
+    else if (storage)
+      m_buffer = storage;
+    else
+      m_buffer = static_cast<char *>(EventPool::Allocate(m_bytes));
+  }
+
+  /**
+   * Set the payload size of an event constructed without one.
+   * @param bytes The payload size.
+   */
+  void Resize(std::size_t bytes)
+  {
+    m_bytes = bytes;
+    AllocateBuffer();
+  }
+
+  /**
+   * Forget m_buffer if it's inline, so FreeBuffer() leaves it alone.
+   * Called from the subclass d'tor, before the storage goes away.
+   */
+  void ForgetInline()
+  {
+    if (m_buffer && m_buffer == InlineBuffer()) m_buffer = nullptr;
+  }
+
 private:
 
+  /** Return m_buffer to the EventPool, or release m_shared. */
+  void FreeBuffer()
+  {
+    if (m_shared)
+      {
+        m_shared->Release();
+        m_shared = nullptr;
+      }
+    else if (m_buffer)
+      {
+        EventPool::Free(m_buffer, m_bytes);
+      }
+    m_buffer = nullptr;
+  }
+
+  /** Sender id. */
+  SST::ComponentId_t m_src;
+
   /** Send time of this event. */
   SST::SimTime_t m_sendTime;
 
   /** Byte buffer size. */
   std::size_t m_bytes;
-  /** Bytes buffer. */
+  /** Bytes buffer, either inline, from the EventPool, or in m_shared. */
   char * m_buffer;
+  /** Shared payload, if we reference one. */
+  SharedPayload * m_shared;
 
 };  // class PholdEvent
 
 
+/**
+ * PholdEvent with inline storage for payloads up to INLINE_BYTES,
+ * so they don't need a separate allocation.
+ * Only used for small payloads; see PholdEvent::Make().
+ */
+class InlineEvent : public PholdEvent
+{
+public:
+  /**
+   * C'tor.
+   * @param src The sending LP id.
+   * @param sendTime The simulation time when the event was sent.
+   * @param bytes The payload size, at most INLINE_BYTES.
+   */
+  InlineEvent(SST::ComponentId_t src, SST::SimTime_t sendTime, std::size_t bytes)
+    : PholdEvent(src, sendTime)
+  {
+    Resize(bytes);
+  };
+
+  ~InlineEvent()
+    {
+      ForgetInline();
+    };
+
+  /** Default c'tor, for serialization. */
+  InlineEvent()
+    : PholdEvent()
+  {};
+
+  ImplementSerializable(Phold::InlineEvent);
+
+protected:
+
+  /** @copydoc PholdEvent::InlineBuffer() */
+  char * InlineBuffer() override
+  {
+    return m_inline.data();
+  }
+
+private:
+
+  /** Inline storage for small payloads. */
+  std::array<char, INLINE_BYTES> m_inline;
+
+};  // class InlineEvent
+
+
+inline PholdEvent *
+PholdEvent::Make(SST::ComponentId_t src, SST::SimTime_t sendTime,
+                 std::size_t bytes, SharedPayload * shared /* = nullptr */)
+{
+  if (0 < bytes && bytes <= INLINE_BYTES) return new InlineEvent(src, sendTime, bytes);
+  return new PholdEvent(src, sendTime, bytes, shared);
+}
+
+
+/**
+ * Event sent between PholdBlock components,
+ * adding the destination LP id within the receiving block.
+ */
+class BlockEvent : public PholdEvent
+{
+public:
+  /**
+   * C'tor.
+   * @param src The sending LP id.
+   * @param dst The destination LP id.
+   * @param sendTime The simulation time when the event was sent.
+   * @param bytes The number of additional data bytes to include
+   *        as payload in the event.
+   */
+  BlockEvent(SST::ComponentId_t src, SST::ComponentId_t dst,
+             SST::SimTime_t sendTime, std::size_t bytes = 0)
+    : PholdEvent(src, sendTime, bytes),
+      m_dst{dst}
+  {};
+
+  /**
+   * Get the destination LP id.
+   * @returns The destination LP id.
+   */
+  SST::ComponentId_t getDstId() const
+  {
+    return m_dst;
+  };
+
+  /** Default c'tor, for serialization. */
+  BlockEvent()
+    : PholdEvent(),
+    m_dst(0)
+  {};
+
+  // Inherited
+  void
+  serialize_order(SST::Core::Serialization::serializer & ser) override
+  {
+    PholdEvent::serialize_order(ser);
+    ser & m_dst;
+  };
+
+  ImplementSerializable(Phold::BlockEvent);
+
+private:
+
+  /** Destination LP id. */
+  SST::ComponentId_t m_dst;
+
+};  // class BlockEvent
+
+
+/**
+ * Batch of events between a pair of PholdBlocks,
+ * coalesced to reduce per-message overhead.
+ *
+ * The batch is sent with zero additional delay over the link, so it arrives
+ * after the link minimum latency.  Each entry carries its own delivery time,
+ * which is never earlier than the batch arrival.
+ * The payload is the combined size of all the entries' payloads.
+ */
+class PholdBatchEvent : public PholdEvent
+{
+public:
+  /** One coalesced event. */
+  struct Entry
+  {
+    SST::SimTime_t     time;  /**< Delivery time at the destination LP. */
+    SST::ComponentId_t src;   /**< Sending LP. */
+    SST::ComponentId_t dst;   /**< Destination LP. */
+  };
+
+  /**
+   * C'tor.
+   * @param src The sending block id.
+   * @param sendTime The simulation time when the batch was sent.
+   * @param entries The events, which are moved from.
+   * @param bytes The total payload size of all the entries.
+   */
+  PholdBatchEvent(SST::ComponentId_t src, SST::SimTime_t sendTime,
+                  std::vector<Entry> & entries, std::size_t bytes = 0)
+    : PholdEvent(src, sendTime, bytes),
+      m_entries{std::move(entries)}
+  {};
+
+  /**
+   * Get the entries.
+   * @returns The events in this batch.
+   */
+  const std::vector<Entry> & getEntries() const
+  {
+    return m_entries;
+  };
+
+  /** Default c'tor, for serialization. */
+  PholdBatchEvent()
+    : PholdEvent(),
+    m_entries{}
+  {};
+
+  // Inherited
+  void
+  serialize_order(SST::Core::Serialization::serializer & ser) override
+  {
+    PholdEvent::serialize_order(ser);
+    std::size_t count = m_entries.size();
+    ser & count;
+    if (ser.mode() == SST::Core::Serialization::serializer::UNPACK)
+      {
+        m_entries.resize(count);
+      }
+    if (count > 0) ser.raw(m_entries.data(), count * sizeof(Entry));
+  };
+
+  ImplementSerializable(Phold::PholdBatchEvent);
+
+private:
+
+  /** The coalesced events. */
+  std::vector<Entry> m_entries;
+
+};  // class PholdBatchEvent
+
+
 /**
  * Event sent by PHOLD LPs during initialization,
  * containing the sender id.
@@ -170,19 +618,169 @@ private:
 /**
  * Event sent by PHOLD LPs during completion,
  * containing the total number of events sent and received
- * by the LP sending this event, and all it's children.
+ * by the LP sending this event, and all it's children,
+ * together with the LP load and rank event rate extremes.
  */
 class CompleteEvent : public SST::Event
 {
 public:
+
+  /** The quantities reduced in complete(). */
+  struct Totals
+  {
+    uint64_t sends    {0};  /**< Events sent. */
+    uint64_t recvs    {0};  /**< Events received. */
+    uint64_t lps      {0};  /**< Number of LPs. */
+    /** Receives in the second half of the measured run, for the steady state check. */
+    uint64_t late     {0};
+    uint64_t ticks    {0};  /**< Load clock ticks. */
+    /**
+     * Sum of the hashes of (src, dst, send time, receive time) of every
+     * counted event, taken when sent.  The sum doesn't depend on the order
+     * LPs and ranks are added, so it only depends on the events themselves.
+     * A lost or duplicated delivery changes the events the receiver sends,
+     * and so the checksum, as does a reordering which changes any event.
+     */
+    uint64_t checksum {0};
+    /**
+     * The same sum as checksum, taken when each event is received.
+     * It equals checksum only if every counted event was delivered once,
+     * to the LP and at the time it was sent for.
+     */
+    uint64_t recvChecksum {0};
+    /** Fewest events received by one LP. */
+    uint64_t minLoad  {std::numeric_limits<uint64_t>::max()};
+    uint64_t maxLoad  {0};  /**< Most events received by one LP. */
+    uint64_t ranks    {0};  /**< Number of ranks reporting a rate. */
+    /** Slowest rank event rate, events per wall clock second. */
+    double   minRate  {std::numeric_limits<double>::max()};
+    double   maxRate  {0};  /**< Fastest rank event rate. */
+    double   sumRate  {0};  /**< Sum of rank event rates. */
+    double   wall     {0};  /**< Longest rank wall clock run time, s. */
+    /** Per LP object sizes, summed over LPs. */
+    Memory::Footprint footprint;
+    uint64_t memRanks {0};  /**< Number of ranks reporting memory. */
+    /** Largest rank peak RSS, by phase, bytes. */
+    std::array<uint64_t, Memory::PHASES> peakMax {};
+    /** Sum of rank peak RSS, by phase, bytes. */
+    std::array<uint64_t, Memory::PHASES> peakSum {};
+    /** RSS growth during construction, summed over ranks, bytes. */
+    uint64_t ctorGrowth {0};
+    /** Event bytes allocated and not freed at the end of the run, summed over ranks. */
+    uint64_t inFlight {0};
+    /** Smallest latency of any link to a neighbor, TIMEBASE units. */
+    uint64_t minLatency {std::numeric_limits<uint64_t>::max()};
+    uint64_t sumLatency {0};  /**< Sum of the neighbor link latencies. */
+    uint64_t links      {0};  /**< Number of neighbor links. */
+    /** PholdBlock sends kept in the sending block's local queue. */
+    uint64_t localSends {0};
+    uint64_t batches    {0};  /**< PholdBlock batches sent. */
+    uint64_t batched    {0};  /**< PholdBlock events sent in batches. */
+
+    /**
+     * Add one LP.
+     * @param lpSends The LP send count.
+     * @param lpRecvs The LP receive count.
+     * @param lpLate The LP receives in the second half of the run.
+     */
+    void AddLp(uint64_t lpSends, uint64_t lpRecvs, uint64_t lpLate = 0)
+    {
+      sends += lpSends;
+      recvs += lpRecvs;
+      late  += lpLate;
+      ++lps;
+      minLoad = std::min(minLoad, lpRecvs);
+      maxLoad = std::max(maxLoad, lpRecvs);
+    }
+
+    /**
+     * Add the neighbor link latencies of one LP.
+     * @param lpMin The smallest link latency.
+     * @param lpSum The sum of the link latencies.
+     * @param lpLinks The number of links.
+     */
+    void AddLinks(uint64_t lpMin, uint64_t lpSum, uint64_t lpLinks)
+    {
+      minLatency = std::min(minLatency, lpMin);
+      sumLatency += lpSum;
+      links += lpLinks;
+    }
+
+    /**
+     * Add the memory of one rank.
+     * @param rankInFlight The event bytes in flight on this rank.
+     */
+    void AddMemory(uint64_t rankInFlight)
+    {
+      ++memRanks;
+      for (std::size_t p = 0; p < Memory::PHASES; ++p)
+        {
+          const auto peak = Memory::Get(static_cast<Memory::Phase>(p)).peak;
+          peakMax[p] = std::max(peakMax[p], peak);
+          peakSum[p] += peak;
+        }
+      const auto before = Memory::Get(Memory::START).resident;
+      const auto after = Memory::Get(Memory::CONSTRUCTION).resident;
+      ctorGrowth += after > before ? after - before : 0;
+      inFlight += rankInFlight;
+    }
+
+    /**
+     * Add one rank event rate.
+     * @param rate The rank event rate.
+     */
+    void AddRate(double rate)
+    {
+      ++ranks;
+      minRate = std::min(minRate, rate);
+      maxRate = std::max(maxRate, rate);
+      sumRate += rate;
+    }
+
+    /**
+     * Combine with the totals from another subtree.
+     * @param other The other totals.
+     */
+    void Merge(const Totals & other)
+    {
+      sends  += other.sends;
+      recvs  += other.recvs;
+      lps    += other.lps;
+      late   += other.late;
+      ticks  += other.ticks;
+      checksum += other.checksum;
+      recvChecksum += other.recvChecksum;
+      minLoad = std::min(minLoad, other.minLoad);
+      maxLoad = std::max(maxLoad, other.maxLoad);
+      ranks  += other.ranks;
+      minRate = std::min(minRate, other.minRate);
+      maxRate = std::max(maxRate, other.maxRate);
+      sumRate += other.sumRate;
+      wall    = std::max(wall, other.wall);
+      footprint += other.footprint;
+      memRanks += other.memRanks;
+      for (std::size_t p = 0; p < Memory::PHASES; ++p)
+        {
+          peakMax[p] = std::max(peakMax[p], other.peakMax[p]);
+          peakSum[p] += other.peakSum[p];
+        }
+      ctorGrowth += other.ctorGrowth;
+      inFlight += other.inFlight;
+      minLatency = std::min(minLatency, other.minLatency);
+      sumLatency += other.sumLatency;
+      links += other.links;
+      localSends += other.localSends;
+      batches += other.batches;
+      batched += other.batched;
+    }
+  };
+
   /**
    * C'tor
-   * @param sendCount The total number of events sent.
-   * @param recvCount The total number of events received.
+   * @param totals The totals for the sender and its children.
    */
-  CompleteEvent(std::size_t sendCount, std::size_t recvCount)
-    : m_sendCount(sendCount),
-    m_recvCount(recvCount)
+  explicit CompleteEvent(const Totals & totals)
+    : m_totals(totals)
   {};
 
   /**
@@ -191,7 +789,7 @@ public:
    */
   std::size_t getSendCount() const
   {
-    return m_sendCount;
+    return m_totals.sends;
   };
 
   /**
@@ -200,14 +798,22 @@ public:
    */
   std::size_t getRecvCount() const
   {
-    return m_recvCount;
+    return m_totals.recvs;
+  };
+
+  /**
+   * Get all the totals from the event.
+   * @returns The totals.
+   */
+  const Totals & getTotals() const
+  {
+    return m_totals;
   };
 
   /** Default c'tor, for serialization. */
   CompleteEvent()
    : SST::Event(),
-    m_sendCount(0),
-    m_recvCount(0)
+    m_totals()
   {};
 
   // Inherited
@@ -215,16 +821,42 @@ public:
   serialize_order(SST::Core::Serialization::serializer & ser) override
   {
     Event::serialize_order(ser);
-    ser & m_sendCount;
-    ser & m_recvCount;
+    ser & m_totals.sends;
+    ser & m_totals.recvs;
+    ser & m_totals.lps;
+    ser & m_totals.late;
+    ser & m_totals.ticks;
+    ser & m_totals.checksum;
+    ser & m_totals.recvChecksum;
+    ser & m_totals.minLoad;
+    ser & m_totals.maxLoad;
+    ser & m_totals.ranks;
+    ser & m_totals.minRate;
+    ser & m_totals.maxRate;
+    ser & m_totals.sumRate;
+    ser & m_totals.wall;
+    ser & m_totals.footprint.links;
+    ser & m_totals.footprint.handlers;
+    ser & m_totals.footprint.rng;
+    ser & m_totals.footprint.stats;
+    ser & m_totals.memRanks;
+    for (auto & peak : m_totals.peakMax) ser & peak;
+    for (auto & peak : m_totals.peakSum) ser & peak;
+    ser & m_totals.ctorGrowth;
+    ser & m_totals.inFlight;
+    ser & m_totals.minLatency;
+    ser & m_totals.sumLatency;
+    ser & m_totals.links;
+    ser & m_totals.localSends;
+    ser & m_totals.batches;
+    ser & m_totals.batched;
   };
 
   ImplementSerializable(Phold::CompleteEvent);
 
 private:
 
-  std::size_t m_sendCount;  /** The send count. */
-  std::size_t m_recvCount;  /** The receive count. */
+  Totals m_totals;  /** The totals. */
 
 };  // class CompleteEvent
 
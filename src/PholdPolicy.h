@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include "SamplingPolicy.h"
+
+#include <sst/core/rng/mersenne.h>
+#include <sst/core/rng/xorshift.h>
+
+#include <cmath>    // log()
+#include <cstdint>
+
+/**
+ * \file
+ * Phold::PholdT sampling policies.
+ *
+ * A Phold::PholdT is specialized by three policies:
+ *
+ * Policy      | Models                                | Provides
+ * ----------- | ------------------------------------- | --------------------------------
+ * Rng         | SstRng, PhiloxRng                     | `nextUniform()`, `nextExponential()`
+ * Destination | RandomDestination, BoundedDestination, | `IsRemote()`, `Any()`, `Neighbor()`
+ *             | FixedDestination                      |
+ * Delay       | ExponentialDelay, ZigguratDelay,      | `Draw()`
+ *             | FixedDelay                            |
+ *
+ * Every policy also has a `Name()`, for the configuration report.
+ * Policies are used through their concrete type, so all these calls
+ * are inlined into Phold::SendEventT().
+ *
+ * Only SstRng is defined here, since it needs the SST generators;
+ * the others are in SamplingPolicy.h.
+ */
+
+namespace Phold {
+
+/**
+ * Rng policy using an SST generator, held by value.
+ *
+ * Holding the generator by value, rather than through an
+ * SST::RNG::Random pointer, lets the compiler devirtualize
+ * `nextUniform()`.  The exponential is computed inline as in
+ * SST::RNG::SSTExponentialDistribution.
+ *
+ * @tparam R The SST generator type.
+ */
+template <class R>
+class SstRng
+{
+public:
+  /**
+   * Constructor.
+   * @param seed Global seed, unused; SST generators are seeded by LP id.
+   * @param id   LP id.
+   * @param mean Mean of the exponential deviates.
+   */
+  SstRng(uint32_t /* seed */, uint64_t id, double mean)
+    : m_rng(static_cast<unsigned int>(1 + id)),  // can't be 0
+      m_mean(mean)
+  {
+  }
+
+  /** @returns The next uniform deviate. */
+  double nextUniform()
+  {
+    return m_rng.nextUniform();
+  }
+
+  /** @returns The next exponential deviate. */
+  double nextExponential()
+  {
+    return -std::log(m_rng.nextUniform()) * m_mean;
+  }
+
+  /** @returns The policy name. */
+  static const char * Name();
+
+private:
+  R      m_rng;   /**< The generator. */
+  double m_mean;  /**< Exponential mean. */
+
+};  // class SstRng
+
+/** @copydoc SstRng::Name() */
+template <>
+inline const char * SstRng<SST::RNG::XORShiftRNG>::Name() { return "xorshift"; }
+/** @copydoc SstRng::Name() */
+template <>
+inline const char * SstRng<SST::RNG::MersenneRNG>::Name() { return "mersenne"; }
+
+}  // namespace Phold
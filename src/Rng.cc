@@ -9,12 +9,19 @@
 
 #include "Rng.h"
 #include "RngEvent.h"
+#include "PholdPolicy.h"
 
 #include <sst/core/timeConverter.h>
 #include <sst/core/sst_types.h>
 
+#include <atomic>
+#include <chrono>
+#include <cmath>    // log()
 #include <cstdint>  // UINT32_MAX
+#include <iomanip>  // setw()
 #include <iostream>
+#include <memory>   // unique_ptr
+#include <sstream>
 #include <string>  // to_string()
 #include <utility> // swap()
 
@@ -47,7 +54,88 @@ namespace Phold {
 constexpr char Rng::PORT_NAME[];  // constexpr initialized in Rng.h
 uint32_t       Rng::m_number;
 uint64_t       Rng::m_samples;
+uint32_t       Rng::m_bins;
+double         Rng::m_mean;
 uint32_t       Rng::m_verbose;
+Rng::RankShare Rng::m_rankShare;
+
+
+namespace {
+
+/** Generator names, by Rng::Generator. */
+const char * GENERATOR_NAMES[] = { "mersenne", "marsaglia", "xorshift", "philox" };
+
+/** Sampler names, by Rng::Sampler. */
+const char * SAMPLER_NAMES[] =
+  { "uniform", "virtual", "sst-exp", "exp", "ziggurat", "sst-int", "scaled", "bounded" };
+
+/** @returns The current steady_clock time, in ns. */
+int64_t
+SteadyNanos()
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Time a sampler.
+ * @param samples The number of samples.
+ * @param [in,out] sink Accumulates the sum of the samples.
+ * @param draw Returns the next sample.
+ * @returns The time per sample, in ns.
+ */
+template <class Draw>
+double
+Time(uint64_t samples, double & sink, Draw draw)
+{
+  const auto start = SteadyNanos();
+  double sum = 0;
+  for (uint64_t i = 0; i < samples; ++i) sum += draw();
+  const auto end = SteadyNanos();
+  sink += sum;
+  return double(end - start) / samples;
+}
+
+/**
+ * Rng policy holding any SST generator by value, like Phold::SstRng,
+ * for generators without a single seed c'tor.
+ * @tparam R The SST generator type.
+ */
+template <class R>
+class ByValue
+{
+public:
+  /**
+   * Constructor.
+   * @param mean Mean of the exponential deviates.
+   * @param seeds The generator c'tor arguments.
+   */
+  template <class... Seeds>
+  explicit ByValue(double mean, Seeds... seeds)
+    : m_rng(seeds...),
+      m_mean(mean)
+  {
+  }
+
+  /** @copydoc Phold::SstRng::nextUniform() */
+  double nextUniform()
+  {
+    return m_rng.nextUniform();
+  }
+
+  /** @copydoc Phold::SstRng::nextExponential() */
+  double nextExponential()
+  {
+    return -std::log(m_rng.nextUniform()) * m_mean;
+  }
+
+private:
+  R      m_rng;   /**< The generator. */
+  double m_mean;  /**< Exponential mean. */
+
+};  // class ByValue
+
+}  // anonymous namespace
 
 
 Rng::Rng( SST::ComponentId_t id, SST::Params& params )
@@ -63,18 +151,27 @@ Rng::Rng( SST::ComponentId_t id, SST::Params& params )
 #endif
   
   m_number  = params.find<long>   ("number",   2);
-  m_samples = params.find<long>   ("samples",   1);
+  m_samples = params.find<long>   ("samples",   1000000);
+  m_bins    = params.find<long>   ("bins",      1000);
+  m_mean    = params.find<double> ("mean",      1.0);
+
+  if (0 == m_samples || 0 == m_bins)
+    {
+      m_output.fatal(CALL_INFO, 1, "samples and bins must be > 0\n");
+    }
 
   registerTimeBase("1 us", true);
 
   if (0 == getId()) {
     std::stringstream ss;
-    double totalSamples = m_number * m_samples;
+    double totalSamples = double(m_number) * m_samples * GENERATORS * SAMPLERS;
 
     ss << "\nRng Configuration:"
        << "\n    Number of components:             " << m_number
        << "\n    Number of samples per component:  " << m_samples
        << "\n    Total rng samples:                " << totalSamples
+       << "\n    Values for integer samplers:      " << m_bins
+       << "\n    Mean of exponential samplers:     " << m_mean
        << "\n    Verbosity level:                  " << m_verbose
        << "\n    Optimization level:               "
 #ifdef RNG_DEBUG
@@ -87,16 +184,12 @@ Rng::Rng( SST::ComponentId_t id, SST::Params& params )
     OUTPUT("%s\n", ss.str().c_str());
   }
 
-  VERBOSE(3, "%s", "Initializing RNGs\n");
-  m_rng  = new Rng::RNG_t;
-  // seed() doesn't check validity of arg, can't be 0
-  m_rng->seed(1 + getId());
-  VERBOSE(4, "  m_rng      @0x%p\n", (void*)m_rng);
+  for (auto & row : m_results) row.fill(-1);
 
   // Configure ports/links
   VERBOSE(3, "%s", "Configuring links:\n");
 
-  auto linkup = [this](std::string port, uint32_t id) -> void
+  auto linkup = [this](std::string port, uint32_t id) -> SST::Link *
     {
       ASSERT(isPortConnected(port),
              "%s is not connected\n", port.c_str());
@@ -113,6 +206,7 @@ Rng::Rng( SST::ComponentId_t id, SST::Params& params )
       ASSERT(link, "Failed to configure %s link", port.c_str());
       VERBOSE(4, "    %s link @%p with handler @%p\n",
               port.c_str(), (void*)link, (void*)handler);
+      return link;
     };
 
   uint32_t left  = (getId() > 0 ? getId() : m_number) - 1;
@@ -120,7 +214,7 @@ Rng::Rng( SST::ComponentId_t id, SST::Params& params )
 
   linkup("portL", left);
   linkup("portR", right);
-  linkup("self", getId());
+  m_self = linkup("self", getId());
 
   // Register statistics
 
@@ -137,24 +231,16 @@ Rng::Rng() : SST::Component(-1)
   VERBOSE(2, "%s", "Default c'tor()\n");
   /*
    * \todo How to initialize a Component after deserialization?
-   * Here we need m_number, m_average
+   * Here we need m_number, m_samples
    * These are class static, so available in this case,
    * but what to do in the general case of instance data?
    */
-  m_rng  = new Rng::RNG_t;
 }
 
 
 Rng::~Rng() noexcept
 {
   VERBOSE(2, "%s", "Destructor()\n");
-#define DELETE(p) \
-  VERBOSE(4, "  deleting %s @0x%p\n", #p, (void*)(p));  \
-  p = 0
-
-  DELETE(m_rng);
-
-#undef DELETE
 }
 
 
@@ -162,22 +248,240 @@ void
 Rng::handleEvent(SST::Event *ev, uint32_t from [[maybe_unused]])
 {
   auto event = dynamic_cast<RngEvent*>(ev);
-  ASSERT(event, "Failed to cast SST::Event * to PholdEvent *");
-  // Extract any useful data, then clean it up
-  delete event;
+  ASSERT(event, "Failed to cast SST::Event * to RngEvent *");
 
-  // Do the iterations
-  double sum = 0;
-  for (decltype(m_samples) i = 0; i < m_samples; ++i)
+  TimeGenerator(static_cast<Generator>(m_next++));
+
+  if (m_next < GENERATORS)
     {
-      sum += m_rng->nextUniform();
+      // Next generator in the next synchronization window
+      VERBOSE(3, "scheduling generator %s\n", GENERATOR_NAMES[m_next]);
+      m_self->send(1000, event);
+      return;
     }
+  delete event;
 
-  // Check the stopping condition
+  Contribute();
   primaryComponentOKToEndSim();
 }
 
 
+void
+Rng::TimeGenerator(Generator gen)
+{
+  VERBOSE(2, "timing %s\n", GENERATOR_NAMES[gen]);
+  switch (gen)
+    {
+    case MERSENNE:
+      TimeGeneratorT<SstRng<SST::RNG::MersenneRNG>, SST::RNG::MersenneRNG>(gen);
+      break;
+    case MARSAGLIA:
+      TimeGeneratorT<ByValue<SST::RNG::MarsagliaRNG>, SST::RNG::MarsagliaRNG>(gen);
+      break;
+    case XORSHIFT:
+      TimeGeneratorT<SstRng<SST::RNG::XORShiftRNG>, SST::RNG::XORShiftRNG>(gen);
+      break;
+    case PHILOX:
+      TimeGeneratorT<PhiloxRng, void>(gen);
+      break;
+    case GENERATORS:
+    default:
+      ASSERT(false, "invalid generator %zu\n", std::size_t(gen));
+      break;
+    }
+}
+
+
+namespace {
+
+/**
+ * Make an Rng policy.
+ * @tparam Policy The policy type.
+ * @param id The component id.
+ * @param mean The exponential mean.
+ * @returns The policy.
+ */
+template <class Policy>
+Policy
+MakePolicy(uint64_t id, double mean)
+{
+  return Policy(1, id, mean);
+}
+
+/** @copydoc MakePolicy() */
+template <>
+ByValue<SST::RNG::MarsagliaRNG>
+MakePolicy<ByValue<SST::RNG::MarsagliaRNG>>(uint64_t id, double mean)
+{
+  // Neither seed can be 0
+  return ByValue<SST::RNG::MarsagliaRNG>(mean, static_cast<unsigned int>(1 + id), 362436069u);
+}
+
+/**
+ * Make an SST generator, for the virtual samplers.
+ * @tparam R The generator type, or \c void for none.
+ * @param id The component id.
+ * @returns The generator.
+ */
+template <class R>
+std::unique_ptr<SST::RNG::Random>
+MakeRandom(uint64_t id)
+{
+  return std::unique_ptr<SST::RNG::Random>(new R(static_cast<unsigned int>(1 + id)));
+}
+
+/** @copydoc MakeRandom() */
+template <>
+std::unique_ptr<SST::RNG::Random>
+MakeRandom<SST::RNG::MarsagliaRNG>(uint64_t id)
+{
+  return std::unique_ptr<SST::RNG::Random>
+    (new SST::RNG::MarsagliaRNG(static_cast<unsigned int>(1 + id), 362436069u));
+}
+
+/** @copydoc MakeRandom() */
+template <>
+std::unique_ptr<SST::RNG::Random>
+MakeRandom<void>(uint64_t /* id */)
+{
+  return {};
+}
+
+}  // anonymous namespace
+
+
+template <class Policy, class R>
+void
+Rng::TimeGeneratorT(Generator gen)
+{
+  auto & row = m_results[gen];
+  const uint64_t n = m_bins;
+
+  // By value, as the Phold Rng policies
+  auto rng = MakePolicy<Policy>(getId(), m_mean);
+  row[UNIFORM]     = Time(m_samples, m_sink, [&rng]() { return rng.nextUniform(); });
+  row[EXPONENTIAL] = Time(m_samples, m_sink, [&rng]() { return rng.nextExponential(); });
+  row[ZIGGURAT]    = Time(m_samples, m_sink,
+                          [&rng]() { return Ziggurat::Exponential(rng) * m_mean; });
+  row[SCALED]      = Time(m_samples, m_sink,
+                          [&rng, n]() { return double(RandomDestination::Neighbor(rng, n, 0)); });
+  row[BOUNDED]     = Time(m_samples, m_sink,
+                          [&rng, n]() { return double(BoundedInt(rng, n)); });
+
+  // Through the SST interfaces, with virtual calls
+  auto base = MakeRandom<R>(getId());
+  if ( ! base) return;
+  SST::RNG::Random * random = base.get();
+  row[VIRTUAL]     = Time(m_samples, m_sink, [random]() { return random->nextUniform(); });
+
+  // SST rate is 1 / mean
+  SST::RNG::SSTExponentialDistribution exp(1 / m_mean, random);
+  SST::RNG::RandomDistribution * dist = &exp;
+  row[SST_EXP]     = Time(m_samples, m_sink, [dist]() { return dist->getNextDouble(); });
+
+  SST::RNG::SSTUniformDistribution uni(m_bins, random);
+  dist = &uni;
+  row[SST_INT]     = Time(m_samples, m_sink, [dist]() { return dist->getNextDouble(); });
+}
+
+
+void
+Rng::Contribute()
+{
+  const auto thread = getRank().thread;
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  if (m_rankShare.threadSums.size() <= thread)
+    {
+      Results zero;
+      for (auto & row : zero) row.fill(0);
+      m_rankShare.threadSums.resize(thread + 1, zero);
+      m_rankShare.threadLps.resize(thread + 1, 0);
+    }
+  auto & sums = m_rankShare.threadSums[thread];
+  for (std::size_t g = 0; g < GENERATORS; ++g)
+    {
+      for (std::size_t s = 0; s < SAMPLERS; ++s) sums[g][s] += m_results[g][s];
+    }
+  ++m_rankShare.threadLps[thread];
+  VERBOSE(2, "sink %g\n", m_sink);
+
+}  // Contribute()
+
+
+void
+Rng::ShowResults() const
+{
+  // Only once per rank, after all components have contributed
+  static std::atomic<bool> shown {false};
+  if (shown.exchange(true)) return;
+
+  std::lock_guard<std::mutex> lock(m_rankShare.mutex);
+  const auto & sums = m_rankShare.threadSums;
+  const auto & lps = m_rankShare.threadLps;
+
+  // Results divided by count
+  auto table = [](std::stringstream & ss, const Results & res, double count)
+    {
+      ss << "\n      " << std::left << std::setw(10) << "Generator" << std::right;
+      for (auto name : SAMPLER_NAMES) ss << std::setw(10) << name;
+      ss << std::fixed << std::setprecision(2);
+      for (std::size_t g = 0; g < GENERATORS; ++g)
+        {
+          ss << "\n      " << std::left << std::setw(10) << GENERATOR_NAMES[g] << std::right;
+          for (std::size_t s = 0; s < SAMPLERS; ++s)
+            {
+              const double v = res[g][s];
+              if (v < 0) ss << std::setw(10) << "-";
+              else       ss << std::setw(10) << v / count;
+            }
+        }
+      ss << std::defaultfloat;
+    };
+
+  // Rank mean over components, and aggregate rate over threads
+  Results mean, aggregate;
+  uint32_t count {0};
+  for (auto & row : mean) row.fill(0);
+  for (auto & row : aggregate) row.fill(0);
+  for (std::size_t t = 0; t < sums.size(); ++t)
+    {
+      if ( ! lps[t]) continue;
+      count += lps[t];
+      for (std::size_t g = 0; g < GENERATORS; ++g)
+        {
+          for (std::size_t s = 0; s < SAMPLERS; ++s)
+            {
+              const double sum = sums[t][g][s];
+              mean[g][s] += sum;
+              // Thread mean ns per sample, to samples per us
+              if (sum > 0) aggregate[g][s] += lps[t] / sum * 1e3;
+              else if (sum < 0) aggregate[g][s] = -1;
+            }
+        }
+    }
+
+  std::stringstream ss;
+  ss << "Rng timing, rank " << getRank().rank << ", "
+     << sums.size() << " threads, " << count << " components:";
+  if (sums.size() > 1)
+    {
+      for (std::size_t t = 0; t < sums.size(); ++t)
+        {
+          if ( ! lps[t]) continue;
+          ss << "\n    Thread " << t << ", " << lps[t] << " components, ns per sample:";
+          table(ss, sums[t], lps[t]);
+        }
+    }
+  ss << "\n    Rank mean, ns per sample:";
+  table(ss, mean, count);
+  ss << "\n    Rank aggregate over all threads, millions of samples per second:";
+  table(ss, aggregate, 1);
+  ss << std::endl;
+  m_output.output("%s\n", ss.str().c_str());
+
+}  // ShowResults()
+
+
 void
 Rng::setup() 
 {
@@ -192,6 +496,7 @@ void
 Rng::finish() 
 {
   VERBOSE(2, "%s", "\n");
+  ShowResults();
 }
 
 }  // namespace Phold
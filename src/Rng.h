@@ -24,6 +24,10 @@
 #include <sst/core/rng/expon.h>
 #include <sst/core/eli/statsInfo.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
 /**
@@ -36,6 +40,38 @@ namespace Phold {
 
 /**
  * SST RNG performance benchmark.
+ *
+ * Each component times every generator PHOLD can use, with every
+ * sampler PHOLD can put on top of it, and reports the mean cost in ns
+ * per sample:
+ *
+ * Generator   | Type
+ * ----------- | ----------------------------------------------
+ * `mersenne`  | SST::RNG::MersenneRNG
+ * `marsaglia` | SST::RNG::MarsagliaRNG
+ * `xorshift`  | SST::RNG::XORShiftRNG
+ * `philox`    | Phold::PhiloxRng, counter-based, block generated
+ *
+ * Sampler     | Computes
+ * ----------- | ----------------------------------------------
+ * `uniform`   | `nextUniform()`, by value, as in Phold::SstRng
+ * `virtual`   | `nextUniform()` through an SST::RNG::Random pointer
+ * `sst-exp`   | SST::RNG::SSTExponentialDistribution::getNextDouble()
+ * `exp`       | The Rng policy `nextExponential()`, as in Phold::ExponentialDelay
+ * `ziggurat`  | Phold::Ziggurat, as in Phold::ZigguratDelay
+ * `sst-int`   | SST::RNG::SSTUniformDistribution::getNextDouble(), over `bins`
+ * `scaled`    | `nextUniform() * bins`, as in Phold::RandomDestination
+ * `bounded`   | Phold::BoundedInt(), as in Phold::BoundedDestination
+ *
+ * The SST samplers aren't available for `philox`, which isn't an
+ * SST::RNG::Random.
+ *
+ * One generator is timed per event, with the events 1 ms apart, the
+ * latency of the nuisance links, so every thread times the same
+ * generator in each synchronization window, and the results show the
+ * cost with all threads busy.  In finish() each rank reports the mean
+ * over the components on each thread, the mean over the rank, and
+ * the aggregate rate over all threads.
  */
 class Rng : public SST::Component
 {
@@ -132,8 +168,16 @@ public:
      "1"
    },
    { "samples",
-     "Number of rng samples per component. Must be > 0.",
-     "1"
+     "Number of samples per component, for each generator and sampler. Must be > 0.",
+     "1000000"
+   },
+   { "bins",
+     "Number of values for the integer samplers. Must be > 0.",
+     "1000"
+   },
+   { "mean",
+     "Mean of the exponential samplers.",
+     "1.0"
    },
    { "pverbose",
      "Verbose output",
@@ -195,18 +239,80 @@ private:
 
   /**
    * Timing event handler.
-   * We just borrow Phold::PholdEvent for this
+   * Times the next generator, then schedules the one after,
+   * or records our results when done.
    * @param ev The incoming event.
    * @param from The sending component id.
    */
   void handleEvent(SST::Event *ev, uint32_t from);
-  
+
+  /** The generators, one row in the results. */
+  enum Generator : std::size_t
+  {
+    MERSENNE,    /**< SST::RNG::MersenneRNG. */
+    MARSAGLIA,   /**< SST::RNG::MarsagliaRNG. */
+    XORSHIFT,    /**< SST::RNG::XORShiftRNG. */
+    PHILOX,      /**< Phold::PhiloxRng. */
+    GENERATORS   /**< Number of generators. */
+  };
+
+  /** The samplers, one column in the results. */
+  enum Sampler : std::size_t
+  {
+    UNIFORM,     /**< Uniform, by value. */
+    VIRTUAL,     /**< Uniform, through SST::RNG::Random. */
+    SST_EXP,     /**< SST exponential distribution. */
+    EXPONENTIAL, /**< Rng policy exponential. */
+    ZIGGURAT,    /**< Ziggurat exponential. */
+    SST_INT,     /**< SST uniform distribution over bins. */
+    SCALED,      /**< Scaled uniform integer. */
+    BOUNDED,     /**< Lemire bounded integer. */
+    SAMPLERS     /**< Number of samplers. */
+  };
+
+  /** ns per sample for each generator and sampler, negative if not available. */
+  typedef std::array<std::array<double, SAMPLERS>, GENERATORS> Results;
+
+  /**
+   * Time every sampler with one generator.
+   * @param gen The generator.
+   */
+  void TimeGenerator(Generator gen);
+
+  /**
+   * Time every sampler with one generator type.
+   * @tparam Policy The Phold Rng policy.
+   * @tparam R The SST generator, or \c void for none.
+   * @param gen The generator.
+   */
+  template <class Policy, class R>
+  void TimeGeneratorT(Generator gen);
+
+  /** Add our results to m_rankShare. */
+  void Contribute();
+
+  /** Show the rank results, once per rank. */
+  void ShowResults() const;
+
   // Class static data members
 
   static uint32_t          m_number;     /**< Total number of components */
   static uint64_t          m_samples;    /**< Number of samples per component */
+  static uint32_t          m_bins;       /**< Number of values for the integer samplers */
+  static double            m_mean;       /**< Mean of the exponential samplers */
   static uint32_t          m_verbose;    /**< Verbose output flag */
 
+  /** Results summed over the components on this rank. */
+  struct RankShare
+  {
+    std::mutex           mutex;       /**< Protects the rest. */
+    std::vector<Results> threadSums;  /**< Sum of the results on each thread. */
+    std::vector<uint32_t> threadLps;  /**< Number of components on each thread. */
+  };
+
+  /** The rank results. */
+  static RankShare         m_rankShare;
+
   // Class instance data members
   /** Output stream for verbose output */
   SST::Output              m_output;
@@ -219,17 +325,16 @@ private:
 #endif
 
   /** Self link. */
-  SST::Link * m_self;
+  SST::Link * m_self {nullptr};
 
-  /** 
-   * Choice of underlying RNG: 
-   * * SST::RNG::MersenneRNG or 
-   * * SST::RNG::MarsagliaRNG 
-   */
-  typedef SST::RNG::MarsagliaRNG RNG_t;
+  /** Next generator to time. */
+  std::size_t              m_next {0};
+
+  /** Our results. */
+  Results                  m_results;
 
-  /**< Base RNG instance */
-  RNG_t                            * m_rng;
+  /** Sum of all the samples, so the compiler can't remove them. */
+  double                   m_sink {0};
 
   // Class instance statistics
 
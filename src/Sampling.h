@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>    // exp(), log()
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file
+ * Phold::Ziggurat and Phold::BoundedInt sampling kernels.
+ *
+ * These only need `nextUniform()` from the generator, so they work with
+ * every Rng policy, and don't depend on SST, so they can be tested alone.
+ *
+ * The Rng policies give two kinds of uniform deviates:
+ *
+ * Generator      | Deviate
+ * -------------- | ----------------------------------------------------
+ * CounterRng     | A multiple of \f$2^{-53}\f$, in `[0, 1)`
+ * SST generators | A 32-bit integer divided by `UINT32_MAX`, in `[0, 1]`
+ *
+ * Bits() recovers all 53 bits of the first kind.  For the second only the
+ * top 32 bits are random, so the kernels take their most important bits
+ * from the top, and never assume the deviate is below 1.
+ */
+
+namespace Phold {
+
+/**
+ * Recover the random bits of a uniform deviate.
+ * @param u Uniform deviate in `[0, 1]`.
+ * @returns The bits, in `[0, 2^53)`; 1.0 gives the largest.
+ */
+inline uint64_t
+Bits(double u)
+{
+  constexpr uint64_t largest {(uint64_t{1} << 53) - 1};
+  const auto bits = static_cast<uint64_t>(u * 0x1.0p53);
+  return bits < largest ? bits : largest;
+}
+
+/**
+ * Recover the top 32 bits of a uniform deviate.  For a 32-bit generator
+ * returning `k / UINT32_MAX` this is `k`, except for `k` within about
+ * \f$2^{11}\f$ of `UINT32_MAX`, where rounding can give `k + 1`.
+ * 1.0 gives `UINT32_MAX`.
+ * @param u Uniform deviate in `[0, 1]`.
+ * @returns The top 32 bits.
+ */
+inline uint32_t
+Bits32(double u)
+{
+  return static_cast<uint32_t>(Bits(u) >> 21);
+}
+
+
+/**
+ * Unit exponential deviates by the Marsaglia-Tsang ziggurat.
+ *
+ * G. Marsaglia and W. W. Tsang, "The Ziggurat Method for Generating
+ * Random Variables," J. Stat. Software 5(8), 2000.
+ * The density is covered by 256 layers of equal area.  Each draw uses
+ * the top 8 bits of a deviate to pick a layer and the other 45 bits
+ * as the abscissa; about 99% of draws fall inside the layer below it,
+ * and cost one multiply and compare, with no `log()`.  The rest fall in
+ * a layer edge, needing one `exp()`, or in the tail, needing a `log()`.
+ * Unlike the original, the layer and abscissa come from disjoint bits.
+ * With a 32-bit generator only the top 24 bits of the abscissa are random.
+ */
+class Ziggurat
+{
+public:
+
+  /**
+   * Draw a unit exponential deviate.
+   * @param rng The generator, providing `nextUniform()`.
+   * @returns The deviate.
+   */
+  template <class Rng>
+  static double Exponential(Rng & rng)
+  {
+    const Tables & t = Get();
+    for (;;)
+      {
+        const uint64_t bits = Bits(rng.nextUniform());
+        const std::size_t i = bits >> ABSCISSA_BITS;
+        const uint64_t j = bits & ((uint64_t{1} << ABSCISSA_BITS) - 1);
+        const double x = j * t.w[i];
+        if (j < t.k[i]) return x;
+        if (0 == i)
+          {
+            // Tail beyond R is R plus another exponential
+            return R - std::log(1.0 - rng.nextUniform());
+          }
+        // Edge of the layer: accept under the density
+        if (t.f[i] + rng.nextUniform() * (t.f[i - 1] - t.f[i]) < std::exp(-x)) return x;
+      }
+  }
+
+private:
+
+  /** Number of bits selecting the layer. */
+  static constexpr unsigned    LAYER_BITS {8};
+  /** Number of layers. */
+  static constexpr std::size_t LAYERS {1u << LAYER_BITS};
+  /** Number of bits for the abscissa. */
+  static constexpr unsigned    ABSCISSA_BITS {53 - LAYER_BITS};
+  /** Start of the tail. */
+  static constexpr double      R {7.69711747013104972};
+  /** Area of each layer. */
+  static constexpr double      V {3.949659822581572e-3};
+  /** Scale of the abscissa bits, \f$2^{53 - 8}\f$. */
+  static constexpr double      SCALE {0x1.0p45};
+
+  /** The layer tables. */
+  struct Tables
+  {
+    std::array<uint64_t, LAYERS> k;  /**< Abscissa bits always inside the density. */
+    std::array<double,   LAYERS> w;  /**< Abscissa per bit. */
+    std::array<double,   LAYERS> f;  /**< Density at the right edge of each layer. */
+  };
+
+  /**
+   * Build the tables, once.
+   * @returns The tables.
+   */
+  static const Tables & Get()
+  {
+    static const Tables tables = Build();
+    return tables;
+  }
+
+  /** @returns The tables, as in Marsaglia and Tsang's `zigset()`. */
+  static Tables Build()
+  {
+    Tables t;
+    double d = R;
+    double prev = R;
+    const double q = V / std::exp(-d);
+    t.k[0] = static_cast<uint64_t>((d / q) * SCALE);
+    t.k[1] = 0;
+    t.w[0] = q / SCALE;
+    t.w[LAYERS - 1] = d / SCALE;
+    t.f[0] = 1.0;
+    t.f[LAYERS - 1] = std::exp(-d);
+    for (std::size_t i = LAYERS - 2; i >= 1; --i)
+      {
+        d = -std::log(V / d + std::exp(-d));
+        t.k[i + 1] = static_cast<uint64_t>((d / prev) * SCALE);
+        prev = d;
+        t.f[i] = std::exp(-d);
+        t.w[i] = d / SCALE;
+      }
+    return t;
+  }
+
+};  // class Ziggurat
+
+
+/**
+ * Uniform integer in `[0, n)`, by Lemire's multiply and shift.
+ *
+ * D. Lemire, "Fast Random Integer Generation in an Interval,"
+ * ACM Trans. Model. Comput. Simul. 29(1), 2019.
+ * The top 32 bits of a deviate, from Bits32(), times @p n give the
+ * integer in the high half of the product; the low half detects the few
+ * products in the biased region, which are redrawn.  The division
+ * computing the threshold is only needed on that rare path.  For @p n
+ * above \f$2^{32}\f$ this falls back to scaling the deviate, like the
+ * default samplers.
+ *
+ * Since Bits32() is at most `UINT32_MAX` the integer is always below
+ * @p n, even for the deviate 1.0.  With CounterRng it is exactly uniform.
+ * With a 32-bit generator it is uniform up to the Bits32() rounding,
+ * which moves less than \f$2^{-20}\f$ of the probability between values.
+ *
+ * @param rng The generator, providing `nextUniform()`.
+ * @param n   The number of values, at least 1.
+ * @returns The integer.
+ */
+template <class Rng>
+inline uint64_t
+BoundedInt(Rng & rng, uint64_t n)
+{
+  if (n > UINT32_MAX)
+    {
+      const auto k = static_cast<uint64_t>(rng.nextUniform() * n);
+      return k < n ? k : n - 1;
+    }
+  const auto n32 = static_cast<uint32_t>(n);
+  uint64_t m = uint64_t{Bits32(rng.nextUniform())} * n32;
+  auto low = static_cast<uint32_t>(m);
+  if (low < n32)
+    {
+      const uint32_t threshold = (0u - n32) % n32;
+      while (low < threshold)
+        {
+          m = uint64_t{Bits32(rng.nextUniform())} * n32;
+          low = static_cast<uint32_t>(m);
+        }
+    }
+  return m >> 32;
+}
+
+}  // namespace Phold
@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include "CounterRng.h"
+#include "Destinations.h"
+#include "Sampling.h"
+
+#include <algorithm>  // min()
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file
+ * Phold::PholdT sampling policies which don't need the SST core.
+ *
+ * These are the PhiloxRng generator, and all the Destination and Delay
+ * policies.  They only use the SST type aliases, through Destinations.h,
+ * so the stand-alone phold-engine can share them.  The SST generator
+ * policy, SstRng, is in PholdPolicy.h.
+ */
+
+namespace Phold {
+
+/** Rng policy using the counter-based Philox generator. */
+class PhiloxRng : public CounterRng
+{
+public:
+  using CounterRng::CounterRng;
+
+  /** @returns The policy name. */
+  static const char * Name() { return "philox"; }
+
+};  // class PhiloxRng
+
+
+/** Destination policy choosing uniformly at random. */
+struct RandomDestination
+{
+  /**
+   * Decide if the next event should go to another LP.
+   * @param rng    The generator.
+   * @param remote The remote fraction.
+   * @returns \c true if the event should be remote.
+   */
+  template <class Rng>
+  static bool IsRemote(Rng & rng, double remote)
+  {
+    return rng.nextUniform() < remote;
+  }
+
+  /**
+   * Choose any other LP, for the full topology.
+   * @param rng   The generator.
+   * @param dests The destination distribution.
+   * @param self  Our LP id.
+   * @param reps  Incremented by the number of draws.
+   * @returns The destination LP id.
+   */
+  template <class Rng>
+  static SST::ComponentId_t Any(Rng & rng, const Destinations & dests,
+                                SST::ComponentId_t self, unsigned & reps)
+  {
+    return dests.Sample(rng, self, reps);
+  }
+
+  /**
+   * Choose a neighbor, for sparse topologies.
+   * @param rng The generator.
+   * @param n   The number of neighbors.
+   * @param next The index of the first neighbor above self (unused).
+   * @returns The neighbor index.
+   */
+  template <class Rng>
+  static std::size_t Neighbor(Rng & rng, std::size_t n, std::size_t /* next */)
+  {
+    // SST generators can return 1.0, which would pick past the neighbors
+    const auto index = static_cast<std::size_t>(rng.nextUniform() * n);
+    return std::min(index, n - 1);
+  }
+
+  /** @returns The policy name. */
+  static const char * Name() { return "random"; }
+
+};  // struct RandomDestination
+
+
+/**
+ * Destination policy choosing uniformly at random, with BoundedInt()
+ * for the uniform choices.  Other destination distributions are
+ * sampled as in RandomDestination.
+ */
+struct BoundedDestination
+{
+  /** @copydoc RandomDestination::IsRemote() */
+  template <class Rng>
+  static bool IsRemote(Rng & rng, double remote)
+  {
+    return rng.nextUniform() < remote;
+  }
+
+  /** @copydoc RandomDestination::Any() */
+  template <class Rng>
+  static SST::ComponentId_t Any(Rng & rng, const Destinations & dests,
+                                SST::ComponentId_t self, unsigned & reps)
+  {
+    const auto & config = dests.getConfig();
+    if (Destinations::Kind::UNIFORM != config.kind) return dests.Sample(rng, self, reps);
+    ++reps;
+    // Any of the others, skipping over self
+    const auto id = BoundedInt(rng, config.number - 1);
+    return id >= self ? id + 1 : id;
+  }
+
+  /** @copydoc RandomDestination::Neighbor() */
+  template <class Rng>
+  static std::size_t Neighbor(Rng & rng, std::size_t n, std::size_t /* next */)
+  {
+    return static_cast<std::size_t>(BoundedInt(rng, n));
+  }
+
+  /** @returns The policy name. */
+  static const char * Name() { return "bounded"; }
+
+};  // struct BoundedDestination
+
+
+/**
+ * Destination policy always sending to the next LP, with no sampling.
+ * With the full topology this is the next LP id; with sparse topologies
+ * the next neighbor above us, in both cases wrapping around.
+ */
+struct FixedDestination
+{
+  /** @copydoc RandomDestination::IsRemote() */
+  template <class Rng>
+  static bool IsRemote(Rng & /* rng */, double /* remote */)
+  {
+    return true;
+  }
+
+  /** @copydoc RandomDestination::Any() */
+  template <class Rng>
+  static SST::ComponentId_t Any(Rng & /* rng */, const Destinations & dests,
+                                SST::ComponentId_t self, unsigned & reps)
+  {
+    ++reps;
+    return (self + 1) % dests.getConfig().number;
+  }
+
+  /** @copydoc RandomDestination::Neighbor() */
+  template <class Rng>
+  static std::size_t Neighbor(Rng & /* rng */, std::size_t /* n */, std::size_t next)
+  {
+    return next;
+  }
+
+  /** @returns The policy name. */
+  static const char * Name() { return "fixed"; }
+
+};  // struct FixedDestination
+
+
+/** Delay policy drawing exponential delays. */
+struct ExponentialDelay
+{
+  /**
+   * Draw a delay, in addition to the minimum.
+   * @param rng  The generator.
+   * @param mean The mean delay (unused, the generator has it).
+   * @returns The delay, in TIMEBASE units.
+   */
+  template <class Rng>
+  static SST::SimTime_t Draw(Rng & rng, double /* mean */)
+  {
+    return static_cast<SST::SimTime_t>(rng.nextExponential());
+  }
+
+  /** @returns The policy name. */
+  static const char * Name() { return "exponential"; }
+
+};  // struct ExponentialDelay
+
+
+/**
+ * Delay policy drawing exponential delays from the Ziggurat,
+ * using the uniform deviates, instead of the generator's `nextExponential()`.
+ */
+struct ZigguratDelay
+{
+  /**
+   * Draw a delay, in addition to the minimum.
+   * @param rng  The generator.
+   * @param mean The mean delay.
+   * @returns The delay, in TIMEBASE units.
+   */
+  template <class Rng>
+  static SST::SimTime_t Draw(Rng & rng, double mean)
+  {
+    return static_cast<SST::SimTime_t>(Ziggurat::Exponential(rng) * mean);
+  }
+
+  /** @returns The policy name. */
+  static const char * Name() { return "ziggurat"; }
+
+};  // struct ZigguratDelay
+
+
+/** Delay policy always using the mean delay. */
+struct FixedDelay
+{
+  /** @copydoc ExponentialDelay::Draw() */
+  template <class Rng>
+  static SST::SimTime_t Draw(Rng & /* rng */, double mean)
+  {
+    return static_cast<SST::SimTime_t>(mean);
+  }
+
+  /** @returns The policy name. */
+  static const char * Name() { return "fixed"; }
+
+};  // struct FixedDelay
+
+}  // namespace Phold
@@ -0,0 +1,296 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Topology.h"
+
+#include <algorithm>  // sort(), unique(), find()
+#include <cmath>      // sqrt(), cbrt()
+#include <sstream>
+
+/**
+ * \file
+ * Phold::Topology class implementation.
+ */
+
+namespace Phold {
+
+namespace {
+
+/**
+ * SplitMix64 generator, used to pick the random topology offsets.
+ * This is simple enough to reproduce exactly in `tests/topology.py`.
+ * @param [in,out] state The generator state.
+ * @returns The next value.
+ */
+uint64_t
+SplitMix64(uint64_t & state)
+{
+  state += 0x9e3779b97f4a7c15ULL;
+  uint64_t z = state;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Largest divisor of \c n which is not greater than \c limit.
+ * @param n The number to factor.
+ * @param limit The upper bound on the divisor.
+ * @returns The divisor, at least 1.
+ */
+uint64_t
+LargestDivisor(uint64_t n, uint64_t limit)
+{
+  for (uint64_t d = std::max<uint64_t>(limit, 1); d > 1; --d)
+    {
+      if (n % d == 0) return d;
+    }
+  return 1;
+}
+
+}  // anonymous namespace
+
+
+Topology::Topology(const Config & config)
+  : m_config(config)
+{
+  if (m_config.kind == Kind::TORUS2 || m_config.kind == Kind::TORUS3)
+    {
+      ResolveDims();
+    }
+  else if (m_config.kind == Kind::RANDOM)
+    {
+      // Distinct offsets in [1, N/2], each giving neighbors at +/- offset
+      const uint64_t maxOffset = m_config.number / 2;
+      const uint64_t count = std::min((m_config.neighbors + 1) / 2, maxOffset);
+      uint64_t state = m_config.seed;
+      while (m_offsets.size() < count)
+        {
+          uint64_t d = 1 + SplitMix64(state) % maxOffset;
+          if (std::find(m_offsets.begin(), m_offsets.end(), d) == m_offsets.end())
+            {
+              m_offsets.push_back(d);
+            }
+        }
+    }
+
+}  // Topology()
+
+
+bool
+Topology::Parse(const std::string & name, Kind & kind)
+{
+  static const std::vector<Kind> kinds
+    {Kind::FULL, Kind::RING, Kind::TORUS2, Kind::TORUS3,
+     Kind::RANDOM, Kind::HIERARCHICAL};
+  for (auto k : kinds)
+    {
+      if (name == Name(k))
+        {
+          kind = k;
+          return true;
+        }
+    }
+  return false;
+
+}  // Parse()
+
+
+std::string
+Topology::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::FULL:          return "full";
+    case Kind::RING:          return "ring";
+    case Kind::TORUS2:        return "torus2";
+    case Kind::TORUS3:        return "torus3";
+    case Kind::RANDOM:        return "random";
+    case Kind::HIERARCHICAL:  return "hierarchical";
+    };
+  return "undefined";
+
+}  // Name()
+
+
+void
+Topology::ResolveDims()
+{
+  const uint64_t n = m_config.number;
+  const std::size_t rank = (m_config.kind == Kind::TORUS2 ? 2 : 3);
+
+  if ( ! m_config.dims.empty())
+    {
+      // Accept "x,y,z" or "xXyXz" (case insensitive)
+      std::string dims = m_config.dims;
+      std::replace(dims.begin(), dims.end(), ',', ' ');
+      std::replace(dims.begin(), dims.end(), 'x', ' ');
+      std::replace(dims.begin(), dims.end(), 'X', ' ');
+      std::stringstream ss(dims);
+      for (std::size_t i = 0; i < rank; ++i)
+        {
+          ss >> m_dims[i];
+        }
+      return;
+    }
+
+  // Most compact factorization
+  uint64_t rest = n;
+  if (rank == 3)
+    {
+      m_dims[2] = LargestDivisor(rest, static_cast<uint64_t>(std::cbrt(rest) + 0.5));
+      rest /= m_dims[2];
+    }
+  m_dims[1] = LargestDivisor(rest, static_cast<uint64_t>(std::sqrt(rest) + 0.5));
+  m_dims[0] = rest / m_dims[1];
+
+}  // ResolveDims()
+
+
+bool
+Topology::isValid(std::string & why) const
+{
+  const uint64_t n = m_config.number;
+  if (n < 2)
+    {
+      why = "need at least 2 LPs";
+      return false;
+    }
+  switch (m_config.kind)
+    {
+    case Kind::TORUS2:
+    case Kind::TORUS3:
+      if (m_dims[0] * m_dims[1] * m_dims[2] != n)
+        {
+          why = "torus dimensions " + toString() +
+            " don't match number " + std::to_string(n);
+          return false;
+        }
+      break;
+    case Kind::RANDOM:
+      if (m_config.neighbors < 1)
+        {
+          why = "random topology needs at least 1 neighbor";
+          return false;
+        }
+      break;
+    case Kind::HIERARCHICAL:
+      if (m_config.group < 1)
+        {
+          why = "hierarchical topology needs group size >= 1";
+          return false;
+        }
+      break;
+    default:
+      break;
+    };
+  return true;
+
+}  // isValid()
+
+
+std::vector<SST::ComponentId_t>
+Topology::neighbors(SST::ComponentId_t id) const
+{
+  const uint64_t n = m_config.number;
+  std::vector<SST::ComponentId_t> nbrs;
+
+  // Add the pair (id + d, id - d), modulo n
+  auto addPlusMinus = [&nbrs, n, id](uint64_t d)
+    {
+      d %= n;
+      nbrs.push_back((id + d) % n);
+      nbrs.push_back((id + n - d) % n);
+    };
+
+  switch (m_config.kind)
+    {
+    case Kind::FULL:
+      nbrs.reserve(n - 1);
+      for (uint64_t i = 0; i < n; ++i) nbrs.push_back(i);
+      break;
+
+    case Kind::RING:
+      addPlusMinus(1);
+      break;
+
+    case Kind::TORUS2:
+    case Kind::TORUS3:
+      {
+        // id = x + X * (y + Y * z)
+        uint64_t stride = 1;
+        for (auto dim : m_dims)
+          {
+            if (dim > 1)
+              {
+                const uint64_t c = (id / stride) % dim;
+                const uint64_t base = id - c * stride;
+                nbrs.push_back(base + ((c + 1) % dim) * stride);
+                nbrs.push_back(base + ((c + dim - 1) % dim) * stride);
+              }
+            stride *= dim;
+          }
+      }
+      break;
+
+    case Kind::RANDOM:
+      for (auto d : m_offsets) addPlusMinus(d);
+      break;
+
+    case Kind::HIERARCHICAL:
+      {
+        const uint64_t g = m_config.group;
+        const uint64_t begin = (id / g) * g;
+        const uint64_t end = std::min(begin + g, n);
+        for (uint64_t i = begin; i < end; ++i) nbrs.push_back(i);
+        for (uint64_t m = 1; m <= m_config.remotes; ++m) addPlusMinus(m * g);
+      }
+      break;
+    };
+
+  std::sort(nbrs.begin(), nbrs.end());
+  nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+  auto self = std::find(nbrs.begin(), nbrs.end(), id);
+  if (self != nbrs.end()) nbrs.erase(self);
+  return nbrs;
+
+}  // neighbors()
+
+
+std::string
+Topology::toString() const
+{
+  std::stringstream ss;
+  ss << Name(m_config.kind);
+  switch (m_config.kind)
+    {
+    case Kind::TORUS2:
+      ss << " (" << m_dims[0] << " x " << m_dims[1] << ")";
+      break;
+    case Kind::TORUS3:
+      ss << " (" << m_dims[0] << " x " << m_dims[1] << " x " << m_dims[2] << ")";
+      break;
+    case Kind::RANDOM:
+      // An offset of number / 2 gives the same LP both ways, so count
+      // the neighbors, which are the same for every LP
+      ss << " (" << neighbors(0).size() << " neighbors, seed " << m_config.seed << ")";
+      break;
+    case Kind::HIERARCHICAL:
+      ss << " (groups of " << m_config.group
+         << ", " << 2 * m_config.remotes << " remotes)";
+      break;
+    default:
+      break;
+    };
+  return ss.str();
+
+}  // toString()
+
+
+}  // namespace Phold
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <sst/core/sst_types.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * Phold::Topology class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Connectivity graph between PHOLD LPs.
+ *
+ * The classic PHOLD model connects every LP to every other LP, which
+ * requires `N * (N - 1)` links and doesn't scale past a few thousand LPs.
+ * This class computes the neighbor set of each LP for a number of
+ * sparse alternatives.  The neighbor relation is always symmetric,
+ * so the configuration script can create one link for each pair.
+ *
+ * The same algorithms are implemented in `tests/topology.py`;
+ * the two must be kept in sync, since the C++ side (Phold c'tor)
+ * only configures the ports it expects the Python side to have connected.
+ *
+ * Kind            | Neighbors of LP `i`
+ * --------------- | --------------------------------------------------------
+ * `full`          | All other LPs (default)
+ * `ring`          | `i - 1`, `i + 1`
+ * `torus2`        | Nearest neighbors on a 2D periodic grid
+ * `torus3`        | Nearest neighbors on a 3D periodic grid
+ * `random`        | `i +/- d` for `ceil(k / 2)` pseudo-random offsets `d`
+ * `hierarchical`  | All LPs in the same group, plus `i +/- m * group`
+ *                 | for `m` in `[1, remotes]`
+ *
+ * All index arithmetic is modulo `number`.
+ */
+class Topology
+{
+public:
+
+  /** Supported topologies. */
+  enum class Kind
+  {
+    FULL,          /**< Complete graph. */
+    RING,          /**< Periodic 1D ring. */
+    TORUS2,        /**< Periodic 2D grid. */
+    TORUS3,        /**< Periodic 3D grid. */
+    RANDOM,        /**< Circulant graph with random offsets. */
+    HIERARCHICAL   /**< Complete graph within groups, few links between. */
+  };
+
+  /** Topology parameters, as read from the component Params. */
+  struct Config
+  {
+    /** Which topology. */
+    Kind kind {Kind::FULL};
+    /** Total number of LPs. */
+    uint64_t number {2};
+    /**
+     * Grid dimensions for the torus topologies, as "x,y[,z]".
+     * Empty to pick the most compact factorization of `number`.
+     */
+    std::string dims {};
+    /** Number of neighbors for the random topology. */
+    uint64_t neighbors {4};
+    /** Seed for choosing the random topology offsets. */
+    uint64_t seed {1};
+    /** Number of LPs in each group, for the hierarchical topology. */
+    uint64_t group {0};
+    /** Number of links to other groups, in each direction. */
+    uint64_t remotes {1};
+  };
+
+  /**
+   * C'tor.
+   * @param config The configuration.
+   */
+  explicit Topology(const Config & config);
+
+  /**
+   * Parse a topology name.
+   * @param name The name, such as "ring".
+   * @param [out] kind The topology, if found.
+   * @returns \c true if \c name is a known topology.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Get the name of a topology kind.
+   * @param kind The topology kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Check the configuration for consistency.
+   * @param [out] why The error description, if invalid.
+   * @returns \c true if the configuration is valid.
+   */
+  bool isValid(std::string & why) const;
+
+  /** @returns \c true if this is the classic complete graph. */
+  bool isFull() const
+  {
+    return m_config.kind == Kind::FULL;
+  }
+
+  /** @returns The configuration. */
+  const Config & getConfig() const
+  {
+    return m_config;
+  }
+
+  /**
+   * Get the neighbors of an LP.
+   * @param id The LP id.
+   * @returns The sorted neighbor ids, excluding \c id itself.
+   */
+  std::vector<SST::ComponentId_t> neighbors(SST::ComponentId_t id) const;
+
+  /** @returns A short description, such as "torus2 (32 x 32)". */
+  std::string toString() const;
+
+private:
+
+  /** Resolve the torus dimensions, from `dims` or by factoring. */
+  void ResolveDims();
+
+  /** The configuration. */
+  Config m_config;
+
+  /** Resolved torus dimensions (unused are 1). */
+  std::array<uint64_t, 3> m_dims {{1, 1, 1}};
+
+  /** Resolved random topology offsets. */
+  std::vector<uint64_t> m_offsets;
+
+};  // class Topology
+
+}  // namespace Phold
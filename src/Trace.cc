@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Trace.h"
+
+#include <cerrno>
+#include <cstring>     // memcmp(), memcpy(), strerror()
+#include <utility>     // swap()
+
+#include <fcntl.h>     // open()
+#include <sys/mman.h>  // mmap()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // close()
+
+/**
+ * \file
+ * Phold::Trace class implementation.
+ */
+
+namespace Phold {
+
+namespace {
+
+/** The header magic. */
+const char MAGIC[8] = {'P', 'H', 'O', 'L', 'D', 'T', 'R', 'C'};
+
+}  // anonymous namespace
+
+
+std::string
+Trace::FileName(const std::string & base, uint32_t rank, uint32_t thread)
+{
+  return base + "_" + std::to_string(rank) + "_" + std::to_string(thread) + ".trace";
+
+}  // FileName()
+
+
+Trace::Writer::Writer(const std::string & file, uint32_t rank, uint32_t thread,
+                      double timeFactor, std::size_t records /* = 1 << 16 */)
+  : m_file(std::fopen(file.c_str(), "wb")),
+    m_capacity(records)
+{
+  if ( ! m_file) return;
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.recordBytes = sizeof(Record);
+  header.rank = rank;
+  header.thread = thread;
+  header.timeFactor = timeFactor;
+  std::fwrite(&header, sizeof(header), 1, m_file);
+  m_fill.reserve(m_capacity);
+  m_drain.reserve(m_capacity);
+  m_flusher = std::thread(&Writer::Flush, this);
+
+}  // Writer()
+
+
+Trace::Writer::~Writer()
+{
+  Close();
+
+}  // ~Writer()
+
+
+void
+Trace::Writer::Swap()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [this]() { return ! m_pending; });
+  std::swap(m_fill, m_drain);
+  m_count += m_drain.size();
+  m_fill.clear();
+  m_pending = true;
+  lock.unlock();
+  m_cv.notify_all();
+
+}  // Swap()
+
+
+void
+Trace::Writer::Flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+    {
+      m_cv.wait(lock, [this]() { return m_pending || m_done; });
+      if ( ! m_pending) break;
+      // Swap() waits for m_pending to clear before touching m_drain
+      lock.unlock();
+      std::fwrite(m_drain.data(), sizeof(Record), m_drain.size(), m_file);
+      lock.lock();
+      m_pending = false;
+      m_cv.notify_all();
+    }
+
+}  // Flush()
+
+
+void
+Trace::Writer::Close()
+{
+  if ( ! m_file) return;
+  if ( ! m_fill.empty()) Swap();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+  m_cv.notify_all();
+  m_flusher.join();
+  std::fclose(m_file);
+  m_file = nullptr;
+
+}  // Close()
+
+
+Trace::Reader::Reader(const std::string & file)
+{
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+      m_error = file + ": " + std::strerror(errno);
+      return;
+    }
+  struct stat st;
+  if (0 == fstat(fd, &st) && static_cast<std::size_t>(st.st_size) >= sizeof(Header))
+    {
+      m_bytes = static_cast<std::size_t>(st.st_size);
+      m_map = mmap(nullptr, m_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (MAP_FAILED == m_map)
+        {
+          m_error = file + ": " + std::strerror(errno);
+          m_map = nullptr;
+          m_bytes = 0;
+        }
+      else
+        {
+          // Mostly scanned in order
+          madvise(m_map, m_bytes, MADV_SEQUENTIAL);
+        }
+    }
+  else
+    {
+      m_error = file + ": too short for a trace header";
+    }
+  close(fd);
+
+}  // Reader()
+
+
+Trace::Reader::~Reader()
+{
+  if (m_map) munmap(m_map, m_bytes);
+
+}  // ~Reader()
+
+
+bool
+Trace::Reader::isValid(std::string & why) const
+{
+  if ( ! m_map)
+    {
+      why = m_error;
+      return false;
+    }
+  const auto & h = header();
+  if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+      why = "not a PHOLD trace";
+      return false;
+    }
+  if (h.version != VERSION || h.recordBytes != sizeof(Record))
+    {
+      why = "trace version " + std::to_string(h.version) + ", record size "
+        + std::to_string(h.recordBytes) + ", expected version "
+        + std::to_string(VERSION) + ", size " + std::to_string(sizeof(Record));
+      return false;
+    }
+  return true;
+
+}  // isValid()
+
+
+}  // namespace Phold
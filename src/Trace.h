@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>     // FILE
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * Phold::Trace class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Binary event trace.
+ *
+ * Each thread writes its own file, `<base>_<rank>_<thread>.trace`,
+ * as a Header followed by fixed width Records, one per event send
+ * which will be received before the stop time.  The records are in
+ * send order within each LP, but LPs on the same thread interleave.
+ *
+ * The Writer appends to one buffer while a background thread writes
+ * the other, so the event path only copies 40 bytes, and waits only
+ * if the disk can't keep up.  The Reader maps a file read only, so
+ * the records can be scanned without copying; see `phold-trace`.
+ *
+ * All fields are native endian; the Header records the record size
+ * and a magic number to catch mismatches.
+ */
+class Trace
+{
+public:
+
+  /** One event. */
+  struct Record
+  {
+    uint64_t send;   /**< Send time, TIMEBASE units. */
+    uint64_t recv;   /**< Receive time, TIMEBASE units. */
+    uint64_t src;    /**< Sending LP. */
+    uint64_t dst;    /**< Receiving LP. */
+    uint32_t bytes;  /**< Payload size, bytes. */
+    uint32_t flags;  /**< LOCAL for events to self. */
+  };
+
+  /** Record flags. */
+  enum Flags : uint32_t
+  {
+    LOCAL = 1   /**< Event to self, on the self link or queue. */
+  };
+
+  /** File header. */
+  struct Header
+  {
+    char     magic[8];      /**< "PHOLDTRC" */
+    uint32_t version;       /**< VERSION */
+    uint32_t recordBytes;   /**< sizeof(Record) */
+    uint32_t rank;          /**< SST rank. */
+    uint32_t thread;        /**< SST thread. */
+    double   timeFactor;    /**< Seconds per TIMEBASE unit. */
+  };
+
+  /** Format version. */
+  static constexpr uint32_t VERSION {1};
+
+  /**
+   * Get the file name for a thread.
+   * @param base The base name.
+   * @param rank The rank.
+   * @param thread The thread.
+   * @returns The file name.
+   */
+  static std::string FileName(const std::string & base, uint32_t rank, uint32_t thread);
+
+  /**
+   * Buffered, double buffered trace file writer, for one thread.
+   */
+  class Writer
+  {
+  public:
+
+    /**
+     * Open the file and start the flush thread.
+     * @param file The file name.
+     * @param rank The rank, for the header.
+     * @param thread The thread, for the header.
+     * @param timeFactor Seconds per TIMEBASE unit, for the header.
+     * @param records Records per buffer.
+     */
+    Writer(const std::string & file, uint32_t rank, uint32_t thread,
+           double timeFactor, std::size_t records = 1 << 16);
+
+    /** Close, if not already closed. */
+    ~Writer();
+
+    /** @returns \c true if the file is open. */
+    bool isOpen() const
+    {
+      return m_file != nullptr;
+    }
+
+    /**
+     * Add a record; only called from the owning thread.
+     * @param record The record.
+     */
+    void Append(const Record & record)
+    {
+      m_fill.push_back(record);
+      if (m_fill.size() == m_capacity) Swap();
+    }
+
+    /** Write everything and close the file. */
+    void Close();
+
+    /** @returns The number of records written, or queued to write. */
+    uint64_t Count() const
+    {
+      return m_count + m_fill.size();
+    }
+
+  private:
+
+    /** Hand the fill buffer to the flush thread, and take the empty one. */
+    void Swap();
+
+    /** Flush thread body. */
+    void Flush();
+
+    std::FILE *             m_file;       /**< The file. */
+    std::size_t             m_capacity;   /**< Records per buffer. */
+    std::vector<Record>     m_fill;       /**< Buffer being appended. */
+    std::vector<Record>     m_drain;      /**< Buffer being written. */
+    uint64_t                m_count {0};  /**< Records handed to the flush thread. */
+    std::mutex              m_mutex;      /**< Guard for m_drain, m_pending, m_done. */
+    std::condition_variable m_cv;         /**< Signal m_pending, or m_done. */
+    bool                    m_pending {false};  /**< m_drain has records to write. */
+    bool                    m_done {false};     /**< Stop the flush thread. */
+    std::thread             m_flusher;    /**< The flush thread. */
+
+  };  // class Writer
+
+  /**
+   * Read only memory map of a trace file.
+   */
+  class Reader
+  {
+  public:
+
+    /**
+     * Map a file.
+     * @param file The file name.
+     */
+    explicit Reader(const std::string & file);
+
+    /** Unmap. */
+    ~Reader();
+
+    Reader(const Reader &) = delete;
+    Reader & operator = (const Reader &) = delete;
+
+    /**
+     * Check the file was mapped, and the header matches.
+     * @param [out] why The error description, if invalid.
+     * @returns \c true if the records can be read.
+     */
+    bool isValid(std::string & why) const;
+
+    /** @returns The header. */
+    const Header & header() const
+    {
+      return *static_cast<const Header *>(m_map);
+    }
+
+    /** @returns The first record. */
+    const Record * begin() const
+    {
+      return reinterpret_cast<const Record *>(static_cast<const char *>(m_map) + sizeof(Header));
+    }
+
+    /** @returns Past the last record. */
+    const Record * end() const
+    {
+      return begin() + size();
+    }
+
+    /** @returns The number of records. */
+    std::size_t size() const
+    {
+      return m_bytes > sizeof(Header) ? (m_bytes - sizeof(Header)) / sizeof(Record) : 0;
+    }
+
+  private:
+
+    void *       m_map {nullptr};  /**< The mapping. */
+    std::size_t  m_bytes {0};      /**< Mapped size. */
+    std::string  m_error;          /**< Why the map failed, if it did. */
+
+  };  // class Reader
+
+};  // class Trace
+
+}  // namespace Phold
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "Work.h"
+
+#include <chrono>
+#include <sstream>
+
+/**
+ * \file
+ * Phold::Work class implementation.
+ */
+
+namespace Phold {
+
+bool
+Work::Parse(const std::string & name, Kind & kind)
+{
+  if      (name == "none")   kind = Kind::NONE;
+  else if (name == "flops")  kind = Kind::FLOPS;
+  else if (name == "hash")   kind = Kind::HASH;
+  else if (name == "memory") kind = Kind::MEMORY;
+  else return false;
+  return true;
+
+}  // Parse()
+
+
+std::string
+Work::Name(Kind kind)
+{
+  switch (kind)
+    {
+    case Kind::NONE:   return "none";
+    case Kind::FLOPS:  return "flops";
+    case Kind::HASH:   return "hash";
+    case Kind::MEMORY: return "memory";
+    }
+  return "unknown";
+
+}  // Name()
+
+
+bool
+Work::isValid(std::string & why) const
+{
+  if (m_config.mean < 0)
+    {
+      why = "workmean can't be negative";
+      return false;
+    }
+  if (m_config.kind == Kind::HASH && 0 == m_config.payload)
+    {
+      why = "hash work needs a payload, set buffer > 0";
+      return false;
+    }
+  if (m_config.kind == Kind::MEMORY && m_config.workingSet < LINE_BYTES)
+    {
+      why = "memory work needs workset of at least one cache line";
+      return false;
+    }
+  return true;
+
+}  // isValid()
+
+
+std::string
+Work::toString() const
+{
+  std::stringstream ss;
+  ss << Name(m_config.kind);
+  if (m_config.kind == Kind::NONE) return ss.str();
+
+  ss << " (" << (m_config.exponential ? "exponential" : "fixed")
+     << ", mean " << m_config.mean;
+  switch (m_config.kind)
+    {
+    case Kind::FLOPS:
+      ss << " iterations";
+      break;
+    case Kind::HASH:
+      ss << " passes over " << m_config.payload << " bytes";
+      break;
+    case Kind::MEMORY:
+      ss << " lines of " << m_config.workingSet << " bytes";
+      break;
+    default:
+      break;
+    }
+  ss << ")";
+  return ss.str();
+
+}  // toString()
+
+
+std::vector<uint64_t>
+Work::MakeWorkingSet() const
+{
+  if (m_config.kind == Kind::HASH)
+    {
+      std::vector<uint64_t> set((m_config.payload + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+      Fill(reinterpret_cast<char *>(set.data()), m_config.payload, 1);
+      return set;
+    }
+  if (m_config.kind != Kind::MEMORY) return {};
+  // Round up to whole lines, and write it all so the pages are faulted in
+  const auto lines = (m_config.workingSet + LINE_BYTES - 1) / LINE_BYTES;
+  return std::vector<uint64_t>(lines * LINE_WORDS, 1);
+
+}  // MakeWorkingSet()
+
+
+double
+Work::Calibrate() const
+{
+  if ( ! isEnabled()) return 0;
+
+  std::vector<char> payload(m_config.payload);
+  Fill(payload.data(), payload.size(), 1);
+  auto set = MakeWorkingSet();
+  uint64_t sink {0};
+  const auto units = static_cast<uint64_t>(m_config.mean);
+
+  // Repeat until we've run long enough to time reliably
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  const auto enough = std::chrono::milliseconds(10);
+  uint64_t reps {0};
+  do
+    {
+      for (int i = 0; i < 16; ++i)
+        {
+          Do(units, payload.data(), payload.size(), set, sink);
+        }
+      reps += 16;
+    }
+  while (Clock::now() - start < enough);
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+  // Keep the sink live
+  volatile uint64_t keep = sink;
+  (void)keep;
+  return elapsed.count() / reps;
+
+}  // Calibrate()
+
+
+}  // namespace Phold
@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#pragma once
+
+#include <algorithm>  // min()
+#include <cmath>      // log()
+#include <cstddef>
+#include <cstdint>
+#include <cstring>    // memcpy()
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * Phold::Work class declaration.
+ */
+
+namespace Phold {
+
+/**
+ * Synthetic compute grain, done by each LP for every event it executes.
+ *
+ * Kind     | Work per event, in `units`
+ * -------- | ------------------------------------------------------------
+ * `none`   | Nothing (default), so PHOLD measures only the scheduler
+ * `flops`  | A dependent multiply-add loop of `units` iterations
+ * `hash`   | `units` FNV-1a passes over the event payload (`buffer` bytes)
+ * `memory` | Read-modify-write `units` random cache lines in a per-LP
+ *          | working set of `workset` bytes
+ *
+ * The number of units per event is either fixed at `workmean`,
+ * or drawn from an exponential with that mean, using the LP's generator.
+ * (The extra draws change the event sequence, compared to no work.)
+ *
+ * With `hash` the sender fills the payload, and the receiver hashes it,
+ * as in QHOLD.  Local events on the self queue have no payload, so those
+ * hash a private buffer of the same size instead.  With `memory` a
+ * working set larger than the caches adds cache pressure as well as time.
+ *
+ * Each kernel returns a value which the LP folds into a sink, so the
+ * compiler can't remove the work.
+ */
+class Work
+{
+public:
+
+  /** Supported kernels. */
+  enum class Kind
+  {
+    NONE,     /**< No work. */
+    FLOPS,    /**< Floating point loop. */
+    HASH,     /**< Hash the payload. */
+    MEMORY    /**< Touch the working set. */
+  };
+
+  /** Work parameters, as read from the component Params. */
+  struct Config
+  {
+    /** Which kernel. */
+    Kind kind {Kind::NONE};
+    /** Mean number of units per event. */
+    double mean {1000};
+    /** Draw the units from an exponential, instead of fixed. */
+    bool exponential {false};
+    /** Per-LP working set size for the memory kernel, in bytes. */
+    std::size_t workingSet {1 << 20};
+    /** Payload size for the hash kernel, in bytes. */
+    std::size_t payload {0};
+  };
+
+  /** Bytes per cache line touched by the memory kernel. */
+  static constexpr std::size_t LINE_BYTES {64};
+
+  /** Words per cache line. */
+  static constexpr std::size_t LINE_WORDS {LINE_BYTES / sizeof(uint64_t)};
+
+  /** Default c'tor, with no work. */
+  Work() = default;
+
+  /**
+   * C'tor.
+   * @param config The configuration.
+   */
+  explicit Work(const Config & config)
+    : m_config(config)
+  {
+  }
+
+  /**
+   * Parse a kernel name.
+   * @param name The name, such as "flops".
+   * @param [out] kind The kernel, if found.
+   * @returns \c true if \c name is a known kernel.
+   */
+  static bool Parse(const std::string & name, Kind & kind);
+
+  /**
+   * Get the name of a kernel kind.
+   * @param kind The kernel kind.
+   * @returns The name.
+   */
+  static std::string Name(Kind kind);
+
+  /**
+   * Check the configuration for consistency.
+   * @param [out] why The error description, if invalid.
+   * @returns \c true if the configuration is valid.
+   */
+  bool isValid(std::string & why) const;
+
+  /** @returns The configuration. */
+  const Config & getConfig() const
+  {
+    return m_config;
+  }
+
+  /** @returns \c true if there is any work to do. */
+  bool isEnabled() const
+  {
+    return m_config.kind != Kind::NONE;
+  }
+
+  /** @returns A short description, such as "flops (exponential, mean 1000)". */
+  std::string toString() const;
+
+  /**
+   * Time the kernel, for the configuration report.
+   * @returns The mean time per event, in seconds.
+   */
+  double Calibrate() const;
+
+  /**
+   * Allocate and fault in the per-LP working set: the lines for the
+   * memory kernel, or the self queue payload for the hash kernel.
+   * @returns The working set, empty for the other kernels.
+   */
+  std::vector<uint64_t> MakeWorkingSet() const;
+
+  /**
+   * Draw the number of units for the next event.
+   * @param rng The generator, providing `nextUniform()`.
+   * @returns The number of units.
+   */
+  template <class Rng>
+  uint64_t Units(Rng & rng) const
+  {
+    if ( ! m_config.exponential) return static_cast<uint64_t>(m_config.mean);
+    return static_cast<uint64_t>(-std::log(1.0 - rng.nextUniform()) * m_config.mean);
+  }
+
+  /**
+   * Do the work for one event.
+   * @param units The number of units, from Units().
+   * @param payload The event payload, for the hash kernel.
+   * @param bytes The payload size.
+   * @param [in,out] set The working set, for the memory kernel.
+   * @param [in,out] sink Accumulates the results.
+   */
+  void Do(uint64_t units, const char * payload, std::size_t bytes,
+          std::vector<uint64_t> & set, uint64_t & sink) const
+  {
+    switch (m_config.kind)
+      {
+      case Kind::FLOPS:
+        {
+          double x = Flops(units, static_cast<double>(sink & 0xff));
+          uint64_t bits;
+          std::memcpy(&bits, &x, sizeof(bits));
+          sink += bits;
+        }
+        break;
+      case Kind::HASH:
+        sink += Hash(units, payload, bytes, sink);
+        break;
+      case Kind::MEMORY:
+        sink = Touch(units, set, sink);
+        break;
+      case Kind::NONE:
+      default:
+        break;
+      }
+  }
+
+  /**
+   * Fill a payload for the hash kernel.
+   * @param [out] payload The payload.
+   * @param bytes The payload size.
+   * @param seed Seed for the contents.
+   */
+  static void Fill(char * payload, std::size_t bytes, uint64_t seed)
+  {
+    for (std::size_t i = 0; i < bytes; i += sizeof(uint64_t))
+      {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::memcpy(payload + i, &seed, std::min(sizeof(seed), bytes - i));
+      }
+  }
+
+private:
+
+  /**
+   * Dependent multiply-add loop.
+   * @param n The number of iterations.
+   * @param x The starting value.
+   * @returns The result.
+   */
+  static double Flops(uint64_t n, double x)
+  {
+    // Converges to 1, so never overflows
+    for (uint64_t i = 0; i < n; ++i) x = x * 0.999999 + 1.0e-6;
+    return x;
+  }
+
+  /**
+   * FNV-1a over the payload, repeatedly.
+   * @param passes The number of passes.
+   * @param payload The bytes to hash.
+   * @param bytes The number of bytes.
+   * @param seed Mixed into the FNV offset basis.
+   * @returns The hash.
+   */
+  static uint64_t Hash(uint64_t passes, const char * payload, std::size_t bytes, uint64_t seed)
+  {
+    uint64_t h = 14695981039346656037ULL ^ seed;
+    for (uint64_t p = 0; p < passes; ++p)
+      {
+        for (std::size_t i = 0; i < bytes; ++i)
+          {
+            h = (h ^ static_cast<unsigned char>(payload[i])) * 1099511628211ULL;
+          }
+      }
+    return h;
+  }
+
+  /**
+   * Read-modify-write random cache lines.
+   * @param n The number of lines.
+   * @param [in,out] set The working set.
+   * @param state The line sequence state.
+   * @returns The new state.
+   */
+  static uint64_t Touch(uint64_t n, std::vector<uint64_t> & set, uint64_t state)
+  {
+    const std::size_t lines = set.size() / LINE_WORDS;
+    if (0 == lines) return state;
+    for (uint64_t i = 0; i < n; ++i)
+      {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        // High bits of the LCG are the most random
+        auto & word = set[((state >> 33) % lines) * LINE_WORDS];
+        word += state;
+        state ^= word;
+      }
+    return state;
+  }
+
+  /** The configuration. */
+  Config m_config;
+
+};  // class Work
+
+}  // namespace Phold
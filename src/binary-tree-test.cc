@@ -8,6 +8,7 @@
 
 
 #include "binary-tree.h"
+#include "kary-tree.h"
 
 #include <iostream>
 #include <iomanip>
@@ -63,6 +64,26 @@ main (int argc, char** argv [[maybe_unused]])
       std::cout << std::endl;
     }
 
+  // KaryTree(2) should agree with BinaryTree
+  KaryTree kt (2);
+  std::size_t errors {0};
+  for (std::size_t j = 1; j < bt::capacity (m); ++j)
+    {
+      auto bc = bt::children (j);
+      auto kc = kt.children (j);
+      if (bt::depth (j) != kt.depth (j)
+	  || bt::parent (j) != kt.parent (j)
+	  || bc.first != kc.first || bc.second + 1 != kc.second)
+	{
+	  ++errors;
+	}
+    }
+  for (std::size_t d = 0; d <= m; ++d)
+    {
+      if (bt::capacity (d) != kt.capacity (d)) ++errors;
+    }
+  std::cout << "\nKaryTree(2) mismatches with BinaryTree: " << errors << std::endl;
+
   if (all)
     {
       std::cout << "\nstd::numeric_limits<std::size_t>::max() = "
@@ -70,5 +91,5 @@ main (int argc, char** argv [[maybe_unused]])
 		<< std::endl;
     }
 
-  return 0;
+  return errors ? 1 : 0;
 }
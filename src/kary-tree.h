@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+# pragma once
+
+#include <cstddef>  // size_t
+#include <limits>
+#include <utility>
+
+/**
+ * Convenience functions for working with a k-ary tree stored
+ * in an indexed container, generalizing BinaryTree to any fan-out.
+ *
+ * As with BinaryTree these only work with notional indices;
+ * the caller should check that any indices returned are actually
+ * valid with respect to the number of items stored.
+ *
+ * With fan-out \c k the tree has depth about `log_k(n)`,
+ * and `KaryTree(2)` gives the same indices as BinaryTree.
+ *
+ * \c children(parentIdx) returns a std::pair with the half-open
+ * range of indices of the children of the item at \c parentIdx:
+ *
+ *    [k * parentIdx + 1, k * parentIdx + k + 1)
+ *
+ * \c parent(childIdx) returns the index of the parent of the item at \c childIdx:
+ *
+ *    parent = (childIdx - 1) / k  // with integer division truncation
+ */
+class KaryTree
+{
+public:
+  /**
+   * Constructor.
+   * @param k The fan-out, at least 2.
+   */
+  explicit KaryTree(std::size_t k = 2)
+    : m_k(k < 2 ? 2 : k)
+  {
+  }
+
+  /** The fan-out. */
+  std::size_t
+  fanout() const
+  {
+    return m_k;
+  }
+
+  /**
+   * Return the total size (maximum number of elements)
+   * of a tree with \c depth, saturating at `std::size_t` max.
+   */
+  std::size_t
+  capacity(std::size_t depth) const
+  {
+    constexpr auto max = std::numeric_limits<std::size_t>::max();
+    std::size_t cap {0};
+    std::size_t width {1};   // k^d
+    for (std::size_t d = 0; d <= depth; ++d)
+      {
+        if (cap > max - width) return max;
+        cap += width;
+        width = (width > max / m_k) ? max : width * m_k;
+      }
+    return cap;
+  }
+
+  /**
+   * Depth of the item at \c index.
+   */
+  std::size_t
+  depth(std::size_t index) const
+  {
+    std::size_t depth = 0;
+    while (capacity(depth) <= index) ++depth;
+    return depth;
+  }
+
+  /**
+   *  First index at \c depth
+   */
+  std::size_t
+  begin(std::size_t depth) const
+  {
+    if (depth == 0) return 0;
+    return capacity(depth - 1);
+  }
+
+  /**
+   * One past the last index at \c depth
+   */
+  std::size_t
+  end(std::size_t depth) const
+  {
+    return capacity(depth);
+  }
+
+  /**
+   * Return the parent index for \c childIdx
+   */
+  std::size_t
+  parent(std::size_t childIdx) const
+  {
+    return (childIdx - 1) / m_k;
+  }
+
+  /**
+   * Return the half-open range of children indices of \c parentIdx
+   */
+  std::pair<std::size_t, std::size_t>
+  children(std::size_t parentIdx) const
+  {
+    std::size_t first = m_k * parentIdx + 1;
+    return std::make_pair(first, first + m_k);
+  }
+
+private:
+  /** The fan-out. */
+  std::size_t m_k;
+
+};  // class KaryTree
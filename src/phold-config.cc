@@ -0,0 +1,691 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#include "Destinations.h"
+#include "Latencies.h"
+#include "Partitioner.h"
+#include "Topology.h"
+#include "kary-tree.h"
+
+#include <algorithm>  // min(), sort(), unique()
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>    // strtoull()
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * PHOLD SST configuration generator.
+ *
+ * Writes the SST JSON model for a PHOLD run directly, instead of
+ * building it in `tests/phold.py`, which spends most of its time in
+ * the Python link loop for large models.  The components, ports and
+ * links are the same as `tests/phold.py` creates, and the output is
+ * streamed, so memory use doesn't grow with the number of links.
+ *
+ * Usage:
+ * \code
+ *   phold-config [--output=<base>] [--ranks=R] [--threads=T]
+ *                [--shards] [--jobs=J] [--partition=<kind>] [--metrics=<file>]
+ *                [--<param>=<value> ...]
+ * \endcode
+ *
+ * Option        | Meaning
+ * ------------- | --------------------------------------------------
+ * `--output`    | Output file base name, `-` for stdout (default)
+ * `--ranks`     | Number of ranks to place LPs on (default 1)
+ * `--threads`   | Threads per rank (default 1)
+ * `--shards`    | Write one file per rank, `<base>_<rank>.json`
+ * `--jobs`      | Number of shards to write in parallel (default all cores)
+ * `--type`      | Component type (default `phold.Phold`)
+ * `--partition` | `linear` (default) or `graph`, see Phold::Partitioner
+ * `--metrics`   | Write the partition quality metrics to this JSON file
+ * `--<param>`   | Any other option is passed as a component parameter
+ *
+ * The parameters use the same names (and units) as the component,
+ * for example `--number=2048 --topology=torus2 --stop=100`.
+ * The placement is written explicitly, so run with `--partitioner=sst.self`.
+ * Each link latency is set by `--linklatency` and its options, see
+ * Phold::Latencies, using the placement from `--partition`.
+ * The partition quality (links cut and the expected fraction of
+ * events crossing ranks and threads) is always reported on stderr,
+ * along with the lookahead the placement achieves: the smallest latency
+ * of any link between ranks.  The `graph` placement maximizes this
+ * lookahead for sparse topologies, see Phold::Partitioner.
+ * Each shard holds the components on one rank and every link
+ * touching them, so cross rank links appear in two shards.
+ */
+
+namespace {
+
+/** Command line options. */
+struct Options
+{
+  std::string output   {"-"};            /**< Output base name. */
+  uint32_t    ranks    {1};              /**< Number of ranks. */
+  uint32_t    threads  {1};              /**< Threads per rank. */
+  bool        shards   {false};          /**< Write per-rank shards. */
+  unsigned    jobs     {0};              /**< Parallel shard writers. */
+  std::string type     {"phold.Phold"};  /**< Component type. */
+  std::string partition {"linear"};      /**< Partitioner. */
+  std::string metrics  {};               /**< Metrics file. */
+  /** Component parameters. */
+  std::map<std::string, std::string> params;
+};
+
+
+/** Print the usage message. */
+void
+Usage(const char * argv0)
+{
+  std::cerr << "Usage: " << argv0
+            << " [--output=<base>] [--ranks=R] [--threads=T] [--shards] [--jobs=J]\n"
+            << "       [--type=<component>] [--partition=linear|graph] [--metrics=<file>]\n"
+            << "       [--<param>=<value> ...]\n"
+            << "Write the SST JSON configuration for a PHOLD model.\n"
+            << "Other options are passed as Phold parameters, such as\n"
+            << "  --number=2048 --topology=torus2 --remote=0.9 --stop=100\n";
+}
+
+
+/**
+ * The PHOLD model: LPs, their placement and links.
+ */
+class Model
+{
+public:
+  /**
+   * Constructor.
+   * @param options The command line options.
+   */
+  explicit Model(Options & options)
+    : m_options(options),
+      m_topology(MakeConfig(options)),
+      m_tree(ToUint(Get(options.params, "fanout"), 2)),
+      m_dests(MakeDestinations(options)),
+      m_partitioner(MakePartitioner(options)),
+      m_latencies(MakeLatencies(options)),
+      m_rankLatency(std::numeric_limits<double>::infinity())
+  {
+    m_number = m_topology.getConfig().number;
+    const auto reduce = Get(options.params, "rankreduce");
+    m_rankReduce = reduce == "true" || reduce == "1";
+  }
+
+  /** @returns \c true if the model is valid, otherwise the reason in @c why. */
+  bool isValid(std::string & why) const
+  {
+    if ( ! m_topology.isValid(why)) return false;
+    if (m_number < uint64_t(m_options.ranks) * m_options.threads)
+      {
+        why = "need at least one LP per thread";
+        return false;
+      }
+    if ( ! m_dests.isValid(why)) return false;
+    if ( ! m_latencies.isValid(why)) return false;
+    if (m_dests.getConfig().kind != Phold::Destinations::Kind::UNIFORM && ! m_topology.isFull())
+      {
+        why = "non-uniform distributions require the full topology";
+        return false;
+      }
+    if (m_rankReduce && m_partitioner.getConfig().kind != Phold::Partitioner::Kind::LINEAR)
+      {
+        why = "rankreduce requires the linear partition";
+        return false;
+      }
+    return true;
+  }
+
+  /** Place the LPs, and report the partition quality. */
+  void Place()
+  {
+    m_partitioner.Partition(m_topology, m_latencies);
+    m_metrics = m_partitioner.Measure(m_topology, m_dests);
+    m_rankLatency = RankLatency();
+  }
+
+  /**
+   * Write the partition metrics as JSON.
+   * @param os The output stream.
+   */
+  void WriteMetrics(std::ostream & os) const
+  {
+    const auto & m = m_metrics;
+    os << "{\n"
+       << "  \"partition\": \"" << Phold::Partitioner::Name(m_partitioner.getConfig().kind) << "\",\n"
+       << "  \"topology\": \"" << m_topology.toString() << "\",\n"
+       << "  \"distribution\": \"" << m_dests.toString() << "\",\n"
+       << "  \"number\": " << m_number << ",\n"
+       << "  \"ranks\": " << m_options.ranks << ",\n"
+       << "  \"threads\": " << m_options.threads << ",\n"
+       << "  \"links\": " << m.links << ",\n"
+       << "  \"rank_cut\": " << m.rankCut << ",\n"
+       << "  \"thread_cut\": " << m.threadCut << ",\n"
+       << "  \"min_lps\": " << m.minSize << ",\n"
+       << "  \"max_lps\": " << m.maxSize << ",\n"
+       << "  \"rank_remote_fraction\": " << m.rankRemote << ",\n"
+       << "  \"thread_remote_fraction\": " << m.threadRemote << ",\n"
+       << "  \"latencies\": \"" << m_latencies.toString() << "\",\n"
+       << "  \"lookahead\": \"" << Seconds(m_latencies.Lookahead()) << "\",\n"
+       << "  \"rank_lookahead\": \"" << RankLookahead() << "\",\n"
+       << "  \"lookahead_optimized\": " << (LookaheadOptimized() ? "true" : "false") << "\n"
+       << "}\n";
+  }
+
+  /** Print the partition metrics on stderr. */
+  void ShowMetrics() const
+  {
+    const auto & m = m_metrics;
+    auto pct = [](double num, double den) { return den > 0 ? 100 * num / den : 0.0; };
+    std::cerr << "Partition " << Phold::Partitioner::Name(m_partitioner.getConfig().kind)
+              << " of " << m_topology.toString() << ", " << m_dests.toString()
+              << " destinations, onto " << m_options.ranks << " x " << m_options.threads << "\n"
+              << "  LPs per thread:        " << m.minSize << " - " << m.maxSize << "\n"
+              << "  Links cut by ranks:    " << m.rankCut << " of " << m.links
+              << " (" << pct(m.rankCut, m.links) << "%)\n"
+              << "  Links cut by threads:  " << m.threadCut
+              << " (" << pct(m.threadCut, m.links) << "%)\n"
+              << "  Events to other ranks: " << 100 * m.rankRemote << "% expected\n"
+              << "  Events to other threads on the same rank: "
+              << 100 * m.threadRemote << "% expected\n"
+              << "  Link latencies:        " << m_latencies.toString() << "\n"
+              << "  Lookahead:             " << Seconds(m_latencies.Lookahead()) << "\n"
+              << "  Placement lookahead:   " << RankLookahead()
+              << " (smallest latency between ranks, "
+              << (LookaheadOptimized() ? "maximized" : "not optimized") << " by the partitioner)\n";
+  }
+
+  /** @returns The number of LPs. */
+  uint64_t number() const
+  {
+    return m_number;
+  }
+
+  /**
+   * @param id The LP id.
+   * @returns The partition (rank * threads + thread) of LP @c id.
+   */
+  uint64_t Partition(uint64_t id) const
+  {
+    return m_partitioner.getPart(id);
+  }
+
+  /** @returns The rank and thread of LP @c id. */
+  Phold::Latencies::Place Place(uint64_t id) const
+  {
+    const auto part = Partition(id);
+    return {static_cast<uint32_t>(part / m_options.threads),
+            static_cast<uint32_t>(part % m_options.threads)};
+  }
+
+  /** @returns The rank of LP @c id. */
+  uint32_t Rank(uint64_t id) const
+  {
+    return static_cast<uint32_t>(Partition(id) / m_options.threads);
+  }
+
+  /**
+   * @returns The first LP on @c rank, as Phold::RankLeader(),
+   *   for the linear partition.
+   */
+  uint64_t RankLeader(uint64_t rank) const
+  {
+    const uint64_t parts = uint64_t(m_options.ranks) * m_options.threads;
+    const uint64_t per = m_number / parts;
+    const uint64_t extra = m_number % parts;
+    const uint64_t p = rank * m_options.threads;
+    return p * per + std::min(p, extra);
+  }
+
+  /**
+   * All the LPs connected to LP @c id, matching `Topology.links()`
+   * in `tests/topology.py`: the neighbors, plus the init()/complete()
+   * tree links, plus rank leader links with `rankreduce`.
+   * @param id The LP id.
+   * @returns The sorted LP ids.
+   */
+  std::vector<uint64_t> Links(uint64_t id) const
+  {
+    auto links = m_topology.neighbors(id);
+    if (m_topology.isFull()) return links;
+
+    if (0 != id) links.push_back(m_tree.parent(id));
+    auto kids = m_tree.children(id);
+    for (auto c = kids.first; c < kids.second && c < m_number; ++c) links.push_back(c);
+    if (m_rankReduce)
+      {
+        const auto rank = Rank(id);
+        if (id == RankLeader(rank))
+          {
+            if (0 != rank) links.push_back(RankLeader(m_tree.parent(rank)));
+            auto ranks = m_tree.children(rank);
+            for (auto r = ranks.first; r < ranks.second && r < m_options.ranks; ++r)
+              {
+                links.push_back(RankLeader(r));
+              }
+          }
+      }
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+    return links;
+  }
+
+  /**
+   * Write the JSON model for the LPs on one rank, or all ranks.
+   * @param os The output stream.
+   * @param all Write every LP, otherwise only those on @c rank.
+   * @param rank The rank to write, if not @c all.
+   * @returns The number of links written.
+   */
+  uint64_t Write(std::ostream & os, bool all, uint32_t rank) const
+  {
+    os << "{\n"
+       << "  \"program_options\": {\n"
+       << "    \"timebase\": \"1ms\",\n"
+       << "    \"print-timing-info\": \"1\"\n"
+       << "  },\n"
+       << "  \"statistics_options\": {\n"
+       << "    \"statisticLoadLevel\": 1,\n"
+       << "    \"statisticOutput\": \"sst.statOutputCSV\"\n"
+       << "  },\n";
+
+    // Parameters are the same for every LP
+    std::stringstream ps;
+    const char * sep = "";
+    for (auto & kv : m_options.params)
+      {
+        ps << sep << "\n        \"" << kv.first << "\": \"" << kv.second << "\"";
+        sep = ",";
+      }
+    const std::string params = ps.str();
+
+    os << "  \"components\": [";
+    sep = "\n";
+    for (uint64_t i = 0; i < m_number; ++i)
+      {
+        const auto part = Partition(i);
+        if ( ! all && part / m_options.threads != rank) continue;
+        os << sep
+           << "    {\n"
+           << "      \"name\": \"phold_" << i << "\",\n"
+           << "      \"type\": \"" << m_options.type << "\",\n"
+           << "      \"partition\": {\"rank\": " << part / m_options.threads
+           << ", \"thread\": " << part % m_options.threads << "},\n"
+           << "      \"params\": {" << params << "\n      },\n"
+           << "      \"statistics\": [\n"
+           << "        {\"name\": \"SendCount\", \"params\": {\"rate\": \"0ms\"}},\n"
+           << "        {\"name\": \"RecvCount\", \"params\": {\"rate\": \"0ms\"}}\n"
+           << "      ]\n"
+           << "    }";
+        sep = ",\n";
+      }
+    os << "\n  ],\n";
+
+    uint64_t count {0};
+    os << "  \"links\": [";
+    sep = "\n";
+    for (uint64_t i = 0; i < m_number; ++i)
+      {
+        const auto ri = Rank(i);
+        if ( ! all && ri != rank) continue;
+        for (auto j : Links(i))
+          {
+            const auto rj = Rank(j);
+            // Each pair once: from the lower id, or from our side if j is remote
+            if (j < i && (all || rj == rank)) continue;
+            const auto lo = std::min<uint64_t>(i, j);
+            const auto hi = std::max<uint64_t>(i, j);
+            const auto lat = Seconds(m_latencies.Latency(lo, hi, Place(lo), Place(hi)));
+            os << sep
+               << "    {\"name\": \"link_" << lo << "_" << hi << "\", \"noCut\": false,\n"
+               << "     \"left\":  {\"component\": \"phold_" << lo << "\", \"port\": \"port_"
+               << hi << "\", \"latency\": \"" << lat << "\"},\n"
+               << "     \"right\": {\"component\": \"phold_" << hi << "\", \"port\": \"port_"
+               << lo << "\", \"latency\": \"" << lat << "\"}}";
+            sep = ",\n";
+            ++count;
+          }
+      }
+    os << "\n  ]\n}\n";
+    return count;
+  }
+
+private:
+
+  /**
+   * The smallest latency of any link between ranks, with the current
+   * placement.  This is the lookahead SST actually gets, which can be
+   * larger than Latencies::Lookahead() if no link lands in the
+   * smallest cross rank tier.
+   * @returns The latency, or infinity if no link crosses ranks.
+   */
+  double RankLatency() const
+  {
+    auto lookahead = std::numeric_limits<double>::infinity();
+    for (uint64_t i = 0; i < m_number; ++i)
+      {
+        const auto ri = Rank(i);
+        for (auto j : Links(i))
+          {
+            if (j < i || Rank(j) == ri) continue;
+            lookahead = std::min(lookahead, m_latencies.Latency(i, j, Place(i), Place(j)));
+          }
+      }
+    return lookahead;
+  }
+
+  /**
+   * Did the partitioner maximize the lookahead?  Only the `graph`
+   * placement of a sparse topology does, see Phold::Partitioner.
+   */
+  bool LookaheadOptimized() const
+  {
+    return m_partitioner.getConfig().kind == Phold::Partitioner::Kind::GRAPH
+      && ! m_topology.isFull();
+  }
+
+  /** @returns The formatted placement lookahead, or "none" with one rank. */
+  std::string RankLookahead() const
+  {
+    if (m_rankLatency == std::numeric_limits<double>::infinity()) return "none";
+    return Seconds(m_rankLatency);
+  }
+
+  /**
+   * Look up a parameter, without adding it.
+   * @param params The parameters.
+   * @param key The parameter name.
+   * @returns The value, or empty if not given.
+   */
+  static std::string Get(const std::map<std::string, std::string> & params,
+                         const std::string & key)
+  {
+    auto it = params.find(key);
+    return it == params.end() ? std::string() : it->second;
+  }
+
+  /**
+   * Format a latency, as tests/phold.py, in the TIMEBASE units.
+   * @param latency The latency.
+   * @returns The SST time string.
+   */
+  static std::string Seconds(double latency)
+  {
+    std::ostringstream ss;
+    ss << latency << " s";
+    return ss.str();
+  }
+
+  /**
+   * Parse an unsigned option value.
+   * @param value The string value, possibly empty.
+   * @param def The default, if empty.
+   * @returns The value.
+   */
+  static uint64_t ToUint(const std::string & value, uint64_t def)
+  {
+    return value.empty() ? def : std::strtoull(value.c_str(), nullptr, 10);
+  }
+
+  /**
+   * Fill in the defaults and build the Topology configuration.
+   * @param options The command line options; defaults are added to the params.
+   * @returns The topology configuration.
+   */
+  static Phold::Topology::Config MakeConfig(Options & options)
+  {
+    auto & p = options.params;
+    auto def = [&p](const std::string & key, const std::string & value)
+      {
+        if (p.find(key) == p.end()) p[key] = value;
+      };
+    def("number", "2");
+    def("minimum", "1");
+    def("thread", "1");
+    def("topology", "full");
+
+    Phold::Topology::Config config;
+    if ( ! Phold::Topology::Parse(p["topology"], config.kind))
+      {
+        std::cerr << "Unknown topology '" << p["topology"] << "'\n";
+        std::exit(1);
+      }
+    config.number    = ToUint(Get(p, "number"), 2);
+    config.dims      = Get(p, "dims");
+    config.neighbors = ToUint(Get(p, "neighbors"), 4);
+    config.seed      = ToUint(Get(p, "seed"), 1);
+    config.remotes   = ToUint(Get(p, "remotes"), 1);
+    config.group     = ToUint(Get(p, "group"), 0);
+    if (config.kind == Phold::Topology::Kind::HIERARCHICAL && 0 == config.group)
+      {
+        // As tests/phold.py, one group per thread
+        const uint64_t parts = uint64_t(options.ranks) * options.threads;
+        config.group = std::max<uint64_t>(1, config.number / parts);
+        p["group"] = std::to_string(config.group);
+      }
+    return config;
+  }
+
+  /**
+   * Build the Destinations configuration, as Phold.
+   * @param options The command line options.
+   * @returns The destinations.
+   */
+  static Phold::Destinations::Config MakeDestinations(Options & options)
+  {
+    const auto & p = options.params;
+    Phold::Destinations::Config config;
+    auto name = Get(p, "distribution");
+    if ( ! name.empty() && ! Phold::Destinations::Parse(name, config.kind))
+      {
+        std::cerr << "Unknown distribution '" << name << "'\n";
+        std::exit(1);
+      }
+    config.number = ToUint(Get(p, "number"), 2);
+    auto locality = Get(p, "locality");
+    if ( ! locality.empty()) config.locality = std::stod(locality);
+    auto zipf = Get(p, "zipf");
+    if ( ! zipf.empty()) config.exponent = std::stod(zipf);
+    config.localSize = ToUint(Get(p, "localsize"), 0);
+    if (0 == config.localSize)
+      {
+        // LPs per thread, as Phold assumes
+        const uint64_t threads = uint64_t(options.ranks) * options.threads;
+        config.localSize = std::max<uint64_t>(1, (config.number + threads - 1) / threads);
+      }
+    return config;
+  }
+
+  /**
+   * Build the Latencies configuration, as Phold.
+   * @param options The command line options.
+   * @returns The latencies.
+   */
+  static Phold::Latencies::Config MakeLatencies(const Options & options)
+  {
+    const auto & p = options.params;
+    Phold::Latencies::Config config;
+    auto name = Get(p, "linklatency");
+    if ( ! name.empty() && ! Phold::Latencies::Parse(name, config.kind))
+      {
+        std::cerr << "Unknown linklatency '" << name << "'\n";
+        std::exit(1);
+      }
+    auto tiers = Get(p, "tiers");
+    if ( ! tiers.empty() && ! Phold::Latencies::ParseTiers(tiers, config.tiers))
+      {
+        std::cerr << "Invalid tiers '" << tiers << "'\n";
+        std::exit(1);
+      }
+    auto minimum = Get(p, "minimum");
+    if ( ! minimum.empty()) config.minimum = std::stod(minimum);
+    auto thread = Get(p, "thread");
+    if ( ! thread.empty()) config.thread = std::stod(thread);
+    auto max = Get(p, "latencymax");
+    if ( ! max.empty()) config.max = std::stod(max);
+    config.ranksPerNode = static_cast<uint32_t>(ToUint(Get(p, "rankspernode"), 1));
+    config.seed         = ToUint(Get(p, "seed"), 1);
+    return config;
+  }
+
+  /**
+   * Build the Partitioner configuration.
+   * @param options The command line options.
+   * @returns The partitioner.
+   */
+  static Phold::Partitioner::Config MakePartitioner(const Options & options)
+  {
+    Phold::Partitioner::Config config;
+    if ( ! Phold::Partitioner::Parse(options.partition, config.kind))
+      {
+        std::cerr << "Unknown partition '" << options.partition << "'\n";
+        std::exit(1);
+      }
+    config.ranks = options.ranks;
+    config.threads = options.threads;
+    auto remote = Get(options.params, "remote");
+    if ( ! remote.empty()) config.remote = std::stod(remote);
+    return config;
+  }
+
+  Options &        m_options;        /**< The options. */
+  Phold::Topology  m_topology;       /**< The LP connectivity. */
+  KaryTree         m_tree;           /**< The init()/complete() tree. */
+  Phold::Destinations m_dests;       /**< The destination distribution. */
+  Phold::Partitioner  m_partitioner; /**< The LP placement. */
+  Phold::Latencies    m_latencies;   /**< The link latencies. */
+  Phold::Partitioner::Metrics m_metrics;  /**< The partition quality. */
+  /** Smallest latency between ranks with the placement, see RankLatency(). */
+  double           m_rankLatency;
+  uint64_t         m_number;         /**< Number of LPs. */
+  bool             m_rankReduce;     /**< Add rank leader links. */
+
+};  // class Model
+
+
+/**
+ * Write the JSON to a file, or stdout.
+ * @param model The model.
+ * @param file The file name, or `-` for stdout.
+ * @param all Write all ranks.
+ * @param rank The rank, if not @c all.
+ * @returns \c true on success.
+ */
+bool
+WriteFile(const Model & model, const std::string & file, bool all, uint32_t rank)
+{
+  if (file == "-")
+    {
+      model.Write(std::cout, all, rank);
+      return bool(std::cout);
+    }
+  std::ofstream os(file);
+  if ( ! os)
+    {
+      std::cerr << "Can't open " << file << " for writing\n";
+      return false;
+    }
+  auto links = model.Write(os, all, rank);
+  std::cerr << "Wrote " << file << ", " << links << " links\n";
+  return bool(os);
+}
+
+}  // anonymous namespace
+
+
+int
+main(int argc, char ** argv)
+{
+  Options options;
+  for (int a = 1; a < argc; ++a)
+    {
+      std::string arg(argv[a]);
+      if (arg == "--help" || arg == "-h" || arg.rfind("--", 0) != 0)
+        {
+          Usage(argv[0]);
+          return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+      auto eq = arg.find('=');
+      auto key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+      auto value = eq == std::string::npos ? std::string("true") : arg.substr(eq + 1);
+
+      if      (key == "output")  options.output  = value;
+      else if (key == "ranks")   options.ranks   = std::stoul(value);
+      else if (key == "threads") options.threads = std::stoul(value);
+      else if (key == "shards")  options.shards  = (value == "true" || value == "1");
+      else if (key == "jobs")    options.jobs    = std::stoul(value);
+      else if (key == "type")    options.type    = value;
+      else if (key == "partition") options.partition = value;
+      else if (key == "metrics") options.metrics = value;
+      else                       options.params[key] = value;
+    }
+  if (0 == options.ranks || 0 == options.threads)
+    {
+      std::cerr << "Need at least one rank and thread\n";
+      return 1;
+    }
+
+  Model model(options);
+  std::string why;
+  if ( ! model.isValid(why))
+    {
+      std::cerr << "Invalid model: " << why << "\n";
+      return 1;
+    }
+  model.Place();
+  model.ShowMetrics();
+  if ( ! options.metrics.empty())
+    {
+      std::ofstream os(options.metrics);
+      model.WriteMetrics(os);
+      if ( ! os)
+        {
+          std::cerr << "Can't write " << options.metrics << "\n";
+          return 1;
+        }
+    }
+
+  if ( ! options.shards)
+    {
+      auto file = options.output == "-" ? options.output : options.output + ".json";
+      return WriteFile(model, file, true, 0) ? 0 : 1;
+    }
+
+  if (options.output == "-")
+    {
+      std::cerr << "--shards needs --output\n";
+      return 1;
+    }
+
+  // Write the shards in parallel, each job taking the next rank
+  unsigned jobs = options.jobs ? options.jobs : std::thread::hardware_concurrency();
+  jobs = std::max(1u, std::min(jobs, options.ranks));
+  std::atomic<uint32_t> next {0};
+  std::atomic<bool> ok {true};
+  std::vector<std::thread> workers;
+  for (unsigned j = 0; j < jobs; ++j)
+    {
+      workers.emplace_back([&]()
+        {
+          for (uint32_t r = next++; r < options.ranks; r = next++)
+            {
+              auto file = options.output + "_" + std::to_string(r) + ".json";
+              if ( ! WriteFile(model, file, false, r)) ok = false;
+            }
+        });
+    }
+  for (auto & w : workers) w.join();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,609 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#include "Checksum.h"
+#include "Destinations.h"
+#include "PendingEvents.h"
+#include "SamplingPolicy.h"
+
+#include <algorithm>  // max(), min()
+#include <atomic>
+#include <chrono>
+#include <cinttypes>  // PRIx64
+#include <cstdint>
+#include <cstdio>     // snprintf()
+#include <cstdlib>    // strtod(), strtoull()
+#include <iomanip>    // setw()
+#include <iostream>
+#include <limits>
+#include <queue>      // priority_queue
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * Stand-alone PHOLD event engine, for a baseline event rate.
+ *
+ * Runs the same workload as Phold::SendEventT() and Phold::handleEvent(),
+ * with the same generator draws in the same order, on a plain pending
+ * event set, with none of the SST core: no links, no event objects,
+ * no time vortex.  Comparing the rate here to a Phold run with the same
+ * parameters shows how much of the run time goes to the simulator.
+ *
+ * Usage:
+ * \code
+ *   phold-engine [--number=N] [--events=E] [--remote=R] [--minimum=M]
+ *                [--average=A] [--stop=S] [--threads=T] [--seed=X]
+ *                [--queue=heap|pairing|calendar|ladder|all] [--check]
+ * \endcode
+ *
+ * Option      | Meaning
+ * ----------- | --------------------------------------------------
+ * `--number`  | Number of LPs (default 2)
+ * `--events`  | Initial events per LP (default 1)
+ * `--remote`  | Fraction of events sent to another LP (default 0.9)
+ * `--minimum` | Minimum delay, s; the lookahead (default 1)
+ * `--average` | Mean additional exponential delay, s (default 9)
+ * `--stop`    | Stop time, s (default 10)
+ * `--threads` | Number of threads (default 1)
+ * `--seed`    | Generator seed (default 1)
+ * `--queue`   | Pending event set, or `all` to compare them (default `all`)
+ * `--check`   | Check each set against std::priority_queue first
+ *
+ * Times are in the units of tests/phold.py, and converted to the
+ * Phold 1 ms time base, so the delays are drawn as in Phold with the
+ * default uniform destinations, exponential delays, and the Philox
+ * generator.  The committed event checksum is computed as Phold's.
+ * The checksum doesn't depend on the order events are handled, but which
+ * events are committed before `stop` can depend on how ties at the same
+ * time are broken, which SST doesn't fix.  So the two checksums agree
+ * only when no events share a time at the stop boundary.
+ *
+ * With more than one thread each thread has a linear block of LPs,
+ * and its own pending event set.  Threads run in conservative windows
+ * one `minimum` long: every event sent in a window is received after it,
+ * so the only synchronization is two barriers per window.  Events for
+ * another thread are batched during the window, then pushed onto that
+ * thread's lock free inbox.
+ */
+
+namespace {
+
+/** Phold time base units per second, as Phold with the 1 ms time base. */
+constexpr double TIMEFACTOR {1e3};
+
+/** Command line options. */
+struct Options
+{
+  uint64_t    number  {2};      /**< Number of LPs. */
+  uint64_t    events  {1};      /**< Initial events per LP. */
+  double      remote  {0.9};    /**< Remote fraction. */
+  double      minimum {1.0};    /**< Minimum delay, s. */
+  double      average {9.0};    /**< Mean additional delay, s. */
+  double      stop    {10.0};   /**< Stop time, s. */
+  std::size_t threads {1};      /**< Number of threads. */
+  uint32_t    seed    {1};      /**< Generator seed. */
+  std::string queue   {"all"};  /**< Pending event set. */
+  bool        check   {false};  /**< Check the sets first. */
+};
+
+
+/** Print the usage message. */
+void
+Usage(const char * argv0)
+{
+  std::cerr << "Usage: " << argv0 << " [--number=N] [--events=E] [--remote=R] [--minimum=M]\n"
+            << "         [--average=A] [--stop=S] [--threads=T] [--seed=X]\n"
+            << "         [--queue=heap|pairing|calendar|ladder|all] [--check]\n"
+            << "Run the PHOLD workload without SST, for a baseline event rate.\n";
+}
+
+
+/** Run parameters, in time base units. */
+struct Model
+{
+  uint64_t number;    /**< Number of LPs. */
+  uint64_t events;    /**< Initial events per LP. */
+  double   remote;    /**< Remote fraction. */
+  uint64_t minimum;   /**< Minimum delay. */
+  double   mean;      /**< Mean additional delay. */
+  uint64_t stop;      /**< Stop time. */
+  uint32_t seed;      /**< Generator seed. */
+  std::size_t threads;  /**< Number of threads. */
+};
+
+
+/** Run results. */
+struct Totals
+{
+  uint64_t sends      {0};  /**< Events sent, to be received before stop. */
+  uint64_t recvs      {0};  /**< Events received. */
+  uint64_t checksum   {0};  /**< Committed event checksum. */
+  uint64_t windows    {0};  /**< Synchronization windows. */
+  uint64_t maxPending {0};  /**< Largest pending set, over threads. */
+  double   wall       {0};  /**< Wall clock time, s. */
+};
+
+
+/** Per LP state. */
+struct Lp
+{
+  Phold::PhiloxRng rng;  /**< Generator, as in PholdT::m_rng. */
+  uint64_t seq {0};      /**< Events sent. */
+
+  Lp(uint32_t seed, uint64_t id, double mean)
+    : rng(seed, id, mean)
+  {
+  }
+};
+
+
+/**
+ * Lock free inbox, with many producers and one consumer.
+ * Producers push whole batches; the consumer takes them all at once.
+ */
+class Inbox
+{
+public:
+  ~Inbox()
+  {
+    Drain([](const Phold::PendingEvents::Event &) {});
+  }
+
+  /**
+   * Add a batch.
+   * @param events The batch, moved from.
+   */
+  void Push(std::vector<Phold::PendingEvents::Event> && events)
+  {
+    auto node = new Node {std::move(events), m_head.load(std::memory_order_relaxed)};
+    while ( ! m_head.compare_exchange_weak(node->next, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed))
+      ;
+  }
+
+  /**
+   * Take every batch.
+   * @param f Called with each event.
+   */
+  template <class F>
+  void Drain(F f)
+  {
+    auto node = m_head.exchange(nullptr, std::memory_order_acquire);
+    while (node)
+      {
+        for (const auto & e : node->events) f(e);
+        auto next = node->next;
+        delete node;
+        node = next;
+      }
+  }
+
+private:
+  /** A batch. */
+  struct Node
+  {
+    std::vector<Phold::PendingEvents::Event> events;  /**< The events. */
+    Node * next;                                      /**< Next batch. */
+  };
+
+  std::atomic<Node *> m_head {nullptr};  /**< Most recent batch. */
+
+};  // class Inbox
+
+
+/** Sense reversing spin barrier. */
+class SpinBarrier
+{
+public:
+  /** @param count The number of threads. */
+  explicit SpinBarrier(std::size_t count)
+    : m_count(count)
+  {
+  }
+
+  /** Wait for every thread. */
+  void Wait()
+  {
+    const auto phase = m_phase.load(std::memory_order_acquire);
+    if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count)
+      {
+        m_waiting.store(0, std::memory_order_relaxed);
+        m_phase.fetch_add(1, std::memory_order_release);
+      }
+    else
+      {
+        while (m_phase.load(std::memory_order_acquire) == phase) std::this_thread::yield();
+      }
+  }
+
+private:
+  const std::size_t         m_count;         /**< Number of threads. */
+  std::atomic<std::size_t>  m_waiting {0};   /**< Threads waiting. */
+  std::atomic<uint64_t>     m_phase {0};     /**< Incremented when all arrive. */
+
+};  // class SpinBarrier
+
+
+/**
+ * One thread's LPs and pending events.
+ * @tparam Queue The pending event set.
+ */
+template <class Queue>
+struct alignas(64) Worker
+{
+  Queue       pending;                 /**< Pending events. */
+  Inbox       inbox;                   /**< Events from other threads. */
+  std::vector<std::vector<Phold::PendingEvents::Event> > outgoing;  /**< Batches, by thread. */
+  uint64_t    next {0};                /**< Earliest pending time, published each window. */
+  Totals      totals;                  /**< This thread's results. */
+};
+
+
+/**
+ * The engine.
+ * @tparam Queue The pending event set.
+ */
+template <class Queue>
+class Engine
+{
+public:
+  /** @param model The run parameters. */
+  explicit Engine(const Model & model)
+    : m_model(model),
+      m_dests(Phold::Destinations::Config {Phold::Destinations::Kind::UNIFORM,
+                                           model.number, 0.9, 1, 1.0}),
+      m_workers(model.threads),
+      m_barrier(model.threads)
+  {
+    m_lps.reserve(m_model.number);
+    for (uint64_t id = 0; id < m_model.number; ++id)
+      {
+        m_lps.emplace_back(m_model.seed, id, m_model.mean);
+      }
+    for (auto & w : m_workers) w.outgoing.resize(m_model.threads);
+  }
+
+  /** @returns The results. */
+  Totals Run()
+  {
+    auto start = std::chrono::steady_clock::now();
+    if (1 == m_model.threads)
+      {
+        Work(0);
+      }
+    else
+      {
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < m_model.threads; ++t) threads.emplace_back(&Engine::Work, this, t);
+        for (auto & t : threads) t.join();
+      }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    Totals totals;
+    for (const auto & w : m_workers)
+      {
+        totals.sends    += w.totals.sends;
+        totals.recvs    += w.totals.recvs;
+        totals.checksum += w.totals.checksum;
+        totals.windows   = std::max(totals.windows, w.totals.windows);
+        totals.maxPending = std::max(totals.maxPending, w.totals.maxPending);
+      }
+    totals.wall = wall.count();
+    return totals;
+  }
+
+private:
+
+  /** @returns The thread which owns LP \c id. */
+  std::size_t Owner(uint64_t id) const
+  {
+    return static_cast<std::size_t>(id * m_model.threads / m_model.number);
+  }
+
+  /** @returns The first LP owned by \c thread. */
+  uint64_t First(std::size_t thread) const
+  {
+    return (thread * m_model.number + m_model.threads - 1) / m_model.threads;
+  }
+
+  /**
+   * Send a new event from an LP, as Phold::SendEventT().
+   * @param self The worker.
+   * @param thread The worker's thread.
+   * @param id The sending LP.
+   * @param now The current time.
+   */
+  void Send(Worker<Queue> & self, std::size_t thread, uint64_t id, uint64_t now)
+  {
+    auto & lp = m_lps[id];
+    uint64_t dst = id;
+    if (Phold::RandomDestination::IsRemote(lp.rng, m_model.remote))
+      {
+        unsigned reps = 0;
+        dst = Phold::RandomDestination::Any(lp.rng, m_dests, id, reps);
+      }
+    const auto recv = now + Phold::ExponentialDelay::Draw(lp.rng, m_model.mean) + m_model.minimum;
+    const auto seq = lp.seq++;
+    // Phold sends these too, but they are never received
+    if (recv >= m_model.stop) return;
+
+    ++self.totals.sends;
+    self.totals.checksum += Phold::EventHash(id, dst, now, recv);
+    const Phold::PendingEvents::Event e {recv, dst, id, seq, now};
+    const auto owner = Owner(dst);
+    if (owner == thread) self.pending.Push(e);
+    else                 self.outgoing[owner].push_back(e);
+  }
+
+  /**
+   * Handle events before \c end.
+   * @param self The worker.
+   * @param thread The worker's thread.
+   * @param end The end of the window.
+   */
+  void Handle(Worker<Queue> & self, std::size_t thread, uint64_t end)
+  {
+    auto & pending = self.pending;
+    while ( ! pending.Empty() && pending.Top().time < end)
+      {
+        const auto e = pending.Pop();
+        ++self.totals.recvs;
+        Send(self, thread, e.dst, e.time);
+        self.totals.maxPending = std::max<uint64_t>(self.totals.maxPending, pending.Size());
+      }
+  }
+
+  /**
+   * Run one thread.
+   * @param thread The thread.
+   */
+  void Work(std::size_t thread)
+  {
+    auto & self = m_workers[thread];
+    for (auto id = First(thread); id < First(thread + 1); ++id)
+      {
+        for (uint64_t i = 0; i < m_model.events; ++i) Send(self, thread, id, 0);
+      }
+    if (1 == m_model.threads)
+      {
+        Handle(self, thread, m_model.stop);
+        self.totals.windows = 1;
+        return;
+      }
+
+    while (true)
+      {
+        for (std::size_t t = 0; t < m_model.threads; ++t)
+          {
+            auto & batch = self.outgoing[t];
+            if (batch.empty()) continue;
+            m_workers[t].inbox.Push(std::move(batch));
+            batch.clear();
+          }
+        m_barrier.Wait();
+        self.inbox.Drain([&self](const Phold::PendingEvents::Event & e) { self.pending.Push(e); });
+        self.next = self.pending.Empty() ? std::numeric_limits<uint64_t>::max()
+          : self.pending.Top().time;
+        m_barrier.Wait();
+        auto next = std::numeric_limits<uint64_t>::max();
+        // No one changes their next until everyone reaches the first barrier
+        for (const auto & w : m_workers) next = std::min(next, w.next);
+        if (next >= m_model.stop) break;
+        ++self.totals.windows;
+        Handle(self, thread, std::min(m_model.stop, next + m_model.minimum));
+      }
+  }
+
+  const Model                    m_model;    /**< Run parameters. */
+  const Phold::Destinations      m_dests;    /**< Destination distribution. */
+  std::vector<Lp>                m_lps;      /**< The LPs. */
+  std::vector<Worker<Queue> >    m_workers;  /**< The threads. */
+  SpinBarrier                    m_barrier;  /**< Window barrier. */
+
+};  // class Engine
+
+
+/**
+ * Check a pending event set against std::priority_queue,
+ * with a hold model: pop one, push one or two later.
+ * @tparam Queue The pending event set.
+ * @returns \c true if every pop agrees.
+ */
+template <class Queue>
+bool
+Check()
+{
+  Queue queue;
+  std::priority_queue<Phold::PendingEvents::Event,
+                      std::vector<Phold::PendingEvents::Event>,
+                      Phold::PendingEvents::Later> reference;
+  Phold::PhiloxRng rng(1, 0, 100.0);
+  uint64_t seq {0};
+  auto push = [&](uint64_t time)
+    {
+      const Phold::PendingEvents::Event e {time, seq % 7, seq % 3, seq, 0};
+      ++seq;
+      queue.Push(e);
+      reference.push(e);
+    };
+  for (int i = 0; i < 1000; ++i) push(static_cast<uint64_t>(rng.nextExponential()));
+  for (int i = 0; i < 200000; ++i)
+    {
+      if (queue.Size() != reference.size() || queue.Top().time != reference.top().time) return false;
+      const auto e = queue.Pop();
+      const auto & r = reference.top();
+      if (e.time != r.time || e.seq != r.seq) return false;
+      reference.pop();
+      // Grow, then shrink, to exercise any resizing
+      const auto pushes = (i / 50000) % 2 ? (i % 3 ? 1 : 0) : (i % 3 ? 1 : 2);
+      for (int p = 0; p < pushes; ++p)
+        {
+          // Some ties, and some far in the future
+          const auto delay = i % 17 ? static_cast<uint64_t>(rng.nextExponential())
+            : (i % 2 ? 0 : 100000);
+          push(e.time + delay);
+        }
+      if (reference.empty()) push(e.time + 1);
+    }
+  return true;
+}
+
+
+/**
+ * Run one pending event set.
+ * @tparam Queue The pending event set.
+ * @param model The run parameters.
+ * @param check Check the set first.
+ * @param [out] totals The results.
+ * @returns \c false if the check failed.
+ */
+template <class Queue>
+bool
+Run(const Model & model, bool check, Totals & totals)
+{
+  if (check)
+    {
+      const bool ok = Check<Queue>();
+      std::cout << "    Check " << std::setw(10) << Queue::Name() << ": "
+                << (ok ? "ok" : "FAILED") << "\n";
+      if ( ! ok) return false;
+    }
+  Engine<Queue> engine(model);
+  totals = engine.Run();
+  return true;
+}
+
+}  // anonymous namespace
+
+
+int
+main(int argc, char ** argv)
+{
+  Options options;
+  for (int a = 1; a < argc; ++a)
+    {
+      std::string arg(argv[a]);
+      if (arg == "--help" || arg == "-h")
+        {
+          Usage(argv[0]);
+          return 0;
+        }
+      auto eq = arg.find('=');
+      if (arg.rfind("--", 0) != 0)
+        {
+          Usage(argv[0]);
+          return 1;
+        }
+      auto key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+      auto value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+      auto text = value.c_str();
+      if      (key == "number")  options.number  = std::strtoull(text, nullptr, 10);
+      else if (key == "events")  options.events  = std::strtoull(text, nullptr, 10);
+      else if (key == "remote")  options.remote  = std::strtod(text, nullptr);
+      else if (key == "minimum") options.minimum = std::strtod(text, nullptr);
+      else if (key == "average") options.average = std::strtod(text, nullptr);
+      else if (key == "stop")    options.stop    = std::strtod(text, nullptr);
+      else if (key == "threads") options.threads = std::strtoull(text, nullptr, 10);
+      else if (key == "seed")    options.seed    = static_cast<uint32_t>(std::strtoul(text, nullptr, 10));
+      else if (key == "queue")   options.queue   = value;
+      else if (key == "check")   options.check   = true;
+      else
+        {
+          Usage(argv[0]);
+          return 1;
+        }
+    }
+
+  Model model {options.number, options.events, options.remote,
+               static_cast<uint64_t>(options.minimum * TIMEFACTOR),
+               options.average * TIMEFACTOR,
+               static_cast<uint64_t>(options.stop * TIMEFACTOR),
+               options.seed, options.threads};
+  std::string why;
+  if      (model.number < 2)                         why = "number must be at least 2";
+  else if (options.remote < 0 || options.remote > 1) why = "remote must be in [0, 1]";
+  else if (0 == model.minimum)                       why = "minimum must be at least 1 ms";
+  else if (options.average < 0)                      why = "average must be >= 0";
+  else if (0 == model.threads)                       why = "threads must be at least 1";
+  else if (model.threads > model.number)             why = "threads must be at most number";
+  if ( ! why.empty())
+    {
+      std::cerr << "Invalid options: " << why << "\n";
+      Usage(argv[0]);
+      return 1;
+    }
+
+  const std::vector<std::string> names {"heap", "pairing", "calendar", "ladder"};
+  std::vector<std::string> queues;
+  if (options.queue == "all") queues = names;
+  else if (std::find(names.begin(), names.end(), options.queue) != names.end())
+    {
+      queues.push_back(options.queue);
+    }
+  else
+    {
+      std::cerr << "Unknown queue: " << options.queue << "\n";
+      Usage(argv[0]);
+      return 1;
+    }
+
+  std::cout << "PHOLD event engine:"
+            << "\n    Number of LPs:                        " << model.number
+            << "\n    Initial events per LP:                " << model.events
+            << "\n    Remote fraction:                      " << model.remote
+            << "\n    Minimum delay (s):                    " << options.minimum
+            << "\n    Average additional delay (s):         " << options.average
+            << "\n    Stop time (s):                        " << options.stop
+            << "\n    Threads:                              " << model.threads
+            << "\n    Seed:                                 " << model.seed
+            << "\n\n";
+
+  std::cout << "    " << std::setw(10) << "Queue" << std::setw(14) << "Events"
+            << std::setw(12) << "Wall (s)" << std::setw(16) << "Events/s"
+            << std::setw(10) << "Windows" << std::setw(12) << "Max pending"
+            << std::setw(20) << "Checksum" << "\n";
+  uint64_t checksum {0};
+  bool agree {true};
+  for (std::size_t q = 0; q < queues.size(); ++q)
+    {
+      const auto & name = queues[q];
+      Totals totals;
+      bool ok {true};
+      if      (name == "heap")     ok = Run<Phold::PendingEvents::BinaryHeap>(model, options.check, totals);
+      else if (name == "pairing")  ok = Run<Phold::PendingEvents::PairingHeap>(model, options.check, totals);
+      else if (name == "calendar") ok = Run<Phold::PendingEvents::CalendarQueue>(model, options.check, totals);
+      else if (name == "ladder")   ok = Run<Phold::PendingEvents::LadderQueue>(model, options.check, totals);
+      if ( ! ok) return 1;
+
+      char hex[20];
+      std::snprintf(hex, sizeof(hex), "%016" PRIx64, totals.checksum);
+      std::cout << "    " << std::setw(10) << name << std::setw(14) << totals.recvs
+                << std::setw(12) << std::fixed << std::setprecision(3) << totals.wall
+                << std::setw(16) << std::setprecision(0) << totals.recvs / std::max(totals.wall, 1e-9)
+                << std::setw(10) << totals.windows << std::setw(12) << totals.maxPending
+                << std::setw(20) << hex << "\n";
+      std::cout.unsetf(std::ios::fixed);
+      std::cout << std::setprecision(6);
+
+      if (totals.sends != totals.recvs) agree = false;
+      if (q > 0 && totals.checksum != checksum) agree = false;
+      checksum = totals.checksum;
+    }
+  if ( ! agree)
+    {
+      std::cout << "\nQueues disagree\n";
+      return 1;
+    }
+  std::cout << "\nCommitted event checksum: " << std::hex << std::setw(16)
+            << std::setfill('0') << checksum << std::dec << std::setfill(' ') << "\n";
+
+  return 0;
+}
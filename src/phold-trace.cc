@@ -0,0 +1,265 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+#include "Trace.h"
+
+#include <algorithm>  // max(), min(), partial_sort(), sort()
+#include <cstdint>
+#include <cstdlib>    // strtoull()
+#include <iomanip>    // setw()
+#include <iostream>
+#include <map>
+#include <memory>     // unique_ptr
+#include <string>
+#include <unordered_map>
+#include <utility>    // pair
+#include <vector>
+
+/**
+ * \file
+ * PHOLD event trace summarizer.
+ *
+ * Reads the binary traces written by Phold with the `trace` parameter,
+ * memory mapped, and reports the traffic per LP and per LP pair,
+ * the delay distribution, and the critical path.
+ *
+ * Usage:
+ * \code
+ *   phold-trace [--top=N] [--bins=B] <file>.trace ...
+ * \endcode
+ *
+ * Option     | Meaning
+ * ---------- | --------------------------------------------------
+ * `--top`    | Number of busiest LPs and LP pairs to list (default 10)
+ * `--bins`   | Number of delay histogram bins (default 20)
+ *
+ * Pass all the files from a run (for example `phold_*.trace`) to
+ * see the whole model.
+ *
+ * The critical path is the longest chain of events, each sent by the
+ * LP when it handled the previous one.  An LP sends when it handles an
+ * event, so the parent of a record is the latest chain ending at its
+ * `src` at its `send` time.  The number of events divided by the
+ * critical path length is the average parallelism available to any
+ * scheduler, conservative or optimistic.
+ */
+
+namespace {
+
+/** Command line options. */
+struct Options
+{
+  std::size_t top  {10};  /**< LPs and pairs to list. */
+  std::size_t bins {20};  /**< Delay histogram bins. */
+  std::vector<std::string> files;  /**< Trace files. */
+};
+
+
+/** Print the usage message. */
+void
+Usage(const char * argv0)
+{
+  std::cerr << "Usage: " << argv0 << " [--top=N] [--bins=B] <file>.trace ...\n"
+            << "Summarize PHOLD event traces, written with the 'trace' parameter.\n";
+}
+
+
+/** Per LP counts. */
+struct LpCounts
+{
+  uint64_t sends {0};  /**< Events sent. */
+  uint64_t recvs {0};  /**< Events received. */
+  uint64_t bytes {0};  /**< Payload bytes sent. */
+};
+
+
+/** Hash for (LP, time) and (src, dst) keys. */
+struct PairHash
+{
+  std::size_t operator()(const std::pair<uint64_t, uint64_t> & p) const
+  {
+    return std::hash<uint64_t>()(p.first * 0x9e3779b97f4a7c15ULL ^ p.second);
+  }
+};
+
+}  // anonymous namespace
+
+
+int
+main(int argc, char ** argv)
+{
+  Options options;
+  for (int a = 1; a < argc; ++a)
+    {
+      std::string arg(argv[a]);
+      if (arg == "--help" || arg == "-h")
+        {
+          Usage(argv[0]);
+          return 0;
+        }
+      if (arg.rfind("--", 0) != 0)
+        {
+          options.files.push_back(arg);
+          continue;
+        }
+      auto eq = arg.find('=');
+      auto key = arg.substr(2, eq == std::string::npos ? std::string::npos : eq - 2);
+      auto value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+      if      (key == "top")  options.top  = std::strtoull(value.c_str(), nullptr, 10);
+      else if (key == "bins") options.bins = std::strtoull(value.c_str(), nullptr, 10);
+      else
+        {
+          Usage(argv[0]);
+          return 1;
+        }
+    }
+  if (options.files.empty() || 0 == options.bins)
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+
+  // Map every file
+  std::vector<std::unique_ptr<Phold::Trace::Reader> > readers;
+  std::size_t total {0};
+  double timeFactor {0};
+  for (auto & file : options.files)
+    {
+      readers.emplace_back(new Phold::Trace::Reader(file));
+      std::string why;
+      if ( ! readers.back()->isValid(why))
+        {
+          std::cerr << "Invalid trace " << file << ": " << why << "\n";
+          return 1;
+        }
+      const auto & h = readers.back()->header();
+      timeFactor = h.timeFactor;
+      total += readers.back()->size();
+      std::cout << file << ": rank " << h.rank << ", thread " << h.thread
+                << ", " << readers.back()->size() << " records\n";
+    }
+  if (0 == total)
+    {
+      std::cout << "No records\n";
+      return 0;
+    }
+
+  // One pass for the counts, and the index for the critical path
+  std::vector<const Phold::Trace::Record *> bySend;
+  bySend.reserve(total);
+  std::map<uint64_t, LpCounts> lps;
+  std::unordered_map<std::pair<uint64_t, uint64_t>, uint64_t, PairHash> pairs;
+  uint64_t local {0};
+  uint64_t bytes {0};
+  uint64_t first {UINT64_MAX};
+  uint64_t last {0};
+  uint64_t minDelay {UINT64_MAX};
+  uint64_t maxDelay {0};
+  for (auto & reader : readers)
+    {
+      for (auto r = reader->begin(); r != reader->end(); ++r)
+        {
+          bySend.push_back(r);
+          auto & src = lps[r->src];
+          ++src.sends;
+          src.bytes += r->bytes;
+          ++lps[r->dst].recvs;
+          ++pairs[{r->src, r->dst}];
+          if (r->flags & Phold::Trace::LOCAL) ++local;
+          bytes += r->bytes;
+          first = std::min(first, r->send);
+          last = std::max(last, r->recv);
+          const auto delay = r->recv - r->send;
+          minDelay = std::min(minDelay, delay);
+          maxDelay = std::max(maxDelay, delay);
+        }
+    }
+
+  std::cout << "\nEvents:"
+            << "\n    Records:                              " << total
+            << "\n    LPs:                                  " << lps.size()
+            << "\n    Local (to self):                      " << 100.0 * local / total << " %"
+            << "\n    Payload bytes:                        " << bytes
+            << "\n    Time span (s):                        " << first * timeFactor
+            << " - " << last * timeFactor
+            << "\n    LP pairs with traffic:                " << pairs.size()
+            << "\n";
+
+  // Busiest LPs, by receives
+  std::vector<std::pair<uint64_t, LpCounts> > byLp(lps.begin(), lps.end());
+  auto top = std::min(options.top, byLp.size());
+  std::partial_sort(byLp.begin(), byLp.begin() + top, byLp.end(),
+                    [](const std::pair<uint64_t, LpCounts> & a,
+                       const std::pair<uint64_t, LpCounts> & b)
+                    { return a.second.recvs > b.second.recvs; });
+  std::cout << "\nBusiest LPs, by receives:\n"
+            << "    " << std::setw(10) << "LP" << std::setw(14) << "Receives"
+            << std::setw(14) << "Sends" << std::setw(16) << "Bytes sent" << "\n";
+  for (std::size_t i = 0; i < top; ++i)
+    {
+      const auto & lp = byLp[i];
+      std::cout << "    " << std::setw(10) << lp.first << std::setw(14) << lp.second.recvs
+                << std::setw(14) << lp.second.sends << std::setw(16) << lp.second.bytes << "\n";
+    }
+
+  // Busiest pairs
+  std::vector<std::pair<std::pair<uint64_t, uint64_t>, uint64_t> > byPair(pairs.begin(), pairs.end());
+  top = std::min(options.top, byPair.size());
+  std::partial_sort(byPair.begin(), byPair.begin() + top, byPair.end(),
+                    [](const std::pair<std::pair<uint64_t, uint64_t>, uint64_t> & a,
+                       const std::pair<std::pair<uint64_t, uint64_t>, uint64_t> & b)
+                    { return a.second > b.second; });
+  std::cout << "\nBusiest LP pairs:\n"
+            << "    " << std::setw(10) << "Source" << std::setw(10) << "Dest"
+            << std::setw(14) << "Events" << std::setw(10) << "Share" << "\n";
+  for (std::size_t i = 0; i < top; ++i)
+    {
+      const auto & p = byPair[i];
+      std::cout << "    " << std::setw(10) << p.first.first << std::setw(10) << p.first.second
+                << std::setw(14) << p.second
+                << std::setw(8) << 100.0 * p.second / total << " %\n";
+    }
+
+  // Delay histogram
+  std::vector<uint64_t> hist(options.bins, 0);
+  const double width = std::max<double>(1, double(maxDelay - minDelay + 1) / options.bins);
+  for (auto r : bySend)
+    {
+      auto bin = static_cast<std::size_t>((r->recv - r->send - minDelay) / width);
+      ++hist[std::min(bin, options.bins - 1)];
+    }
+  std::cout << "\nDelay (s):\n";
+  for (std::size_t b = 0; b < options.bins; ++b)
+    {
+      if (0 == hist[b]) continue;
+      std::cout << "    " << std::setw(14) << (minDelay + b * width) * timeFactor
+                << std::setw(14) << hist[b] << "\n";
+    }
+
+  // Critical path, in send order: every parent is received before its children are sent
+  std::sort(bySend.begin(), bySend.end(),
+            [](const Phold::Trace::Record * a, const Phold::Trace::Record * b)
+            { return a->send < b->send; });
+  std::unordered_map<std::pair<uint64_t, uint64_t>, uint64_t, PairHash> depthAt;
+  depthAt.reserve(total);
+  uint64_t critical {0};
+  for (auto r : bySend)
+    {
+      auto parent = depthAt.find({r->src, r->send});
+      const uint64_t depth = 1 + (parent == depthAt.end() ? 0 : parent->second);
+      auto & at = depthAt[{r->dst, r->recv}];
+      at = std::max(at, depth);
+      critical = std::max(critical, depth);
+    }
+  std::cout << "\nCritical path:"
+            << "\n    Length (events):                      " << critical
+            << "\n    Mean parallelism (events / length):   " << double(total) / critical
+            << "\n";
+
+  return 0;
+}
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2021 Lawrence Livermore National Laboratory
+ * All rights reserved.
+ *
+ * Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+ */
+
+
+#include "CounterRng.h"
+#include "Sampling.h"
+
+#include <algorithm>  // max()
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/**
+ * \file
+ * Check Phold::Ziggurat and Phold::BoundedInt against the default samplers,
+ * with deviates from CounterRng and from a 32-bit generator like SST's.
+ */
+
+namespace {
+
+/**
+ * 32-bit generator returning deviates as the SST generators do,
+ * an integer divided by `UINT32_MAX`, so in the closed interval `[0, 1]`.
+ * This is Marsaglia's xorshift32.
+ */
+class Closed32
+{
+public:
+  /** @param seed The seed, not 0. */
+  explicit Closed32(uint32_t seed) : m_x(seed) {}
+
+  /** @returns The next integer. */
+  uint32_t nextUInt32()
+  {
+    m_x ^= m_x << 13;
+    m_x ^= m_x >> 17;
+    m_x ^= m_x << 5;
+    return m_x;
+  }
+
+  /** @returns The next uniform deviate. */
+  double nextUniform()
+  {
+    return double(nextUInt32()) / double(UINT32_MAX);
+  }
+
+private:
+  uint32_t m_x;  /**< The state. */
+};
+
+/** Generator stub returning a fixed deviate. */
+struct Fixed
+{
+  double u;  /**< The deviate. */
+  /** @returns The deviate. */
+  double nextUniform() { return u; }
+};
+
+/** Summary of a set of exponential deviates. */
+struct Moments
+{
+  double mean {0};  /**< Sample mean. */
+  double var {0};   /**< Sample variance. */
+  double ks {0};    /**< Kolmogorov-Smirnov distance from the unit exponential. */
+};
+
+/**
+ * Summarize unit exponential deviates.
+ * @param draw Returns the next deviate.
+ * @param n The number of deviates.
+ * @returns The summary.
+ */
+template <class Draw>
+Moments
+Exponentials(Draw draw, std::size_t n)
+{
+  // Histogram on [0, 16) for the KS distance
+  constexpr std::size_t bins {1 << 12};
+  constexpr double top {16};
+  std::vector<uint64_t> counts(bins + 1, 0);
+  double sum = 0, sum2 = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const double x = draw();
+      sum += x;
+      sum2 += x * x;
+      ++counts[std::min(static_cast<std::size_t>(x / top * bins), bins)];
+    }
+  Moments m;
+  m.mean = sum / n;
+  m.var = sum2 / n - m.mean * m.mean;
+  uint64_t below = 0;
+  for (std::size_t b = 0; b < bins; ++b)
+    {
+      below += counts[b];
+      const double edge = (b + 1) * top / bins;
+      m.ks = std::max(m.ks, std::abs(double(below) / n - (1 - std::exp(-edge))));
+    }
+  return m;
+}
+
+/**
+ * Chi-square statistic of integers in `[0, k)` against uniform.
+ * @param draw Returns the next integer.
+ * @param k The number of values.
+ * @param n The number of draws.
+ * @param [in,out] outside Incremented for each draw outside `[0, k)`.
+ * @returns The statistic, with `k - 1` degrees of freedom.
+ */
+template <class Draw>
+double
+ChiSquare(Draw draw, uint64_t k, std::size_t n, std::size_t & outside)
+{
+  std::vector<uint64_t> counts(k, 0);
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const uint64_t j = draw();
+      if (j < k) ++counts[j];
+      else       ++outside;
+    }
+  const double expect = double(n) / k;
+  double chi2 = 0;
+  for (auto c : counts) chi2 += (c - expect) * (c - expect) / expect;
+  return chi2;
+}
+
+}  // anonymous namespace
+
+
+int
+main (int argc, char** argv [[maybe_unused]])
+{
+  using namespace Phold;
+
+  bool all {argc > 1};
+  const std::size_t n { all ? 100000000u : 4000000u };
+  std::size_t errors {0};
+
+  CounterRng rng (1, 0, 1.0);
+  Closed32 closed (1);
+
+  // Exponential: the default log() transform and the ziggurat
+  const auto logs = Exponentials ([&rng]() { return -std::log (1.0 - rng.nextUniform ()); }, n);
+  const auto zigs = Exponentials ([&rng]() { return Ziggurat::Exponential (rng); }, n);
+
+  // KS 0.1% critical value is 1.95 / sqrt(n), plus the histogram resolution
+  const double ksMax = 1.95 / std::sqrt (double(n)) + 16.0 / (1 << 12) / 2;
+  // Standard errors of the mean and variance of a unit exponential
+  const double meanMax = 5 / std::sqrt (double(n));
+  const double varMax = 5 * std::sqrt (8.0 / n);
+
+  std::cout << "Exponential, " << n << " draws\n"
+            << "Sampler       Mean       Var        KS" << std::endl;
+  auto show = [&](const char * name, const Moments & m)
+    {
+      std::cout << std::left << std::setw (10) << name << std::right << std::fixed
+                << std::setprecision (6)
+                << std::setw (10) << m.mean
+                << std::setw (11) << m.var
+                << std::setw (10) << m.ks;
+      if (std::abs (m.mean - 1) > meanMax
+          || std::abs (m.var - 1) > varMax
+          || m.ks > ksMax)
+        {
+          std::cout << "  ?";
+          ++errors;
+        }
+      std::cout << std::endl;
+    };
+  show ("log", logs);
+  show ("ziggurat", zigs);
+  show ("zig32", Exponentials ([&closed]() { return Ziggurat::Exponential (closed); }, n));
+
+  // Bounded integers: the default scaling and BoundedInt
+  // Chi-square 0.1% critical value, Wilson-Hilferty approximation
+  auto chi2Max = [](double dof)
+    {
+      const double z = 3.09;
+      const double a = 2 / (9 * dof);
+      return dof * std::pow (1 - a + z * std::sqrt (a), 3);
+    };
+  std::cout << "\nBounded integer, " << n << " draws\n"
+            << "       k   Scaled chi2  Bounded chi2  32-bit chi2  Limit" << std::endl;
+  for (uint64_t k : {2u, 3u, 7u, 10u, 1000u, 65537u})
+    {
+      std::size_t outside = 0;
+      const double scaled = ChiSquare
+        ([&rng, k]() { return static_cast<uint64_t> (rng.nextUniform () * k); }, k, n, outside);
+      const double bounded = ChiSquare
+        ([&rng, k]() { return BoundedInt (rng, k); }, k, n, outside);
+      const double bounded32 = ChiSquare
+        ([&closed, k]() { return BoundedInt (closed, k); }, k, n, outside);
+      const double limit = chi2Max (k - 1);
+      std::cout << std::setw (8) << k
+                << std::setprecision (1)
+                << std::setw (14) << scaled
+                << std::setw (14) << bounded
+                << std::setw (13) << bounded32
+                << std::setw (10) << limit;
+      if (bounded > limit || bounded32 > limit || outside)
+        {
+          std::cout << "  ?";
+          ++errors;
+        }
+      std::cout << std::endl;
+    }
+
+  // Edge cases: one value, and the largest 32-bit and 64-bit ranges
+  std::size_t outside = 0;
+  for (std::size_t i = 0; i < 1000; ++i)
+    {
+      if (BoundedInt (rng, 1) != 0) ++outside;
+      if (BoundedInt (rng, UINT32_MAX) >= UINT32_MAX) ++outside;
+      if (BoundedInt (rng, uint64_t{1} << 40) >= uint64_t{1} << 40) ++outside;
+      if (BoundedInt (closed, UINT32_MAX) >= UINT32_MAX) ++outside;
+    }
+  // The 32-bit deviate 1.0, and the largest below 1
+  for (double u : {1.0, 1.0 - 0x1.0p-53})
+    {
+      Fixed fixed {u};
+      for (uint64_t k : {1u, 2u, 10u, 65537u, UINT32_MAX})
+        {
+          if (BoundedInt (fixed, k) != k - 1) ++outside;
+        }
+      if (Bits32 (u) != UINT32_MAX) ++outside;
+    }
+  // Bits32() recovers the 32-bit integer, exactly below the top 2^12 values
+  for (std::size_t i = 0; i < 1000000; ++i)
+    {
+      const uint32_t k = i < 4096 ? UINT32_MAX - i : closed.nextUInt32 ();
+      const uint32_t bits = Bits32 (double(k) / double(UINT32_MAX));
+      if (bits < k || bits - k > (k < UINT32_MAX - 4096 ? 0 : 1)) ++outside;
+    }
+  std::cout << "\nOut of range edge cases: " << outside << std::endl;
+  errors += outside;
+
+  std::cout << "\nErrors: " << errors << std::endl;
+  return errors ? 1 : 0;
+}
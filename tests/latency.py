@@ -0,0 +1,135 @@
+#!/bin/python3
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil; -*-
+#
+# Copyright (c) 2021 Lawrence Livermore National Laboratory
+# All rights reserved.
+#
+# Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+
+
+"""PHOLD link latencies.
+
+This mirrors the C++ Phold::Latencies class in src/Latencies.cc,
+so tests/phold.py and phold-config build links with the same latencies.
+"""
+
+import math
+
+from topology import _MASK64, _splitmix64
+
+KINDS = ['global', 'tier', 'uniform']
+
+# Placement tiers, in the order of the tiers option
+SAME_THREAD, SAME_RANK, SAME_NODE, REMOTE_NODE = range(4)
+
+
+def placement(i: int, number: int, ranks: int, threads: int) -> tuple:
+    """(rank, thread) of LP i, as placed by the SST linear partitioner.
+
+    This mirrors Phold::Partitioner::Linear().
+    """
+    parts = ranks * threads
+    per, extra = divmod(number, parts)
+    big = extra * (per + 1)
+    part = i // (per + 1) if i < big else extra + (i - big) // per
+    return divmod(part, threads)
+
+
+def parse_tiers(tiers: str) -> list:
+    """Parse "thread,rank,node,remote", or return None if invalid."""
+    try:
+        values = [float(t) for t in tiers.split(',')]
+    except ValueError:
+        return None
+    return values if len(values) == 4 else None
+
+
+def classify(a: tuple, b: tuple, ranks_per_node: int) -> int:
+    """Placement tier of the (rank, thread) pairs a and b."""
+    if a[0] == b[0]:
+        return SAME_THREAD if a[1] == b[1] else SAME_RANK
+    return SAME_NODE if a[0] // ranks_per_node == b[0] // ranks_per_node else REMOTE_NODE
+
+
+class Latencies:
+    """Link latency model.
+
+    Attributes
+    ----------
+    kind : str
+        One of KINDS.
+    minimum, thread, tiers, max, ranks_per_node, seed
+        As Phold::Latencies::Config.
+
+    Methods
+    -------
+    validate() -> str
+        Return an error description, or empty if valid.
+    latency(i, j, pi, pj) -> float
+        The latency of the link between LPs i and j, placed at pi and pj.
+    lookahead() -> float
+        The smallest latency of any link between ranks.
+    """
+
+    # pylint: disable=too-many-arguments
+
+    def __init__(self, kind: str, minimum: float = 1, thread: float = 1,
+                 tiers: str = '1,1,1,1', maximum: float = 10,
+                 ranks_per_node: int = 1, seed: int = 1):
+        self.kind = kind
+        self.minimum = minimum
+        self.thread = thread
+        self.tiers = parse_tiers(tiers)
+        self.max = maximum
+        self.ranks_per_node = ranks_per_node
+        self.seed = seed
+
+    def __str__(self) -> str:
+        if self.kind == 'tier':
+            tiers = ', '.join(f"{t:g}" for t in self.tiers)
+            return f"tier ({tiers}, {self.ranks_per_node} ranks per node)"
+        if self.kind == 'uniform':
+            return f"uniform [{self.minimum:g}, {self.max:g}]"
+        return f"global ({self.thread:g} within ranks, {self.minimum:g} between)"
+
+    def validate(self) -> str:
+        """Check the configuration, as Phold::Latencies::isValid()."""
+        if self.kind not in KINDS:
+            return f"unknown kind '{self.kind}'"
+        if self.kind == 'tier':
+            if self.tiers is None:
+                return "tiers must be four numbers, 'thread,rank,node,remote'"
+            if min(self.tiers) <= 0:
+                return "tier latencies must be > 0"
+            if self.ranks_per_node < 1:
+                return "need at least one rank per node"
+        elif self.kind == 'uniform':
+            if self.minimum <= 0 or self.max < self.minimum:
+                return "uniform latencies need 0 < minimum <= max"
+            if math.floor(self.max - self.minimum) != self.max - self.minimum:
+                return "uniform latencies are whole units apart, " \
+                    "so max - minimum must be a whole number"
+        elif self.minimum <= 0 or self.thread <= 0:
+            return "minimum and thread latencies must be > 0"
+        return ''
+
+    def latency(self, i: int, j: int, pi: tuple, pj: tuple) -> float:
+        """Latency of the link between i and j, placed at (rank, thread) pi and pj."""
+        if self.kind == 'tier':
+            return self.tiers[classify(pi, pj, self.ranks_per_node)]
+        if self.kind == 'uniform':
+            lo, hi = min(i, j), max(i, j)
+            state = (self.seed ^ (lo * 0x9e3779b97f4a7c15)) & _MASK64
+            state, _ = _splitmix64(state)
+            state ^= hi
+            state, value = _splitmix64(state)
+            u = (value >> 11) * 2.0 ** -53
+            span = self.max - self.minimum + 1
+            return min(self.max, self.minimum + math.floor(span * u))
+        return self.thread if pi[0] == pj[0] else self.minimum
+
+    def lookahead(self) -> float:
+        """Smallest latency of any link between ranks."""
+        if self.kind == 'tier':
+            return min(self.tiers[SAME_NODE], self.tiers[REMOTE_NODE])
+        return self.minimum
@@ -21,7 +21,9 @@ import textwrap
 
 phold_dir = os.path.dirname(os.path.abspath(__file__))
 sys.path.insert(0, phold_dir)
+import latency as lat
 import progress_dot as dot
+import topology as topo
 
 
 def phprint(args):
@@ -46,6 +48,33 @@ def dprint(message: str, dictionary: dict):
         dict_pretty = pprint.pformat(dictionary, indent=2, width=1)
         print(textwrap.indent(dict_pretty, '    '))
 
+def _ranks_threads() -> tuple:
+    """The SST ranks and threads, or (1, 1) when just debugging this script."""
+    if just_script:
+        return 1, 1
+    return sst.getMPIRankCount(), sst.getThreadCount()
+
+
+
+def create_blocks(latency: str):
+    """Create PholdBlock components, each hosting phold.block LPs,
+    and connect each pair of blocks."""
+    nblocks = (phold.number + phold.block - 1) // phold.block
+    phprint(f"Creating {nblocks} blocks of {phold.block} LPs")
+    params = dict(vars(phold))
+    params['lps'] = phold.block
+    blocks = []
+    for b in range(nblocks):
+        block = sst.Component("block_" + str(b), phold.component_type())
+        block.addParams(params)
+        blocks.append(block)
+
+    phprint(f"Creating complete block graph with latency {latency}")
+    for i in range(nblocks):
+        for j in range(i + 1, nblocks):
+            link = sst.Link("link_" + str(i) + '_' + str(j))
+            link.connect((blocks[i], 'port_' + str(j), latency),
+                         (blocks[j], 'port_' + str(i), latency))
 
 
 # PHOLD parameters
@@ -78,11 +107,62 @@ class PholdArgs(dict):
         self.remote = 0.9
         self.minimum = 1
         self.thread = 1
+        self.linklatency = 'global'
+        self.tiers = '1,1,1,1'
+        self.latencymax = 10
+        self.rankspernode = 1
         self.average = 9
         self.stop = 10
+        self.warmup = 0
         self.number = 2
         self.events = 1
+        self.topology = 'full'
+        self.dims = ''
+        self.neighbors = 4
+        self.seed = 1
+        self.group = 0
+        self.remotes = 1
+        self.distribution = 'uniform'
+        self.locality = 0.9
+        self.localsize = 0
+        self.zipf = 1.0
         self.buffer = 0
+        self.bufferdist = 'fixed'
+        self.buffermin = 0
+        self.buffermax = 0
+        self.buffersigma = 1.0
+        self.bufferlarge = 0.1
+        self.sharedbuffer = False
+        self.work = 'none'
+        self.workmean = 1000
+        self.workdist = 'fixed'
+        self.workset = 1 << 20
+        self.pool = True
+        self.shared = False
+        self.selfqueue = False
+        self.counters = False
+        self.fanout = 2
+        self.audit = False
+        self.rankreduce = False
+        self.timingsample = 0
+        self.heartbeat = 0
+        self.clocks = 0
+        self.clockperiod = 1
+        self.clockscope = 'lp'
+        self.clockspread = False
+        self.trace = ''
+        self.log = 'direct'
+        self.logfile = 'phold'
+        self.logbuffer = 1 << 20
+        self.delaybins = 0
+        self.delaybinwidth = 1
+        self.rng = 'xorshift'
+        self.rngseed = 1
+        self.sampler = 'standard'
+        self.fixed = False
+        self.block = 0
+        self.batch = 0
+        self.flush = 'deadline'
         self.stats = False
         self.delays = False
         self.delaysAutoscale = False
@@ -94,11 +174,42 @@ class PholdArgs(dict):
         return f"remote: {self.remote}, " \
                f"min: {self.minimum}, " \
                f"min: {self.thread}, " \
+               f"linklatency: {self.linklatency}, " \
                f"avg: {self.average}, " \
                f"stop: {self.stop}, " \
+               f"warmup: {self.warmup}, " \
                f"nodes: {self.number}, " \
                f"events: {self.events}, " \
+               f"topology: {self.topology}, " \
+               f"distribution: {self.distribution}, " \
                f"buffer: {self.buffer}, " \
+               f"bufferdist: {self.bufferdist}, " \
+               f"sharedbuffer: {self.sharedbuffer}, " \
+               f"work: {self.work}, " \
+               f"pool: {self.pool}, " \
+               f"shared: {self.shared}, " \
+               f"selfqueue: {self.selfqueue}, " \
+               f"counters: {self.counters}, " \
+               f"fanout: {self.fanout}, " \
+               f"audit: {self.audit}, " \
+               f"rankreduce: {self.rankreduce}, " \
+               f"timingsample: {self.timingsample}, " \
+               f"heartbeat: {self.heartbeat}, " \
+               f"clocks: {self.clocks}, " \
+               f"clockperiod: {self.clockperiod}, " \
+               f"clockscope: {self.clockscope}, " \
+               f"clockspread: {self.clockspread}, " \
+               f"trace: {self.trace}, " \
+               f"log: {self.log}, " \
+               f"logfile: {self.logfile}, " \
+               f"logbuffer: {self.logbuffer}, " \
+               f"rng: {self.rng}, " \
+               f"rngseed: {self.rngseed}, " \
+               f"sampler: {self.sampler}, " \
+               f"fixed: {self.fixed}, " \
+               f"block: {self.block}, " \
+               f"batch: {self.batch}, " \
+               f"flush: {self.flush}, " \
                f"stats: {self.stats}, " \
                f"delays: {self.delays}, " \
                f"delaysAuto: {self.delaysAutscale}, " \
@@ -120,11 +231,56 @@ class PholdArgs(dict):
         print(f"    Remote LP fraction:                   {self.remote}")
         print(f"    Minimum inter-event delay:            {self.minimum} {self.TIMEBASE}")
         print(f"    Inter-thread min delay:               {self.thread} {self.TIMEBASE}")
+        print(f"    Link latencies:                       {self.make_latencies()}")
         print(f"    Additional exponential average delay: {self.average} {self.TIMEBASE}")
+        print(f"    Warm up, not counted:                 {self.warmup} {self.TIMEBASE}")
         print(f"    Stop time:                            {self.stop} {self.TIMEBASE}")
         print(f"    Number of LPs:                        {self.number}")
         print(f"    Number of initial events per LP:      {self.events}")
+        print(f"    Topology:                             {self.topology}")
+        print(f"    Destination distribution:             {self.distribution}")
+        if self.distribution == 'local':
+            print(f"    Local fraction, block size:           {self.locality}, {self.localsize}")
+        elif self.distribution == 'zipf':
+            print(f"    Zipf exponent:                        {self.zipf}")
         print(f"    Size of event data buffer:            {self.buffer}")
+        if self.bufferdist != 'fixed':
+            print(f"      Distribution:                       {self.bufferdist}")
+            print(f"      Min, max:                           {self.buffermin}, {self.buffermax}")
+            if self.bufferdist == 'lognormal':
+                print(f"      Log standard deviation:             {self.buffersigma}")
+            elif self.bufferdist == 'bimodal':
+                print(f"      Large fraction:                     {self.bufferlarge}")
+        print(f"    Shared payload per LP:                {self.sharedbuffer}")
+        print(f"    Work per event:                       {self.work}")
+        if self.work != 'none':
+            print(f"      Mean units, distribution:           {self.workmean}, {self.workdist}")
+            if self.work == 'memory':
+                print(f"      Working set per LP:                 {self.workset}")
+        print(f"    Recycle events through pool:          {self.pool}")
+        print(f"    Single shared event handler:          {self.shared}")
+        print(f"    Local events through self queue:      {self.selfqueue}")
+        print(f"    Plain counters flushed in complete:   {self.counters}")
+        print(f"    Init/complete tree fan-out:           {self.fanout}")
+        print(f"    Audit all links in init/complete:     {self.audit}")
+        print(f"    Reduce within ranks first:            {self.rankreduce}")
+        print(f"    Timed handleEvent() calls, 1 in:      {self.timingsample}")
+        print(f"    Heartbeat interval (0: none):         {self.heartbeat} {self.TIMEBASE}")
+        print(f"    Load clocks:                          {self.clocks} per {self.clockscope}")
+        if self.clocks > 0:
+            print(f"      Clock period:                       {self.clockperiod} {self.TIMEBASE}"
+                  f"{', times 1, 2, ...' if self.clockspread else ''}")
+        print(f"    Event trace file base:                {self.trace or 'none'}")
+        print(f"    Log output:                           {self.log}"
+              f"{' to ' + self.logfile + '_<rank>.log' if self.log == 'file' else ''}")
+        print(f"    Random number generator:              {self.rng}")
+        print(f"    Delay and destination samplers:       {self.sampler}")
+        print(f"    Fixed destinations and delays:        {self.fixed}")
+        print(f"    Component type:                       {self.component_type()}")
+        print(f"    LPs per PholdBlock (0: use Phold):    {self.block}")
+        if self.block > 0:
+            print(f"    Maximum events per batch:             {self.batch}")
+            print(f"    Batch flush policy:                   {self.flush}")
 
         print(f"    Approx. events per LP per window:     {ev_per_win:.2f}")
         if ev_per_win < min_ev_per_win:
@@ -149,12 +305,25 @@ class PholdArgs(dict):
         if self.thread <= 0:
             phprint(f"Invalid inter-thread delay: {self.thread}, must be > 0")
             valid = False
+        why = self.make_latencies().validate()
+        if why:
+            phprint(f"Invalid link latencies: {why}")
+            valid = False
+        if self.linklatency != 'global' and self.block > 0:
+            phprint("--linklatency isn't supported with --block")
+            valid = False
         if self.average < 0:
             phprint(f"Invalid average delay: {self.average}, must be >= 0")
             valid = False
         if self.stop <= 0:
             phprint(f"Invalid stop time: {self.stop}, must be > 0")
             valid = False
+        if not 0 <= self.warmup < self.stop:
+            phprint(f"Invalid warm up: {self.warmup}, must be in [0, stop)")
+            valid = False
+        if self.warmup > 0 and self.block > 0:
+            phprint("--warmup isn't supported with --block")
+            valid = False
 
         self.number = int(self.number)
         if self.number < 2:
@@ -166,13 +335,177 @@ class PholdArgs(dict):
             phprint(f"Invalid initial events: {self.events}, need at least 1")
             valid = False
         
+        self.group = int(self.group)
+        if self.group < 0:
+            phprint(f"Invalid group size: {self.group}, can't be negative")
+            valid = False
+        why = self.make_topology().validate()
+        if why and not (self.topology == 'hierarchical' and self.group == 0):
+            phprint(f"Invalid topology: {why}")
+            valid = False
+
+        self.block = int(self.block)
+        if self.block < 0:
+            phprint(f"Invalid block size: {self.block}, can't be negative")
+            valid = False
+
+        self.batch = int(self.batch)
+        if self.batch < 0:
+            phprint(f"Invalid batch size: {self.batch}, can't be negative")
+            valid = False
+        if self.batch > 1 and self.block == 0:
+            phprint("Batching requires --block")
+            valid = False
+
+        if self.selfqueue and self.block > 0:
+            phprint("--selfqueue isn't needed with --block, which has its own queue")
+            valid = False
+        self.fanout = int(self.fanout)
+        if self.fanout < 2:
+            phprint(f"Invalid fanout: {self.fanout}, must be at least 2")
+            valid = False
+
+        self.timingsample = int(self.timingsample)
+        if self.timingsample < 0:
+            phprint(f"Invalid timing sample: {self.timingsample}, can't be negative")
+            valid = False
+
+        if self.heartbeat < 0:
+            phprint(f"Invalid heartbeat interval: {self.heartbeat}, can't be negative")
+            valid = False
+        if self.heartbeat > 0 and self.block > 0:
+            phprint("--heartbeat isn't supported with --block")
+            valid = False
+        if self.clocks < 0:
+            phprint(f"Invalid number of clocks: {self.clocks}, can't be negative")
+            valid = False
+        if self.clocks > 0 and self.clockperiod <= 0:
+            phprint(f"Invalid clock period: {self.clockperiod}, must be positive")
+            valid = False
+        if self.clocks > 0 and self.block > 0:
+            phprint("--clocks isn't supported with --block")
+            valid = False
+        if self.trace and self.block > 0:
+            phprint("--trace isn't supported with --block")
+            valid = False
+        self.logbuffer = int(self.logbuffer)
+        if self.log != 'direct' and self.logbuffer <= 0:
+            phprint(f"Invalid log buffer: {self.logbuffer}, must be positive")
+            valid = False
+
+        if self.rankreduce and self.block > 0:
+            phprint("--rankreduce isn't supported with --block")
+            valid = False
+        ranks, threads = _ranks_threads()
+        if self.rankreduce and self.number < ranks * threads:
+            phprint("--rankreduce needs at least one LP per thread")
+            valid = False
+
+        if self.counters and self.block > 0:
+            phprint("--counters isn't supported with --block")
+            valid = False
+
+        self.rngseed = int(self.rngseed)
+        if not 0 <= self.rngseed < 2**32:
+            phprint(f"Invalid rng seed: {self.rngseed}, must fit in 32 bits")
+            valid = False
+        if (self.rng == 'mersenne' or self.fixed) and self.block > 0:
+            phprint("Only the xorshift and philox rngs are supported with --block")
+            valid = False
+        if self.fixed and self.rng != 'xorshift':
+            phprint("--fixed doesn't use an rng, so can't be combined with --rng")
+            valid = False
+        if self.sampler == 'fast' and (self.fixed or self.rng == 'mersenne'):
+            phprint("--sampler=fast is only supported with --rng=xorshift or philox, "
+                    "without --fixed")
+            valid = False
+
+        if self.distribution != 'uniform':
+            if self.topology != 'full' or self.block > 0:
+                phprint(f"The {self.distribution} distribution requires "
+                        f"the full topology, without --block")
+                valid = False
+            self.locality = float(self.locality)
+            if not 0 <= self.locality <= 1:
+                phprint(f"Invalid locality: {self.locality}, must be in [0, 1]")
+                valid = False
+            self.localsize = int(self.localsize)
+            if self.localsize < 0:
+                phprint(f"Invalid local block size: {self.localsize}, can't be negative")
+                valid = False
+            self.zipf = float(self.zipf)
+            if self.zipf < 0:
+                phprint(f"Invalid zipf exponent: {self.zipf}, can't be negative")
+                valid = False
+
         self.buffer = int(self.buffer)
         if self.buffer < 0:
             phprint(f"Invalid event buffer size: {self.buffer}, can't be negative")
             valid = False
+        if self.bufferdist != 'fixed' or self.sharedbuffer:
+            if self.block > 0:
+                phprint("--bufferdist and --sharedbuffer aren't supported with --block")
+                valid = False
+            self.buffermin = int(self.buffermin)
+            self.buffermax = int(self.buffermax)
+            if self.bufferdist in ['uniform', 'bimodal'] and \
+               not 0 <= self.buffermin <= self.buffermax:
+                phprint(f"Invalid payload range: [{self.buffermin}, {self.buffermax}]")
+                valid = False
+            if self.bufferdist == 'lognormal' and (self.buffer == 0 or self.buffersigma < 0):
+                phprint("--bufferdist=lognormal needs --buffer > 0 and --buffersigma >= 0")
+                valid = False
+            if self.bufferdist == 'bimodal' and not 0 <= self.bufferlarge <= 1:
+                phprint(f"Invalid large payload fraction: {self.bufferlarge}, must be in [0, 1]")
+                valid = False
+
+        if self.work != 'none':
+            if self.block > 0:
+                phprint("--work isn't supported with --block")
+                valid = False
+            if self.workmean < 0:
+                phprint(f"Invalid work mean: {self.workmean}, can't be negative")
+                valid = False
+            if self.work == 'hash' and self.buffer == 0:
+                phprint("--work=hash needs a payload, set --buffer")
+                valid = False
+            self.workset = int(self.workset)
+            if self.work == 'memory' and self.workset < 64:
+                phprint(f"Invalid working set: {self.workset}, need at least one cache line")
+                valid = False
 
         return valid
 
+    def make_topology(self) -> topo.Topology:
+        """Create the Topology described by the arguments."""
+        ranks, threads = _ranks_threads()
+        return topo.Topology(self.topology, self.number, self.dims,
+                             self.neighbors, self.seed,
+                             self.group, self.remotes, self.fanout,
+                             ranks if self.rankreduce else 0, threads)
+
+    def make_latencies(self) -> lat.Latencies:
+        """Create the Latencies described by the arguments."""
+        return lat.Latencies(self.linklatency, self.minimum, self.thread,
+                             self.tiers, self.latencymax,
+                             self.rankspernode, self.seed)
+
+    def component_type(self) -> str:
+        """The SST component type for the LPs, from the Phold variant options."""
+        if self.block > 0:
+            return {('xorshift', 'standard'): 'phold.PholdBlock',
+                    ('philox', 'standard'): 'phold.PholdBlockPhilox',
+                    ('xorshift', 'fast'): 'phold.PholdBlockFast',
+                    ('philox', 'fast'): 'phold.PholdBlockPhiloxFast'}[(self.rng, self.sampler)]
+        if self.fixed:
+            return 'phold.PholdFixed'
+        if self.sampler == 'fast':
+            return {'xorshift': 'phold.PholdFast',
+                    'philox': 'phold.PholdPhiloxFast'}[self.rng]
+        return {'xorshift': 'phold.Phold',
+                'mersenne': 'phold.PholdMersenne',
+                'philox': 'phold.PholdPhilox'}[self.rng]
+
     def _init_argparse(self) -> argparse.ArgumentParser:
         """Configure the argument parser with our arguments."""
         script = os.path.basename(__file__)
@@ -191,6 +524,26 @@ class PholdArgs(dict):
             '-t', '--thread', action='store', type=float,
             help=f"Inter-thread minimum delay, in {self.TIMEBASE}. "
             f"Must by >0, default {self.thread}.")
+        parser.add_argument(
+            '--linklatency', action='store', choices=lat.KINDS,
+            help=f"Link latency model: 'global' uses --thread within a rank "
+            f"and --minimum between ranks; 'tier' uses --tiers by placement; "
+            f"'uniform' draws each link latency from [--minimum, --latencymax]. "
+            f"Default {self.linklatency}.")
+        parser.add_argument(
+            '--tiers', action='store',
+            help=f"Link latencies for --linklatency=tier, in {self.TIMEBASE}, "
+            f"as 'thread,rank,node,remote', default {self.tiers}.")
+        parser.add_argument(
+            '--latencymax', action='store', type=float,
+            help=f"Largest link latency for --linklatency=uniform, "
+            f"in {self.TIMEBASE}, default {self.latencymax}. "
+            f"Latencies step by 1 {self.TIMEBASE}, "
+            f"so --latencymax - --minimum must be a whole number.")
+        parser.add_argument(
+            '--rankspernode', action='store', type=int,
+            help=f"Number of consecutive ranks on each node, "
+            f"for --linklatency=tier, default {self.rankspernode}.")
         parser.add_argument(
             '-a', '--average', action='store', type=float,
             help=f"Average additional inter-event delay, in {self.TIMEBASE}. "
@@ -200,6 +553,11 @@ class PholdArgs(dict):
             '-s', '--stop', action='store', type=float,
             help=f"Total simulation time, in {self.TIMEBASE}. "
             f"Must be > 0, default {self.stop}.")
+        parser.add_argument(
+            '-w', '--warmup', action='store', type=float,
+            help=f"Warm up time, in {self.TIMEBASE}. Events received before this "
+            f"aren't counted in the statistics or event rates. "
+            f"Must be in [0, stop), default {self.warmup}.")
         parser.add_argument(
             '-n', '--number', action='store', type=int,
             help=f"Total number of LPs. "
@@ -208,10 +566,188 @@ class PholdArgs(dict):
             '-e', '--events', action='store', type=int,
             help=f"Number of initial events per LP. "
             f"Must be > 0, default {self.events}")
+        parser.add_argument(
+            '-T', '--topology', action='store', choices=topo.KINDS,
+            help=f"LP connectivity, default {self.topology}.")
+        parser.add_argument(
+            '--dims', action='store',
+            help="Torus dimensions, as 'x,y[,z]'. "
+            "Default is the most compact factorization of --number.")
+        parser.add_argument(
+            '--neighbors', action='store', type=int,
+            help=f"Number of neighbors in the random topology, "
+            f"default {self.neighbors}.")
+        parser.add_argument(
+            '--seed', action='store', type=int,
+            help=f"Seed for the random topology, default {self.seed}.")
+        parser.add_argument(
+            '--group', action='store', type=int,
+            help="Number of LPs per group in the hierarchical topology. "
+            "Default is the number of LPs per thread.")
+        parser.add_argument(
+            '--remotes', action='store', type=int,
+            help=f"Links to other groups, in each direction, "
+            f"in the hierarchical topology, default {self.remotes}.")
         parser.add_argument(
             '-b', '--buffer', action='store', type=int,
             help=f"Size of event data buffer. "
             f"Must be non-negative, default {self.buffer}")
+        parser.add_argument(
+            '--bufferdist', action='store',
+            choices=['fixed', 'uniform', 'lognormal', 'bimodal'],
+            help=f"Payload size distribution: 'uniform' in [--buffermin, --buffermax], "
+            f"'lognormal' with mean --buffer, or 'bimodal' between "
+            f"--buffermin and --buffermax, default {self.bufferdist}.")
+        parser.add_argument(
+            '--buffermin', action='store', type=int,
+            help=f"Smallest payload, default {self.buffermin}.")
+        parser.add_argument(
+            '--buffermax', action='store', type=int,
+            help=f"Largest payload, or the lognormal truncation, "
+            f"0 for 16 * --buffer, default {self.buffermax}.")
+        parser.add_argument(
+            '--buffersigma', action='store', type=float,
+            help=f"Log standard deviation of lognormal payloads, default {self.buffersigma}.")
+        parser.add_argument(
+            '--bufferlarge', action='store', type=float,
+            help=f"Fraction of large bimodal payloads, default {self.bufferlarge}.")
+        parser.add_argument(
+            '--sharedbuffer', action='store_true',
+            help=f"Share one reference counted payload per LP, so only events "
+            f"to other ranks copy it, default {self.sharedbuffer}.")
+        parser.add_argument(
+            '--work', action='store', choices=['none', 'flops', 'hash', 'memory'],
+            help=f"Synthetic work per event: a floating point loop, "
+            f"hashing the payload (needs --buffer), or touching a per-LP "
+            f"working set, default {self.work}.")
+        parser.add_argument(
+            '--workmean', action='store', type=float,
+            help=f"Mean work units per event: loop iterations, hash passes, "
+            f"or cache lines, default {self.workmean}.")
+        parser.add_argument(
+            '--workdist', action='store', choices=['fixed', 'exponential'],
+            help=f"Distribution of work units per event, default {self.workdist}.")
+        parser.add_argument(
+            '--workset', action='store', type=int,
+            help=f"Working set per LP for --work=memory, in bytes, "
+            f"default {self.workset}.")
+        parser.add_argument(
+            '--no-pool', dest='pool', action='store_false',
+            help="Allocate events from the global heap, "
+            "instead of recycling through per-thread free lists.")
+        parser.add_argument(
+            '--block', action='store', type=int,
+            help="Host this many LPs in each phold.PholdBlock component, "
+            "instead of one phold.Phold component per LP. "
+            "The topology is ignored; every pair of blocks is connected.")
+        parser.add_argument(
+            '--batch', action='store', type=int,
+            help=f"Coalesce up to this many events to the same block "
+            f"into one SST event, requires --block. "
+            f"0 or 1 to send individually, default {self.batch}.")
+        parser.add_argument(
+            '--flush', action='store', choices=['deadline', 'eager'],
+            help=f"Batch flush policy: 'deadline' holds a batch until the "
+            f"latest time it can still be delivered on time, "
+            f"'eager' flushes at the end of each time step, default {self.flush}.")
+        parser.add_argument(
+            '--shared', action='store_true',
+            help=f"Use a single event handler per LP, instead of one per link, "
+            f"default {self.shared}.")
+        parser.add_argument(
+            '--selfqueue', action='store_true',
+            help=f"Keep local events in a per-LP queue, instead of sending them "
+            f"on the self link, default {self.selfqueue}.")
+        parser.add_argument(
+            '--counters', action='store_true',
+            help=f"Count events in plain counters, flushing them to the "
+            f"statistics at the end, default {self.counters}.")
+        parser.add_argument(
+            '--fanout', action='store', type=int,
+            help=f"Fan-out of the init()/complete() tree, "
+            f"fewer phases with larger values, default {self.fanout}.")
+        parser.add_argument(
+            '--audit', action='store_true',
+            help=f"Check every link for unexpected events in each "
+            f"init()/complete() phase, which is slow with many LPs, "
+            f"default {self.audit}.")
+        parser.add_argument(
+            '--rankreduce', action='store_true',
+            help=f"In complete() sum the counts on each rank first, then "
+            f"reduce over one leader LP per rank, and report the load "
+            f"balance. Requires the linear partitioner, default {self.rankreduce}.")
+        parser.add_argument(
+            '--timing', dest='timingsample', action='store', type=int,
+            help=f"Time one in this many event handler calls with the cycle "
+            f"counter, 0 to disable, default {self.timingsample}.")
+        parser.add_argument(
+            '--heartbeat', action='store', type=float,
+            help=f"Report each rank's progress and event rate every this many "
+            f"{self.TIMEBASE} of simulation time, 0 to disable, "
+            f"default {self.heartbeat}.")
+        parser.add_argument(
+            '--clocks', action='store', type=int,
+            help=f"Register this many clock handlers, alongside the events, "
+            f"to measure the cost of concurrent clocks, default {self.clocks}.")
+        parser.add_argument(
+            '--clockperiod', action='store', type=float,
+            help=f"Clock period, in {self.TIMEBASE}, default {self.clockperiod}.")
+        parser.add_argument(
+            '--clockscope', action='store', choices=['lp', 'rank'],
+            help=f"Register the clocks on every LP, or on one LP per rank, "
+            f"default {self.clockscope}.")
+        parser.add_argument(
+            '--clockspread', action='store_true',
+            help=f"Give clock k the period (k + 1) * clockperiod, so each is a "
+            f"separate SST clock, instead of all sharing one, default {self.clockspread}.")
+        parser.add_argument(
+            '--trace', action='store',
+            help="Write a binary trace of the events to <TRACE>_<rank>_<thread>.trace, "
+            "one file per thread, for src/phold-trace.  Default is no trace.")
+        parser.add_argument(
+            '--log', action='store', choices=['direct', 'buffer', 'file'],
+            help=f"Where the component log messages go: 'direct', flushed per "
+            f"message, 'buffer', through per thread buffers to stdout, or 'file', "
+            f"to <LOGFILE>_<rank>.log.  The final report is always direct, "
+            f"default {self.log}.")
+        parser.add_argument(
+            '--logfile', action='store',
+            help=f"Log file base name, with --log file, default {self.logfile}.")
+        parser.add_argument(
+            '--logbuffer', action='store', type=int,
+            help=f"Log buffer bytes per thread, default {self.logbuffer}.")
+        parser.add_argument(
+            '--rng', action='store', choices=['xorshift', 'mersenne', 'philox'],
+            help=f"Random number generator, selecting the Phold variant. "
+            f"'philox' is counter-based, "
+            f"so results don't depend on partitioning, default {self.rng}.")
+        parser.add_argument(
+            '--rngseed', action='store', type=int,
+            help=f"Seed for the philox generator, default {self.rngseed}.")
+        parser.add_argument(
+            '--sampler', action='store', choices=['standard', 'fast'],
+            help=f"Delay and destination samplers. 'fast' draws delays by "
+            f"the ziggurat and uniform destinations by bounded integers, "
+            f"with the same distributions, default {self.sampler}.")
+        parser.add_argument(
+            '--distribution', action='store', choices=['uniform', 'local', 'zipf'],
+            help=f"Remote destination distribution, full topology only. "
+            f"'local' prefers LPs in the same block of --localsize LPs, "
+            f"'zipf' prefers low LP ids, default {self.distribution}.")
+        parser.add_argument(
+            '--locality', action='store', type=float,
+            help=f"Fraction of remote events staying in the local block, "
+            f"default {self.locality}.")
+        parser.add_argument(
+            '--localsize', action='store', type=int,
+            help=f"LPs per local block, 0 for LPs per thread, default {self.localsize}.")
+        parser.add_argument(
+            '--zipf', action='store', type=float,
+            help=f"Zipf exponent, default {self.zipf}.")
+        parser.add_argument(
+            '--fixed', action='store_true',
+            help="Use phold.PholdFixed: always send to the next LP, "
+            "with the average delay.")
         parser.add_argument(
             # '--verbose' conflicts with SST, even after --
             '-v', '--pverbose', action='count',
@@ -276,55 +812,77 @@ if just_script:
     phprint(f"Nothing left to do, exiting")
     sys.exit(1)
 
-# Create the LPs
-phprint(f"Creating {phold.number} LPs")
-dotter = dot.Dot(phold.number, phold.pyVerbose)
-lps = []
-for i in range(phold.number):
-    if dotter.dot(1):
-        vprint(2, f"  Creating LP {i}")
-    lp = sst.Component("phold_" + str(i), 'phold.Phold')
-    lp.addParams(vars(phold))  # pass ph as simple dictionary
-    lps.append(lp)
-dotter.done()
-
 # min latency
 latency = str(phold.minimum) + ' ' + phold.TIMEBASE
-thread_latency = str(phold.thread) + ' ' + phold.TIMEBASE
 nranks = sst.getMPIRankCount()
 
-# Assume block partitioning: 
-#   Each rank holds 
-nLP_rank = phold.number / nranks
-#   Rank 0 holds 0-nLP_rank - 1
-
-# Add links
-num_links = int(phold.number * (phold.number - 1) / 2)
-phprint(f"Creating complete graph with latency {latency} ({num_links} total)")
-dotter = dot.Dot(num_links, phold.pyVerbose)
-for i in range(phold.number):
-    rank_i = i // nLP_rank
-    for j in range(i + 1, phold.number):
-        rank_j = j // nLP_rank
-        lat = thread_latency if (rank_i == rank_j) else latency
-
-        if dotter.dot(2, False):
-            vprint(2, f"  Creating link {i}_{j} between ranks {rank_i} and {rank_j} with latency {lat}")
-        link = sst.Link("link_" + str(i) + '_' + str(j))
-
-        # links cross connect ports:
-        # port number gives the LP id on the other side of the link
-        li = lps[i], 'port_' + str(j), lat
-        lj = lps[j], 'port_' + str(i), lat
-
-        if dotter.dot(3):
-            vprint(3, f"    creating tuples")
-            vprint(3, f"      {li}")
-            vprint(3, f"      {lj}")
-            vprint(3, f"    connecting {i} to {j}")
-
-        link.connect(li, lj)
-dotter.done()
+# Hierarchical groups default to one per thread
+if phold.topology == 'hierarchical' and phold.group == 0:
+    phold.group = max(1, phold.number // (nranks * sst.getThreadCount()))
+topology = phold.make_topology()
+
+# Delay histogram bins
+delay_mean = phold.minimum + phold.average
+numbins = 50
+binwidth = round(5 * delay_mean / numbins)
+if phold.delays and phold.counters and not phold.delaysAutoscale and binwidth > 0:
+    # Let each LP histogram into the same bins, before passing the params
+    phold.delaybins = numbins
+    phold.delaybinwidth = binwidth
+
+component_type = phold.component_type()
+if phold.block > 0:
+    create_blocks(latency)
+else:
+    # Create the LPs
+    phprint(f"Creating {phold.number} LPs")
+    dotter = dot.Dot(phold.number, phold.pyVerbose)
+    lps = []
+    for i in range(phold.number):
+        if dotter.dot(1):
+            vprint(2, f"  Creating LP {i}")
+        lp = sst.Component("phold_" + str(i), component_type)
+        lp.addParams(vars(phold))  # pass ph as simple dictionary
+        lps.append(lp)
+    dotter.done()
+
+    # Assume the linear partitioner, as Phold and phold-config
+    nthreads = sst.getThreadCount()
+    latencies = phold.make_latencies()
+
+    # Add links
+    if topology.kind == 'full':
+        num_links = int(phold.number * (phold.number - 1) / 2)
+        phprint(f"Creating complete graph with latencies {latencies} ({num_links} total)")
+    else:
+        num_links = phold.number
+        phprint(f"Creating {topology} graph with latencies {latencies}")
+    dotter = dot.Dot(num_links, phold.pyVerbose)
+    for i in range(phold.number):
+        place_i = lat.placement(i, phold.number, nranks, nthreads)
+        # Each pair is connected once, from the lower id
+        for j in [j for j in topology.links(i) if j > i]:
+            place_j = lat.placement(j, phold.number, nranks, nthreads)
+            link_lat = str(latencies.latency(i, j, place_i, place_j)) + ' ' + phold.TIMEBASE
+
+            if dotter.dot(2, False):
+                vprint(2, f"  Creating link {i}_{j} between ranks {place_i[0]} and {place_j[0]} "
+                       f"with latency {link_lat}")
+            link = sst.Link("link_" + str(i) + '_' + str(j))
+
+            # links cross connect ports:
+            # port number gives the LP id on the other side of the link
+            li = lps[i], 'port_' + str(j), link_lat
+            lj = lps[j], 'port_' + str(i), link_lat
+
+            if dotter.dot(3):
+                vprint(3, f"    creating tuples")
+                vprint(3, f"      {li}")
+                vprint(3, f"      {lj}")
+                vprint(3, f"    connecting {i} to {j}")
+
+            link.connect(li, lj)
+    dotter.done()
 
 # Enable statistics
 stat_level = 1 + phold.delays
@@ -343,13 +901,14 @@ stats_config = {'rate': '0ms'}
 # Stat type accumulator is the default, so don't need state it explicitly
 dprint("  Accumulator config:", stats_config)
 
-sst.enableStatisticsForComponentType('phold.Phold', ['SendCount'], stats_config)
-sst.enableStatisticsForComponentType('phold.Phold', ['RecvCount'], stats_config)
+sst.enableStatisticsForComponentType(component_type, ['SendCount'], stats_config)
+sst.enableStatisticsForComponentType(component_type, ['RecvCount'], stats_config)
+if phold.selfqueue:
+    sst.enableStatisticsForComponentType(component_type,
+                                         ['SelfQueueCount', 'SelfWakeCount'],
+                                         stats_config)
 
-if phold.delays:
-    delay_mean = phold.minimum + phold.average
-    numbins = 50
-    binwidth = round(5 * delay_mean / numbins)
+if phold.delays and phold.block == 0:
     autoscale = 0
     if phold.delaysAutoscale:
         autoscale = 1
@@ -363,7 +922,7 @@ if phold.delays:
 
     dprint("Delay histogram config:", delays_config)
 
-    sst.enableStatisticsForComponentType('phold.Phold', ['Delays'], delays_config)
+    sst.enableStatisticsForComponentType(component_type, ['Delays'], delays_config)
 
 
 # Set overall program options
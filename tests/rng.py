@@ -7,7 +7,11 @@
 # Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
 
 """
-Test the SST RNG performance with a simple component.
+Time the SST and PHOLD generators and samplers with a simple component.
+
+Each component times every generator with every sampler; each rank
+reports the ns per sample per thread, and over the rank.  Run with
+several threads to see the cost with all threads busy.
 """
 
 # import sst is managed below
@@ -52,13 +56,17 @@ class RngArgs(dict):
     def __init__(self):
         super().__init__()
         self.number = 1
-        self.samples = 100
+        self.samples = 1000000
+        self.bins = 1000
+        self.mean = 1.0
         self.pverbose = 0
         self.pyVerbose = 0
 
     def __str__(self):
         return f"comp: {self.number}, " \
                f"samples: {self.samples}, " \
+               f"bins: {self.bins}, " \
+               f"mean: {self.mean}, " \
                f"verbose: {self.pverbose}, " \
                f"pyVerbose: {self.pyVerbose}"
 
@@ -66,6 +74,8 @@ class RngArgs(dict):
         """Pretty print the configuration."""
         print(f"    Number of components:           {self.number}")
         print(f"    Number of samples:              {self.samples}")
+        print(f"    Integer sampler values:         {self.bins}")
+        print(f"    Exponential sampler mean:       {self.mean}")
         print(f"    Verbosity level:                {self.pverbose}")
         print(f"    Python script verbosity level:  {self.pyVerbose}")
 
@@ -82,6 +92,15 @@ class RngArgs(dict):
         if self.samples < 1:
             meprint(f"Invalid number of samples: {self.samples}, need at least 1")
             valid = False
+
+        self.bins = int(self.bins)
+        if self.bins < 1:
+            meprint(f"Invalid number of bins: {self.bins}, need at least 1")
+            valid = False
+
+        if self.mean <= 0:
+            meprint(f"Invalid exponential mean: {self.mean}, must be > 0")
+            valid = False
         return valid
 
     def init_argparse(self) -> argparse.ArgumentParser:
@@ -89,15 +108,22 @@ class RngArgs(dict):
         script = os.path.basename(__file__)
         parser = argparse.ArgumentParser(
             usage=f"sst {script} [OPTION]...",
-            description="Execute an RNG timing benchmark.")
+            description="Execute an RNG and sampler timing benchmark.")
         parser.add_argument(
             '-n', '--number', action='store', type=float,
             help=f"Total number of components. "
             f"Must be > 0, default {self.number}.")
         parser.add_argument(
             '-s', '--samples', action='store', type=float,
-            help=f"Number of samples per component. "
-            f"Must be > 1, default {self.samples}")
+            help=f"Number of samples per component, for each generator "
+            f"and sampler. Must be > 0, default {self.samples}")
+        parser.add_argument(
+            '-b', '--bins', action='store', type=float,
+            help=f"Number of values for the integer samplers. "
+            f"Must be > 0, default {self.bins}.")
+        parser.add_argument(
+            '-m', '--mean', action='store', type=float,
+            help=f"Mean of the exponential samplers, default {self.mean}.")
         parser.add_argument(
             # '--verbose' conflicts with SST, even after --
             '-v', '--pverbose', action='count',
@@ -1,40 +1,359 @@
-#!python3
-# -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*-
+#!/bin/python3
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil; -*-
 #
 # Copyright (c) 2021 Lawrence Livermore National Laboratory
 # All rights reserved.
 #
 # Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
 
+
 """
-Generate a list of interesting PHOLD test points.
+PHOLD strong and weak scaling driver.
+
+Runs tests/phold.py over every combination of ranks, threads, LPs,
+events and remote fraction, and reads the results from the component's
+own report: the global committed event rate, the wall clock run time
+of the longest rank, and the peak RSS.  Each run is appended as one row
+to <out>.jsonl and <out>.csv, with its log in <out>.logs/, so an
+interrupted sweep keeps the runs already done.  At the end it prints
+speedup and efficiency tables, grouped by everything but the worker
+count (ranks * threads), and checks that every run of the same model
+reports the same committed event checksum, and that each run received
+every event it sent (the received checksum matches the committed one).
+
+Strong scaling holds the total number of LPs fixed;
+weak scaling holds --number LPs per worker.
+
+Speedup is the event rate relative to the smallest worker count in the
+group, and efficiency is the speedup divided by the worker ratio.
+Since the committed events grow with the model, the same rate based
+formulas serve for both strong and weak scaling.
+
+Examples:
+
+    tests/scaling1.py --mode strong --ranks 1,2,4 --threads 1,2 --number 4096
+    tests/scaling1.py --mode weak --ranks 1,2,4,8 --number 1024 --remote 0.5,0.9 \\
+        --launcher "srun --ntasks={ranks} --nodes={nodes}" --ranks-per-node 2
+    tests/scaling1.py --collate study.jsonl --baseline old-sst.jsonl
 """
 
-from operator import mul
+import argparse
+import csv
+import itertools
+import json
+import os
+import re
+import shlex
+import subprocess
+import sys
+import time
+
+phold_dir = os.path.dirname(os.path.abspath(__file__))
+
+# Result fields, parsed from the Phold output, all on LP 0
+# Each is (field, label regex, conversion)
+METRICS = [
+    ('rate', r"Global committed event rate \(events/s\):\s*(\S+)", float),
+    ('wall', r"Wall clock run time, longest rank \(s\):\s*(\S+)", float),
+    ('peak_max_mib', r"Peak RSS, max rank, run \(MiB\):\s*(\S+)", float),
+    ('peak_sum_mib', r"Peak RSS, sum of ranks, run \(MiB\):\s*(\S+)", float),
+    ('receives', r"Grand total sends: \d+, receives: (\d+)", int),
+    ('imbalance', r"LP imbalance \(max / mean\):\s*(\S+)", float),
+    ('checksum', r"Committed event checksum:\s*([0-9a-f]+)", str),
+    ('recv_checksum', r"Received event checksum:\s*([0-9a-f]+)", str),
+]
+
+# Columns of each row, in CSV order
+FIELDS = ['mode', 'ranks', 'threads', 'workers', 'number', 'events', 'remote',
+          'stop', 'phold_args', 'repeat', 'status', 'elapsed'] \
+    + [m[0] for m in METRICS] + ['log']
+
+# Row fields which identify a scaling group; only the workers vary within it.
+# Weak scaling groups on LPs per worker, so the total number varies.
+# The extra phold.py arguments change the model, so they're part of the group too.
+GROUP = ['mode', 'per_worker', 'events', 'remote', 'stop', 'phold_args']
+
+
+def phprint(args):
+    """Print progress information, prefixed by our name."""
+    script = os.path.basename(__file__)
+    print(script, ': ', args, flush=True)
+
+
+def number_list(text: str, kind=int) -> list:
+    """Parse a comma separated list of numbers."""
+    try:
+        return [kind(v) for v in text.split(',') if v]
+    except ValueError as err:
+        raise argparse.ArgumentTypeError(f"invalid list '{text}': {err}")
+
+
+def parse_output(text: str) -> dict:
+    """Pull the METRICS out of one run's output; missing ones are None."""
+    result = {}
+    for field, pattern, kind in METRICS:
+        match = re.search(pattern, text)
+        result[field] = kind(match.group(1)) if match else None
+    return result
+
+
+def per_worker(row: dict) -> int:
+    """LPs per worker for weak scaling, or the total for strong scaling."""
+    if row['mode'] == 'weak':
+        return row['number'] // row['workers']
+    return row['number']
+
+
+def load_rows(path: str) -> list:
+    """Read the rows from a .jsonl results file."""
+    rows = []
+    with open(path, encoding='utf-8') as fin:
+        for line in fin:
+            line = line.strip()
+            if line:
+                rows.append(json.loads(line))
+    return rows
+
+
+def group_key(row: dict) -> tuple:
+    """The scaling group of a row."""
+    # Rows from before phold_args was recorded ran without extra arguments
+    return tuple(per_worker(row) if g == 'per_worker' else row.get(g, '') for g in GROUP)
+
+
+def mean_rates(rows: list) -> dict:
+    """Mean event rate, wall time and peak, by (group, ranks, threads), over repeats."""
+    sums = {}
+    for row in rows:
+        if row['status'] != 0 or not row['rate']:
+            continue
+        key = (group_key(row), row['ranks'], row['threads'])
+        entry = sums.setdefault(key, {'n': 0, 'rate': 0.0, 'wall': 0.0, 'peak': 0.0})
+        entry['n'] += 1
+        entry['rate'] += row['rate']
+        entry['wall'] += row['wall'] or 0
+        entry['peak'] += row['peak_max_mib'] or 0
+    return {k: {f: v[f] / v['n'] for f in ('rate', 'wall', 'peak')}
+            for k, v in sums.items()}
+
+
+def check_checksums(rows: list) -> int:
+    """Report the model configurations whose runs disagree on the event checksum.
+
+    Every run of the same LPs, events, remote fraction, stop and extra
+    phold.py arguments should commit the same events, whatever the
+    ranks and threads.  Within each
+    run the received checksum should match the committed one.
+    """
+    sums = {}
+    lost = 0
+    for row in rows:
+        if row['status'] == 0 and row.get('recv_checksum') \
+           and row['recv_checksum'] != row.get('checksum'):
+            phprint(f"Received checksum mismatch in {row.get('log')}: "
+                    f"sent {row.get('checksum')}, received {row['recv_checksum']}")
+            lost += 1
+        if row['status'] == 0 and row.get('checksum'):
+            key = (row['number'], row['events'], row['remote'], row['stop'],
+                   row.get('phold_args', ''))
+            sums.setdefault(key, set()).add(row['checksum'])
+    bad = {k: v for k, v in sums.items() if len(v) > 1}
+    for key, values in sorted(bad.items()):
+        phprint(f"Checksum mismatch for number, events, remote, stop, phold args {key}: "
+                f"{', '.join(sorted(values))}")
+    return len(bad) + lost
+
+
+def print_tables(rows: list, baseline: list = None, tolerance: float = 0.05):
+    """Print the speedup and efficiency tables, and any regression against baseline."""
+    means = mean_rates(rows)
+    base = mean_rates(baseline) if baseline else {}
+    groups = sorted({k[0] for k in means})
+    regressions = 0
+    for group in groups:
+        label = ', '.join(f"{g}: {v}" for g, v in zip(GROUP, group))
+        print(f"\nScaling group {label}")
+        header = f"    {'Ranks':>6} {'Threads':>8} {'Workers':>8} {'Rate (ev/s)':>14} " \
+                 f"{'Wall (s)':>10} {'Peak (MiB)':>11} {'Speedup':>8} {'Effic.':>7}"
+        if base:
+            header += f" {'vs base':>8}"
+        print(header)
+        points = sorted((k for k in means if k[0] == group),
+                        key=lambda k: (k[1] * k[2], k[1]))
+        first = means[points[0]]
+        first_workers = points[0][1] * points[0][2]
+        for key in points:
+            entry = means[key]
+            workers = key[1] * key[2]
+            speedup = entry['rate'] / first['rate']
+            efficiency = speedup * first_workers / workers
+            line = f"    {key[1]:>6} {key[2]:>8} {workers:>8} {entry['rate']:>14.1f} " \
+                   f"{entry['wall']:>10.3f} {entry['peak']:>11.1f} {speedup:>8.2f} " \
+                   f"{efficiency:>7.2f}"
+            if key in base:
+                ratio = entry['rate'] / base[key]['rate']
+                flag = '  REGRESSION' if ratio < 1 - tolerance else ''
+                regressions += bool(flag)
+                line += f" {ratio:>8.3f}{flag}"
+            print(line)
+    if base:
+        print(f"\nRuns slower than the baseline by more than {100 * tolerance:g}%: "
+              f"{regressions}")
+    return regressions
+
+
+class Driver:
+    """Run the sweep.
+
+    Attributes
+    ----------
+    args : argparse.Namespace
+        The command line.
+    """
+
+    def __init__(self, args):
+        self.args = args
+        self.logs = args.out + '.logs'
+
+    def points(self):
+        """Every (ranks, threads, number, events, remote, repeat) to run."""
+        return itertools.product(self.args.ranks, self.args.threads, self.args.number,
+                                 self.args.events, self.args.remote,
+                                 range(self.args.repeat))
+
+    def command(self, ranks: int, threads: int, number: int, events: int,
+                remote: float) -> list:
+        """The command line for one run."""
+        # pylint: disable=too-many-arguments
+        nodes = max(1, -(-ranks // self.args.ranks_per_node))
+        launcher = self.args.launcher.format(ranks=ranks, nodes=nodes, threads=threads)
+        cmd = shlex.split(launcher) if ranks > 1 or self.args.always_launch else []
+        cmd += [self.args.sst, f"--num-threads={threads}",
+                os.path.join(phold_dir, 'phold.py'), '--',
+                '--number', str(number), '--events', str(events),
+                '--remote', str(remote), '--stop', str(self.args.stop)]
+        return cmd + shlex.split(self.args.phold_args)
+
+    def run(self) -> list:
+        """Run every point, appending the rows as they complete."""
+        os.makedirs(self.logs, exist_ok=True)
+        rows = []
+        new_csv = not os.path.exists(self.args.out + '.csv')
+        with open(self.args.out + '.jsonl', 'a', encoding='utf-8') as fjson, \
+             open(self.args.out + '.csv', 'a', encoding='utf-8', newline='') as fcsv:
+            writer = csv.DictWriter(fcsv, fieldnames=FIELDS)
+            if new_csv:
+                writer.writeheader()
+            for ranks, threads, number, events, remote, repeat in self.points():
+                workers = ranks * threads
+                total = number * workers if self.args.mode == 'weak' else number
+                cmd = self.command(ranks, threads, total, events, remote)
+                log = os.path.join(self.logs, f"{self.args.mode}_r{ranks}_t{threads}_n{total}"
+                                   f"_e{events}_x{remote}_{repeat}.log")
+                phprint(' '.join(cmd))
+                row = {'mode': self.args.mode, 'ranks': ranks, 'threads': threads,
+                       'workers': workers, 'number': total, 'events': events,
+                       'remote': remote, 'stop': self.args.stop,
+                       'phold_args': self.args.phold_args, 'repeat': repeat,
+                       'log': log}
+                if self.args.dry_run:
+                    continue
+                start = time.monotonic()
+                with open(log, 'w', encoding='utf-8') as flog:
+                    proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                                          stderr=subprocess.STDOUT, text=True,
+                                          timeout=self.args.timeout, check=False)
+                    flog.write(proc.stdout)
+                row['elapsed'] = time.monotonic() - start
+                row['status'] = proc.returncode
+                row.update(parse_output(proc.stdout))
+                if row['rate'] is None:
+                    phprint(f"No event rate in {log}, status {proc.returncode}")
+                    row['status'] = row['status'] or -1
+                rows.append(row)
+                fjson.write(json.dumps(row) + '\n')
+                fjson.flush()
+                writer.writerow(row)
+                fcsv.flush()
+        return rows
 
-nodes = [2, 5, 10]
-events = [1, 5, 10]
-means = [10, 5, 2]
-stops = [30, 100, 500]
 
-ncases = list(map(len, [nodes, events, means, stops]))
-print(f"\nTotal cases: {str(ncases)}")
-ncases = map(mul, ncases)
-print(f"\nTotal cases: {list(ncases)}")
-exit(0)
+def init_argparse() -> argparse.ArgumentParser:
+    """Build the argument parser."""
+    parser = argparse.ArgumentParser(
+        description=__doc__.split('\n\n')[0].strip(),
+        epilog="The launcher may use {ranks}, {nodes} and {threads}.")
+    parser.add_argument('--mode', choices=['strong', 'weak'], default='strong',
+                        help="Hold the total LPs (strong), or the LPs per worker (weak), "
+                        "default %(default)s.")
+    parser.add_argument('--ranks', type=number_list, default=[1],
+                        help="MPI ranks, comma separated, default 1.")
+    parser.add_argument('--threads', type=number_list, default=[1],
+                        help="Threads per rank, comma separated, default 1.")
+    parser.add_argument('--number', type=number_list, default=[1024],
+                        help="Total LPs (strong), or LPs per worker (weak), "
+                        "comma separated, default 1024.")
+    parser.add_argument('--events', type=number_list, default=[10],
+                        help="Initial events per LP, comma separated, default 10.")
+    parser.add_argument('--remote', type=lambda t: number_list(t, float), default=[0.9],
+                        help="Remote fractions, comma separated, default 0.9.")
+    parser.add_argument('--stop', type=float, default=100,
+                        help="Simulation stop time, default %(default)s.")
+    parser.add_argument('--repeat', type=int, default=1,
+                        help="Runs of each point, averaged in the tables, "
+                        "default %(default)s.")
+    parser.add_argument('--phold-args', default='',
+                        help="More tests/phold.py arguments for every run, "
+                        "such as '--warmup 10 --topology torus2'.")
+    parser.add_argument('--sst', default='sst', help="The sst executable, default %(default)s.")
+    parser.add_argument('--launcher', default='mpirun -n {ranks}',
+                        help="MPI launcher, default '%(default)s'.")
+    parser.add_argument('--always-launch', action='store_true',
+                        help="Use the launcher for one rank too, as batch systems need.")
+    parser.add_argument('--ranks-per-node', type=int, default=1,
+                        help="Ranks per node, to compute {nodes}, default %(default)s.")
+    parser.add_argument('--timeout', type=float, default=None,
+                        help="Kill a run after this many seconds.")
+    parser.add_argument('--out', default='scaling',
+                        help="Results base name: <out>.jsonl, <out>.csv and <out>.logs/, "
+                        "default %(default)s.")
+    parser.add_argument('--dry-run', action='store_true',
+                        help="Just print the commands.")
+    parser.add_argument('--collate', metavar='JSONL',
+                        help="Don't run, just print the tables from this results file.")
+    parser.add_argument('--baseline', metavar='JSONL',
+                        help="Compare the event rates with this earlier results file, "
+                        "such as from the previous SST version or machine.")
+    parser.add_argument('--tolerance', type=float, default=0.05,
+                        help="Flag rates this fraction below the baseline, "
+                        "default %(default)s.  The exit status is 2 if any are, "
+                        "or 3 if runs of the same model commit different events.")
+    return parser
 
-# from tabulate import tabulate
-# print(tabulate([['Alice', 24],
-#                 ['Bob', 19]],    headers=['Name', 'Age']))
 
-titles = ["Nodes", "Events", "Mean", "Stop", "Time"]
+def main() -> int:
+    """Run the sweep, or collate, and print the tables."""
+    args = init_argparse().parse_args()
+    if min(args.ranks + args.threads + args.number + args.events) < 1 \
+       or args.ranks_per_node < 1 or args.repeat < 1:
+        phprint("Ranks, threads, numbers, events, ranks per node and repeats must be positive")
+        return 1
+    if args.collate:
+        rows = load_rows(args.collate)
+    else:
+        rows = Driver(args).run()
+        if args.dry_run:
+            return 0
+        phprint(f"Results in {args.out}.jsonl, {args.out}.csv")
+    failed = sum(1 for r in rows if r['status'] != 0)
+    if failed:
+        phprint(f"{failed} of {len(rows)} runs failed, excluded from the tables")
+    baseline = load_rows(args.baseline) if args.baseline else None
+    regressions = print_tables(rows, baseline, args.tolerance)
+    if check_checksums(rows + (baseline or [])):
+        return 3
+    return 2 if regressions else 0
 
-cases = []
-for n in nodes:
-    for e in events:
-        for m in means:
-            for s in stops:
-                time = n * e * s / m
-                cases += [n, e, m, s, time]
 
-print(tabulate(cases, headers=titles))
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,223 @@
+#!/bin/python3
+# -*- Mode:python; c-file-style:"gnu"; indent-tabs-mode:nil; -*-
+#
+# Copyright (c) 2021 Lawrence Livermore National Laboratory
+# All rights reserved.
+#
+# Author:  Peter D. Barnes, Jr. <pdbarnes@llnl.gov>
+
+
+"""PHOLD LP connectivity.
+
+This mirrors the C++ Phold::Topology class in src/Topology.cc.
+The two must agree exactly, since each Phold component only configures
+the ports it expects this script to have connected.
+"""
+
+import math
+
+KINDS = ['full', 'ring', 'torus2', 'torus3', 'random', 'hierarchical']
+
+_MASK64 = (1 << 64) - 1
+
+
+def _splitmix64(state: int):
+    """SplitMix64 step, returns (new state, value)."""
+    state = (state + 0x9e3779b97f4a7c15) & _MASK64
+    z = state
+    z = ((z ^ (z >> 30)) * 0xbf58476d1ce4e5b9) & _MASK64
+    z = ((z ^ (z >> 27)) * 0x94d049bb133111eb) & _MASK64
+    return state, z ^ (z >> 31)
+
+
+def _largest_divisor(n: int, limit: int) -> int:
+    """Largest divisor of n not greater than limit."""
+    for d in range(max(limit, 1), 1, -1):
+        if n % d == 0:
+            return d
+    return 1
+
+
+def _tree_links(i: int, number: int, fanout: int = 2) -> list:
+    """Parent and children of LP i in the init()/complete() k-ary tree."""
+    tree = list(range(fanout * i + 1, fanout * i + fanout + 1))
+    if i > 0:
+        tree.append((i - 1) // fanout)
+    return [j for j in tree if j < number]
+
+
+def rank_leader(rank: int, number: int, ranks: int, threads: int) -> int:
+    """First LP on rank, as placed by the SST linear partitioner.
+
+    This mirrors Phold::RankLeader().
+    """
+    parts = ranks * threads
+    per, extra = divmod(number, parts)
+    p = rank * threads
+    return p * per + min(p, extra)
+
+
+def _rank_tree_links(i: int, number: int, ranks: int, threads: int,
+                     fanout: int) -> list:
+    """Links from LP i to other rank leaders in the complete() rank tree."""
+    leaders = [rank_leader(r, number, ranks, threads) for r in range(ranks)]
+    if i not in leaders:
+        return []
+    r = leaders.index(i)
+    tree = [leaders[c] for c in range(fanout * r + 1, fanout * r + fanout + 1)
+            if c < ranks]
+    if r > 0:
+        tree.append(leaders[(r - 1) // fanout])
+    return tree
+
+
+class Topology():
+    """Compute the neighbors of each LP.
+
+    Parameters
+    ----------
+    kind : str
+        One of KINDS.
+    number : int
+        Total number of LPs.
+    dims : str
+        Torus dimensions "x,y[,z]", or empty to factor number.
+    neighbors : int
+        Number of neighbors for the random topology.
+    seed : int
+        Seed for the random topology offsets.
+    group : int
+        LPs per group in the hierarchical topology.
+    remotes : int
+        Links to other groups, in each direction, in the hierarchical topology.
+    fanout : int
+        Fan-out of the init()/complete() tree.
+    ranks : int
+        Number of ranks for the complete() rank tree, or 0 if not used.
+    threads : int
+        Number of threads per rank, for the complete() rank tree.
+
+    Methods
+    -------
+    validate() -> str
+        Return an error description, or empty if valid.
+    neighbors(i) -> list
+        The sorted neighbors of LP i, excluding i.
+    links(i) -> list
+        The neighbors of i, plus any additional tree links to i.
+    """
+
+    # pylint: disable=too-many-arguments,too-many-instance-attributes
+
+    def __init__(self, kind: str, number: int, dims: str = '',
+                 neighbors: int = 4, seed: int = 1,
+                 group: int = 0, remotes: int = 1, fanout: int = 2,
+                 ranks: int = 0, threads: int = 1):
+        self.kind = kind
+        self.number = number
+        self.dims = [1, 1, 1]
+        self.nbrs = neighbors
+        self.seed = seed
+        self.group = group
+        self.remotes = remotes
+        self.fanout = fanout
+        self.ranks = ranks
+        self.threads = threads
+        self.offsets = []
+
+        if kind in ('torus2', 'torus3'):
+            self._resolve_dims(dims)
+        elif kind == 'random':
+            max_offset = number // 2
+            count = min((neighbors + 1) // 2, max_offset)
+            state = seed & _MASK64
+            while len(self.offsets) < count:
+                state, value = _splitmix64(state)
+                d = 1 + value % max_offset
+                if d not in self.offsets:
+                    self.offsets.append(d)
+
+    def _resolve_dims(self, dims: str):
+        rank = 2 if self.kind == 'torus2' else 3
+        if dims:
+            fields = dims.lower().replace(',', ' ').replace('x', ' ').split()
+            for i in range(min(rank, len(fields))):
+                self.dims[i] = int(fields[i])
+            return
+        rest = self.number
+        if rank == 3:
+            self.dims[2] = _largest_divisor(rest, int(rest ** (1.0 / 3) + 0.5))
+            rest //= self.dims[2]
+        self.dims[1] = _largest_divisor(rest, int(math.sqrt(rest) + 0.5))
+        self.dims[0] = rest // self.dims[1]
+
+    def __str__(self) -> str:
+        if self.kind == 'torus2':
+            return f"{self.kind} ({self.dims[0]} x {self.dims[1]})"
+        if self.kind == 'torus3':
+            return f"{self.kind} ({self.dims[0]} x {self.dims[1]} x {self.dims[2]})"
+        if self.kind == 'random':
+            # An offset of number / 2 gives the same LP both ways
+            return f"{self.kind} ({len(self.neighbors(0))} neighbors, seed {self.seed})"
+        if self.kind == 'hierarchical':
+            return f"{self.kind} (groups of {self.group}, {2 * self.remotes} remotes)"
+        return self.kind
+
+    def validate(self) -> str:
+        """Check the configuration, returning an error description if invalid."""
+        if self.kind not in KINDS:
+            return f"unknown topology '{self.kind}', must be one of {KINDS}"
+        if self.number < 2:
+            return "need at least 2 LPs"
+        if self.kind in ('torus2', 'torus3') and \
+           self.dims[0] * self.dims[1] * self.dims[2] != self.number:
+            return f"torus dimensions {self} don't match number {self.number}"
+        if self.kind == 'random' and self.nbrs < 1:
+            return "random topology needs at least 1 neighbor"
+        if self.kind == 'hierarchical' and self.group < 1:
+            return "hierarchical topology needs group size >= 1"
+        return ''
+
+    def neighbors(self, i: int) -> list:
+        """The sorted neighbors of LP i, excluding i itself."""
+        n = self.number
+        nbrs = []
+
+        def plus_minus(d):
+            d %= n
+            nbrs.extend([(i + d) % n, (i + n - d) % n])
+
+        if self.kind == 'full':
+            nbrs = list(range(n))
+        elif self.kind == 'ring':
+            plus_minus(1)
+        elif self.kind in ('torus2', 'torus3'):
+            stride = 1
+            for dim in self.dims:
+                if dim > 1:
+                    c = (i // stride) % dim
+                    base = i - c * stride
+                    nbrs.append(base + ((c + 1) % dim) * stride)
+                    nbrs.append(base + ((c + dim - 1) % dim) * stride)
+                stride *= dim
+        elif self.kind == 'random':
+            for d in self.offsets:
+                plus_minus(d)
+        elif self.kind == 'hierarchical':
+            g = self.group
+            begin = (i // g) * g
+            nbrs = list(range(begin, min(begin + g, n)))
+            for m in range(1, self.remotes + 1):
+                plus_minus(m * g)
+
+        return sorted(set(nbrs) - {i})
+
+    def links(self, i: int) -> list:
+        """All LPs connected to i: the neighbors, plus init()/complete() tree links."""
+        if self.kind == 'full':
+            return self.neighbors(i)
+        links = set(self.neighbors(i)) | set(_tree_links(i, self.number, self.fanout))
+        if self.ranks > 0:
+            links |= set(_rank_tree_links(i, self.number, self.ranks,
+                                          self.threads, self.fanout))
+        return sorted(links)